@@ -0,0 +1,21 @@
+/*
+ * Allocation profiler, enabled with puer --alloc-profile[=N].
+ *
+ * The evaluator keeps alloc_site pointing at the innermost node being
+ * evaluated. Every gc allocation is charged to that node and to the
+ * object kind it creates. With N > 1 only every Nth allocation is
+ * recorded and the totals are scaled by N. At exit a report goes to
+ * stderr: sites by bytes allocated and the totals by object kind.
+ */
+#ifndef ALLOCPROF_H
+#define ALLOCPROF_H
+
+#include "ast.h"
+
+extern int allocprof_enabled;
+extern const Node* alloc_site;
+
+void allocprof_start(unsigned int every);
+void allocprof_report(void);
+
+#endif
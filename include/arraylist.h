@@ -7,12 +7,13 @@
 #define ARRAYLIST_H
 
 #include "var.h"
+#include "symbol.h"
 
 ArrayList* arraylist_new(VarType type, int initial_capacity);
 ArrayList* arraylist_clone(const ArrayList* src);
 void arraylist_grow(ArrayList* a);
 void arraylist_push(ArrayList* a, Var v);
 void check_arr_bounds(ArrayList* a, int index);
-Var build_zero_array(VarType base, const char* recname, int* dims, int ndims);
+Var build_zero_array(VarType base, Symbol recname, int* dims, int ndims);
 
 #endif
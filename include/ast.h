@@ -6,7 +6,9 @@
 #define AST_H
 
 #include "var.h"
+#include "symbol.h"
 #include <stdarg.h>
+#include <stdio.h>
 
 typedef enum {
         OP_ADD,
@@ -52,6 +54,9 @@ typedef enum {
         NODE_IDXASSIGN,
         NODE_ARRAYLIT,
         NODE_ARRAYDECL,
+        NODE_DICTDECL,
+        NODE_CHANDECL,
+        NODE_GENDECL,
 
         NODE_RECDEF,
         NODE_FIELDDECL,
@@ -63,6 +68,8 @@ typedef enum {
         NODE_IFELSE,
         NODE_FOR,
         NODE_WHILE,
+        NODE_PARFOR,
+        NODE_FORIN,
         NODE_BREAK,
         NODE_CONTINUE,
 
@@ -78,55 +85,126 @@ typedef enum {
         NODE_FUNCDEF,
         NODE_FUNCCALL,
         NODE_RETURN,
+        NODE_SPAWN,
+        NODE_YIELD,
+
+        /* builtins lowered by node_call() */
+        NODE_LEN,
+        NODE_APPEND,
+        NODE_ABS,
 
         /* for getting enum size */
         NODE_LASTNODE
 } NodeType;
 
-typedef struct Node {
+/*
+ * parse tree built by the parser, one malloc per node.
+ * converted to the flat Node pool by ast_flatten() before evaluation.
+ */
+typedef struct ParseNode {
         NodeType type;
         BinOp op;
-        struct Node** children;
+        struct ParseNode** children;
         unsigned int n_children;
 
         /* file metadata */
         int lineno;
         int column;
 
-        int ndims;
-
         int ival; /* for NODE_NUM */
         float fval; /* for NODE_FLOAT */
 
-        char* recname; /* for record vardecl */
-        char* varname; /* function names, variable names, identifiers */
+        Symbol recname; /* for record vardecl */
+        Symbol name;    /* function names, variable names, identifiers, string literals */
         VarType vartype; /* VARDECL, PARAM, FUNCDECL type */
+} ParseNode;
+
+/* index of a node in ast_nodes */
+typedef unsigned int NodeId;
+
+/*
+ * evaluated ast. all nodes live in one pre-order array, so the first
+ * child of a node directly follows it. children are 32 bit indices
+ * stored in ast_kids. line and column live in a side table only read
+ * by die(). names are interned symbols.
+ */
+typedef struct Node {
+        unsigned char type;    /* NodeType */
+        unsigned char op;      /* BinOp */
+        unsigned char vartype; /* VarType: VARDECL, PARAM, FUNCDECL type */
+        unsigned int n_children;
+        NodeId kids;           /* first child entry in ast_kids */
+
+        union {
+                int ival;            /* NUM, CHAR, BOOL, INCDEC prefix flag, DICTDECL types */
+                float fval;          /* FLOAT */
+                Symbol recname;      /* record typed VARDECL, ARRAYDECL */
+        } u;
+
+        Symbol name; /* function names, variable names, identifiers, string literals */
 } Node;
 
+extern Node* ast_nodes;
+extern NodeId* ast_kids;
+
+#define CHILD(n, i) ( &ast_nodes[ast_kids[(n)->kids + (i)]] )
+
+/* key and value types of a dict[K,V] declaration, packed into ival */
+#define DICT_TYPES(k, v) ( (int) (k) | (int) (v) << 8 )
+#define DICT_KEY(ival) ( (VarType) ((ival) & 0xFF) )
+#define DICT_VAL(ival) ( (VarType) ((ival) >> 8) )
+
 #include "parser.tab.h"
 
-extern char* g_recname;
+extern Symbol g_recname;
+
+/* sizes of a flat ast image, stored in the script cache header */
+typedef struct AstImageInfo {
+        unsigned long n_nodes;
+        unsigned long n_kids;
+        unsigned long n_syms;
+        unsigned long sym_bytes;
+} AstImageInfo;
 
 /* ast.c */
-Node* node(NodeType type, YYLTYPE loc, unsigned int n_children, ...);
-Node* node_binop(BinOp op, YYLTYPE loc, Node* lhs, Node* rhs);
-Node* node_incdec(BinOp op, YYLTYPE loc, Node* child, int is_prefix);
-Node* node_compound(BinOp op, YYLTYPE loc, Node* lhs, Node* rhs);
-Node* node_uminus(Node* n, YYLTYPE loc);
-Node* node_param(VarType type, int isarr, char* varname, YYLTYPE loc);
-Node* node_append(Node* list, Node* child);
-Node* node_append_type(Node* list, NodeType type, YYLTYPE loc);
-
-void setvar(Node* node, VarType type, char* varname);
-void setname(Node* node, char* varname);
-void settype(Node* node, VarType type);
+ParseNode* node(NodeType type, YYLTYPE loc, unsigned int n_children, ...);
+ParseNode* node_call(Symbol name, ParseNode* args, YYLTYPE loc);
+ParseNode* node_binop(BinOp op, YYLTYPE loc, ParseNode* lhs, ParseNode* rhs);
+ParseNode* node_incdec(BinOp op, YYLTYPE loc, ParseNode* child, int is_prefix);
+ParseNode* node_compound(BinOp op, YYLTYPE loc, ParseNode* lhs, ParseNode* rhs);
+ParseNode* node_uminus(ParseNode* n, YYLTYPE loc);
+ParseNode* node_param(VarType type, int isarr, Symbol name, YYLTYPE loc);
+ParseNode* node_append(ParseNode* list, ParseNode* child);
+ParseNode* node_append_type(ParseNode* list, NodeType type, YYLTYPE loc);
+
+void setvar(ParseNode* node, VarType type, Symbol name);
+void setname(ParseNode* node, Symbol name);
+void settype(ParseNode* node, VarType type);
+void free_parse_tree(ParseNode* node);
+
+Node* ast_flatten(ParseNode* root);
+unsigned int ast_node_count(void);
+const char* node_type_to_str(NodeType t);
+int node_lineno(const Node* node);
+int node_column(const Node* node);
+int ast_write_image(FILE* f, AstImageInfo* info);
+size_t ast_image_size(const AstImageInfo* info);
+Node* ast_load_image(char* image, const AstImageInfo* info, void* mapping, size_t mapping_size);
 
 void print_ast(Node* node, unsigned int depth);
 void free_ast(Node* node);
 
+/* lexer.l */
+int lex_open(const char* path);
+void lex_close(void);
+const char* lex_source(size_t* size);
+
 /* execute.c */
 void eval(Node* node);
+void eval_program(Node* root, unsigned int start);
+unsigned int current_toplevel(void);
 Var eval_expr(Node* node);
+Var call_function(Node* at, Node* func, Var* args, int n);
 void init_handlers(void);
 
 
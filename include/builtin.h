@@ -8,6 +8,9 @@
 #include "ast.h"
 #include "var.h"
 
+/* builtins take a fixed number of args, at most this many */
+#define BUILTIN_MAX_PARAMS 4
+
 typedef Var (*BuiltinFn)(Node *node, Var *args);
 
 void builtin_register(const char* name, BuiltinFn fn, VarType ret_type, int n_params, ...);
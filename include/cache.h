@@ -0,0 +1,19 @@
+/*
+ * Precompiled script cache.
+ *
+ * The flat ast of a script is written to a cache file keyed by a hash of
+ * the source text and loaded with mmap on later runs, skipping the lexer
+ * and parser. Files live in $XDG_CACHE_HOME/puer (or ~/.cache/puer),
+ * falling back to a .puerc file next to the script.
+ */
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "ast.h"
+
+#define PUER_VERSION "0.1"
+
+Node* cache_load(const char* src_path);
+void cache_store(void);
+
+#endif
@@ -0,0 +1,22 @@
+/*
+ * Deterministic execution counters, enabled with puer --count.
+ *
+ * Every statement dispatched by eval() is counted and timed inclusively,
+ * and every node handled by eval() or eval_expr() is counted by type.
+ * At exit a report goes to stderr: statements by inclusive time, lines
+ * by execution count and the dispatch histogram by node type.
+ */
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include "ast.h"
+
+extern int counters_enabled;
+
+void counters_start(void);
+void counters_report(void);
+double counters_begin(const Node* node);
+void counters_end(const Node* node, double start);
+void counters_expr(const Node* node);
+
+#endif
@@ -0,0 +1,49 @@
+/*
+ * Hash maps for the dict[K,V] type.
+ *
+ * Open addressing with one control byte per slot, probed a group of 16
+ * bytes at a time: SSE2 compares the whole group against the 7 hash bits
+ * kept in the control bytes, with a scalar fallback elsewhere. Keys and
+ * values are stored without their type, the dict knows both. String keys
+ * are copied on insert and their hash is kept in the slot.
+ */
+#ifndef DICT_H
+#define DICT_H
+
+#include "var.h"
+#include "ast.h"
+#include "arraylist.h"
+
+#define DICT_GROUP 16
+
+typedef struct DictSlot {
+        VarData key;
+        VarData val;
+        unsigned int hash;
+} DictSlot;
+
+struct Dict {
+        VarType key_type;
+        VarType val_type;
+        unsigned int size;
+        unsigned int tombstones;
+        unsigned int cap;               /* 0 or a power of two, at least DICT_GROUP */
+        unsigned char* ctrl;            /* cap control bytes, high bit set when free */
+        DictSlot* slots;
+};
+
+int dict_is_key_type(VarType type);
+Dict* dict_new(VarType key_type, VarType val_type);
+Dict* dict_clone(const Dict* src);
+Var dict_get(Node* at, const Dict* d, Var key);
+int dict_has(Node* at, const Dict* d, Var key);
+void dict_set(Node* at, Dict* d, Var key, Var val);
+int dict_remove(Node* at, Dict* d, Var key);
+void dict_reserve(Node* at, Dict* d, long n);
+unsigned int dict_next(const Dict* d, unsigned int i);
+Var dict_key_at(const Dict* d, unsigned int i);
+Var dict_val_at(const Dict* d, unsigned int i);
+ArrayList* dict_keys(const Dict* d);
+ArrayList* dict_values(const Dict* d);
+
+#endif
@@ -6,13 +6,16 @@
 #define ENV_H
 
 #include "var.h"
+#include "symbol.h"
 #include "uthash.h"
 
 /* typedefs exposed for scan.c */
 typedef struct VarEntry {
-        const char* name;
+        Symbol name;
         Var val;
         Var* alias;
+        ArrayList* elem_of;     /* an array element reference, items can move */
+        int elem_idx;
         int is_ptr;
         UT_hash_handle hh;
 } VarEntry;
@@ -27,10 +30,14 @@ extern Scope* env_stack;
 
 void env_push(void);
 void env_pop(void);
-Var* env_get(const char* name);
-Var* env_get_top(const char* name);
-void env_set(const char* name, Var val);
-void env_set_ptr(const char* name, Var* target);
+Scope* env_detach(void);
+Var* env_get(Symbol name);
+Var* env_get_top(Symbol name);
+VarEntry* env_get_entry(Symbol name);
+void env_set(Symbol name, Var val);
+void env_set_ptr(Symbol name, Var* target);
+void env_set_elem(Symbol name, ArrayList* a, int idx);
+Var* env_entry_var(VarEntry* entry);
 void env_clear();
 
 #endif
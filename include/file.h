@@ -0,0 +1,31 @@
+/*
+ * Buffered file I/O for open, read_line, read_all, write, write_line and
+ * close, and the lines and map_file builtins.
+ *
+ * A file's handle is its fd. Reads and writes go through a buffer of
+ * FILE_BUF_SIZE bytes, so a script reading a large file line by line
+ * makes one read() per buffer instead of one call per character.
+ * lines(path) is a generator that hands out the same str for every
+ * line, overwritten in place. map_file maps a whole file into a str.
+ */
+#ifndef FILE_H
+#define FILE_H
+
+#include "ast.h"
+#include "puerstring.h"
+#include "gen.h"
+
+#define FILE_BUF_SIZE (1 << 18)
+
+int file_open(Node* at, const char* path, const char* mode);
+void file_close(Node* at, int h);
+int file_eof(Node* at, int h);
+String* file_read_line(Node* at, int h);
+String* file_read_all(Node* at, int h);
+void file_write(Node* at, int h, const String* s, int newline);
+void file_flush_all(void);
+
+Gen* file_lines(Node* at, const char* path);
+String* file_map(Node* at, const char* path);
+
+#endif
@@ -3,8 +3,9 @@
 
 #include "ast.h"
 
-void func_set(const char* name, Node* ast);
-Node* func_get(const char* name);
+void func_set(Symbol name, Node* ast);
+Node* func_get(Symbol name);
 void func_clear(void);
+void func_each(void (*fn)(Symbol name, Node* ast, void* ctx), void* ctx);
 
 #endif
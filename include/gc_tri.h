@@ -3,22 +3,84 @@
 
 #include <stddef.h>
 
-/* callback to mark child pointer */
-typedef void (*GC_MarkFn)(void* payload);
+/*
+ * callback to mark child pointer.
+ * receives the address of the slot holding the pointer so that a
+ * compacting collection can rewrite it when the child is moved.
+ */
+typedef void (*GC_MarkFn)(void** slot);
 
 /* scan callback for scanning children of heap object */
 typedef void (*GC_ScanFn)(void* payload, GC_MarkFn mark);
 
+/* callback for visiting every object on the heap */
+typedef void (*GC_WalkFn)(void* payload, size_t size, GC_ScanFn scan, void* ctx);
+
+/* called on every allocation with the bytes it adds to the heap */
+typedef void (*GC_AllocHook)(size_t size, GC_ScanFn scan);
+
+/* releases what an object holds outside the heap, before it is freed */
+typedef void (*GC_FinalizeFn)(void* payload);
+
+/* object kinds, derived from the scan callback */
+typedef enum {
+        GC_KIND_RAW,
+        GC_KIND_STRING,
+        GC_KIND_ARRAY,
+        GC_KIND_VARENTRY,
+        GC_KIND_SCOPE,
+        GC_KIND_REC,
+        GC_KIND_RECDEF,
+        GC_KIND_DICT,
+        GC_KIND_OTHER,
+        GC_NUM_KINDS
+} GC_Kind;
+
+typedef struct GC_Stats {
+        size_t bytes_allocated;   /* total since gc_init */
+        size_t objects_allocated;
+        size_t heap_bytes;        /* currently on the heap */
+        size_t heap_objects;
+        size_t live_bytes;        /* left after the last completed cycle */
+        size_t live_objects;
+        size_t cycles;
+        double last_mark_ms;
+        double last_sweep_ms;
+        double total_mark_ms;
+        double total_sweep_ms;
+        double max_pause_ms;
+        size_t compactions;
+        size_t bytes_compacted;   /* moved by compaction, total */
+        size_t freed[GC_NUM_KINDS];
+} GC_Stats;
+
 void gc_init(void);
 void* gc_alloc(size_t size, GC_ScanFn scan);
 void* gc_realloc(void* ptr, size_t new_size, GC_ScanFn scan);
+void gc_free(void* ptr);
 int gc_collect_step(void);
 void gc_collect_full(void);
+int gc_in_collection(void);
+void gc_set_alloc_hook(GC_AllocHook hook);
+void gc_set_finalizer(GC_ScanFn scan, GC_FinalizeFn fn);
+void gc_set_compaction(int enabled);
+void gc_hold_fds(int n);
+void gc_collect_fds(void);
+unsigned int gc_next_epoch(void);
+unsigned int gc_epoch_of(const void* payload);
+void gc_compact(void);
 
 void gc_mark_root(void* payload);
 int gc_step(void);
 size_t gc_sweep(size_t max);
 
+void gc_walk(GC_WalkFn fn, void* ctx);
+
+GC_Kind gc_kind_of(GC_ScanFn scan);
+const char* gc_kind_name(GC_Kind kind);
+const GC_Stats* gc_get_stats(void);
+void gc_print_stats(void);
+
 #define gc_sweep_all() gc_sweep(0)
 #define gc_sweep_slice(n) gc_sweep(n)
 
@@ -0,0 +1,57 @@
+/*
+ * Generators.
+ *
+ * Calling a function declared -> T* does not run its body, it returns a
+ * generator. Each generator runs on a C stack of its own, so the
+ * recursive evaluator can stop at a yield, however deep in nested calls
+ * it is, and carry on from there when the next value is asked for. While
+ * it runs, its scopes sit on top of the scopes of whoever resumed it,
+ * the same dynamic scoping a function call gets.
+ */
+#ifndef GEN_H
+#define GEN_H
+
+#include "ast.h"
+#include "var.h"
+#include "env.h"
+#include "profile.h"
+
+/* runs the body of func, on the generator's stack */
+typedef void (*GenBody)(Node* func);
+
+/* frees what a generator written in C holds if it is dropped unfinished */
+typedef void (*GenRelease)(void* data);
+
+typedef enum GenState {
+        GEN_NEW,                /* not started */
+        GEN_SUSPENDED,          /* stopped at a yield, its value taken */
+        GEN_READY,              /* stopped at a yield, value not taken yet */
+        GEN_RUNNING,
+        GEN_DONE
+} GenState;
+
+struct Gen {
+        VarType type;           /* the type it yields */
+        GenState state;
+        Node* func;
+        GenBody body;
+        Var value;              /* the yielded value while GEN_READY */
+        Scope* base;            /* the scope holding the arguments */
+        Scope* env;             /* its innermost scope while suspended */
+        Scope* caller;          /* the resumer's scopes while it runs */
+        Gen* resumer;           /* the generator running before this one */
+        struct GenStack* stack; /* NULL once done */
+        void* data;             /* for bodies written in C */
+        GenRelease release;     /* called on data when dropped, unless NULL */
+        ProfFrames prof;        /* its profiler frames while suspended */
+};
+
+int gen_is_elem_type(VarType type);
+Gen* gen_new(Node* func, GenBody body);
+int gen_ready(Node* at, Gen* g);
+Var gen_take(Node* at, Gen* g);
+void gen_yield(Node* at, Var val);
+void gen_yield_shared(Node* at, Var val);
+Gen* gen_running(void);
+
+#endif
@@ -0,0 +1,26 @@
+/*
+ * Heap snapshots for leak and retention analysis.
+ *
+ * Dump file layout, all integers little endian:
+ *
+ *   "PUERHEAP"  u32 version
+ *   'R' u64 addr                               root object
+ *   'O' u64 addr  u8 kind  u64 size
+ *       u16 name_len  name  u32 n_edges  u64 edge...
+ *   'E'                                        end of dump
+ *
+ * kind is a GC_Kind. name is the record type for records and record
+ * definitions, and the variable name for variable entries.
+ * see tools/heapstat.c for a reader.
+ */
+#ifndef HEAPDUMP_H
+#define HEAPDUMP_H
+
+#define HEAPDUMP_MAGIC "PUERHEAP"
+#define HEAPDUMP_VERSION 2
+
+int heap_dump(const char* path);
+void heap_dump_install_signal(void);
+void heap_dump_poll(void);
+
+#endif
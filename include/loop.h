@@ -0,0 +1,31 @@
+/*
+ * An event loop for the on_read, write_async, after and every builtins.
+ *
+ * run_loop waits on an epoll set of the watched fds and on the nearest
+ * timer, then calls the script's functions for whatever is ready, one
+ * at a time on the interpreter's thread. Watched fds are switched to
+ * non-blocking and get their old flags back when the watch ends.
+ * Regular files cannot be polled, they count as always ready.
+ */
+#ifndef LOOP_H
+#define LOOP_H
+
+#include "ast.h"
+#include "puerstring.h"
+
+/* the most read from an fd for one call of its function */
+#define LOOP_READ_SIZE 65536
+
+int loop_open(Node* at, const char* path, const char* mode);
+int loop_open_pipe(Node* at, const char* cmd, const char* mode);
+void loop_close(Node* at, int fd);
+
+void loop_on_read(Node* at, int fd, Node* func);
+void loop_write(Node* at, int fd, const String* data);
+int loop_timer(Node* at, int ms, int repeat, Node* func);
+void loop_cancel(int id);
+
+void loop_run(Node* at);
+void loop_stop(void);
+
+#endif
@@ -0,0 +1,28 @@
+/*
+ * Buffered stdout for print and println.
+ *
+ * Output collects in one buffer that goes out with a single write().
+ * On a terminal it is written at the end of every println, otherwise
+ * when the buffer fills, on flush(), and before anything that needs it
+ * out first: reading input, waiting in the event loop, forking and
+ * exiting. --unbuffered writes it at the end of every print statement.
+ * Numbers are formatted here instead of by printf.
+ */
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+
+#define OUT_BUF_SIZE (1 << 16)
+
+void out_init(int unbuffered);
+void out_write(const char* p, size_t n);
+void out_str(const char* s);
+void out_char(char c);
+void out_long(long v);
+void out_ulong(unsigned long v);
+void out_double(double v);
+void out_end(int newline);
+void out_flush(void);
+
+#endif
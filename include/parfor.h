@@ -0,0 +1,33 @@
+/*
+ * Parallel loops for parfor.
+ *
+ * The interpreter keeps its scopes, heap and return value in globals, so
+ * the range is split between forked worker processes instead of threads.
+ * Each worker runs a contiguous chunk of iterations on its own copy of
+ * the heap. Objects it allocates are private; stores it makes into arrays
+ * and records that existed before the loop are logged and sent back to
+ * the parent, which applies them once every worker has finished. Two
+ * iterations storing to the same element is an error, so the result does
+ * not depend on the number of workers.
+ */
+#ifndef PARFOR_H
+#define PARFOR_H
+
+#include "ast.h"
+#include "var.h"
+#include "symbol.h"
+
+/* runs one iteration of the loop at node */
+typedef void (*ParforBody)(Node* node, int i);
+
+/* nonzero in a worker process */
+extern int parfor_worker;
+
+void parfor_run(Node* node, int start, int end, ParforBody body);
+
+/* hooks for stores made by a worker, only call them when parfor_worker is set */
+void parfor_store(Node* at, void* obj, int is_rec, unsigned int idx, Var val);
+void parfor_check_owned(Node* at, const void* obj, const char* what);
+void parfor_check_var(Node* at, Symbol name);
+
+#endif
@@ -0,0 +1,24 @@
+/*
+ * A pthread pool for builtins that loop over large arrays.
+ *
+ * The threads only run C loops over array storage, never the
+ * interpreter, and the calling thread waits for them before returning
+ * to it. They start on the first parallel call and are started again
+ * in a forked child.
+ */
+#ifndef POOL_H
+#define POOL_H
+
+#define POOL_MAX_THREADS 64
+
+/* fewer items than this per part are not worth a thread */
+#define POOL_MIN_PART 65536
+
+/* handles part `part`, the items in [lo, hi) */
+typedef void (*PoolFn)(void* ctx, unsigned int lo, unsigned int hi, unsigned int part);
+
+int pool_threads(void);
+unsigned int pool_split(unsigned int n);
+void pool_run(PoolFn fn, void* ctx, unsigned int n, unsigned int parts);
+
+#endif
@@ -0,0 +1,48 @@
+/*
+ * Sampling profiler for puer code.
+ *
+ * puer --profile=out.folded keeps a shadow stack of puer function calls
+ * and samples it from a SIGPROF interval timer. At exit the samples are
+ * written in folded-stack format, one line per distinct stack:
+ *
+ *   main;update:12;step:30;builtin:append 41
+ *
+ * user frames are the function name and the line of its definition.
+ * builtins get a builtin: frame, len, append and abs too although they
+ * run inline, and time spent collecting garbage a final [gc] frame. a
+ * generator's frames sit on top of whoever resumed it and are set aside
+ * while it is suspended. feed the file to flamegraph.pl for a flame
+ * graph.
+ *
+ * with profiling off the only cost is a flag test per call.
+ */
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "ast.h"
+
+extern int prof_enabled;
+
+/* the frames a suspended generator pushed, off the shadow stack */
+typedef struct ProfFrames {
+        unsigned int* words;
+        int n;                  /* levels, more than words holds past the max depth */
+        int n_words;
+        int cap;
+        int base;               /* the depth it was resumed at */
+} ProfFrames;
+
+int prof_start(const char* path);
+void prof_stop(void);
+void prof_push(const Node* node, int is_builtin);
+void prof_pop(void);
+void prof_suspend(ProfFrames* f);
+void prof_resume(ProfFrames* f);
+void prof_frames_free(ProfFrames* f);
+
+#define PROF_ENTER(node, is_builtin) \
+        do { if (prof_enabled) prof_push((node), (is_builtin)); } while (0)
+#define PROF_LEAVE() \
+        do { if (prof_enabled) prof_pop(); } while (0)
+
+#endif
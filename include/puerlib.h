@@ -7,6 +7,16 @@
 #ifndef PUERLIB_H
 #define PUERLIB_H
 
+#include "ast.h"
+
+#define GCSTATS_REC "GCStats"
+
+void init_puerlib_recnames(void);
 void init_puerlib(void);
 
+/* also called directly for the NODE_LEN, NODE_APPEND and NODE_ABS kinds */
+Var puer_len(Node* node, Var* argv);
+Var puer_append(Node* node, Var* argv);
+Var puer_abs(Node* node, Var* argv);
+
 #endif
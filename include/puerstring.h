@@ -8,6 +8,7 @@ typedef struct {
 
 void check_str_bounds(String* s, int index);
 String* string_new(const char* cstr);
+String* string_new_len(const char* data, unsigned int len);
 String* string_concat(String* a, String* b);
 String* string_clone(const String* s);
 char string_get(String* s, int index);
@@ -2,16 +2,18 @@
 #define REC_H
 
 #include "var.h"
+#include "symbol.h"
 #include "uthash.h"
 
 typedef struct FieldIndex {
-        char* name;
+        Symbol name;
         unsigned int idx;
         UT_hash_handle hh;
 } FieldIndex;
 
 typedef struct RecDef {
-        char* name;
+        Symbol sym;
+        const char* name;       /* sym_name(sym) */
         unsigned int n_fields;
         Var* fields;
         FieldIndex *index_map;
@@ -25,17 +27,18 @@ struct RecInst {
 
 extern RecDef* recdefs;
 
-RecDef* recdef_new(const char* name, const char** field_names, const Var* fields, unsigned int n_fields);
-RecDef* recdef_find(const char* name);
-RecInst* rec_new(const char* recdef_name);
-Var* rec_get_field(RecInst* ri, const char* field_name);
-void rec_set_field(RecInst* ri, const char* field_name, Var val);
+RecDef* recdef_new(Symbol name, const Symbol* field_names, const Var* fields, unsigned int n_fields);
+RecDef* recdef_find(Symbol name);
+RecInst* rec_new(Symbol recdef_name);
+unsigned int rec_field_index(const RecDef* rd, Symbol field_name);
+Var* rec_get_field(RecInst* ri, Symbol field_name);
+void rec_set_field(RecInst* ri, Symbol field_name, Var val);
 void recdef_register(RecDef* rd);
 void recdef_clear(void);
 RecInst* rec_clone(const RecInst* src);
 
-int is_rec_name(const char* name);
-void recname_register(const char* name);
+int is_rec_name(Symbol name);
+void recname_register(Symbol name);
 void recname_clear(void);
 
 #endif
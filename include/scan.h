@@ -5,10 +5,14 @@
 
 void scan_raw(void* payload, GC_MarkFn mark);
 void scan_string(void* payload, GC_MarkFn mark);
+void scan_mapped_string(void* payload, GC_MarkFn mark);
 void scan_arraylist(void* payload, GC_MarkFn mark);
 void scan_varentry(void* payload, GC_MarkFn mark);
 void scan_scope(void* payload, GC_MarkFn mark);
 void scan_rec(void* payload, GC_MarkFn mark);
 void scan_recdef(void* payload, GC_MarkFn mark);
+void scan_dict(void* payload, GC_MarkFn mark);
+void scan_gen(void* payload, GC_MarkFn mark);
+void scan_chan(void* payload, GC_MarkFn mark);
 
 #endif
@@ -0,0 +1,23 @@
+/*
+ * Heap images for warm starts.
+ *
+ * snapshot() writes the program ast, the global scope, record
+ * definitions, the function table and every heap object reachable from
+ * them to an image file. puer --restore maps the image, rebuilds the
+ * objects on the gc heap with their pointers relocated and resumes at
+ * the top-level statement after the one that took the snapshot.
+ *
+ * Only globals are saved, so snapshot() dies unless it is called from a
+ * top-level statement, outside any block, loop, function or generator.
+ * The rest of that statement does not run again on restore. An image
+ * is only accepted by the interpreter build that wrote it.
+ */
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "ast.h"
+
+int snapshot_write(const char* path);
+Node* snapshot_restore(const char* path, unsigned int* resume);
+
+#endif
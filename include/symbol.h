@@ -0,0 +1,35 @@
+/*
+ * Interned names.
+ *
+ * Every identifier and string literal is interned once by the lexer and
+ * carried through the ast as a Symbol. The hash of each name is computed
+ * at intern time, so the runtime tables (scopes, functions, builtins and
+ * record fields) are keyed by symbol and a lookup only compares integers.
+ */
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <stddef.h>
+
+/* 0 is never a valid symbol */
+typedef unsigned int Symbol;
+
+#define SYM_NONE 0
+
+Symbol sym_intern(const char* s, size_t len);
+Symbol sym_intern_str(const char* s);
+const char* sym_name(Symbol sym);
+unsigned int sym_hash(Symbol sym);
+unsigned int sym_count(void);
+int sym_is_rec(Symbol sym);
+void sym_set_rec(Symbol sym, int is_rec);
+void sym_clear_recs(void);
+void sym_clear(void);
+
+/* uthash helpers for tables keyed by a Symbol field, reusing the interned hash */
+#define HASH_FIND_SYM(head, symp, out) \
+        HASH_FIND_BYHASHVALUE(hh, head, symp, sizeof(Symbol), sym_hash(*(symp)), out)
+#define HASH_ADD_SYM(head, field, add) \
+        HASH_ADD_BYHASHVALUE(hh, head, field, sizeof(Symbol), sym_hash((add)->field), add)
+
+#endif
@@ -0,0 +1,40 @@
+/*
+ * Tasks and channels.
+ *
+ * spawn runs a function call in a forked child process, so tasks use
+ * every core without sharing the interpreter's globals. A task sees the
+ * heap as it was when it was spawned and hands back only its return
+ * value, read by join. Channels are unix SOCK_SEQPACKET socket pairs:
+ * every send is one message, any process holding the channel can send or
+ * receive, and a full channel blocks the sender. pmap forks the same
+ * way, its workers write their results into shared memory.
+ */
+#ifndef TASK_H
+#define TASK_H
+
+#include "ast.h"
+#include "var.h"
+
+/* the longest str a channel carries */
+#define CHAN_MAX_MSG 65536
+
+struct Chan {
+        VarType type;           /* a scalar type or TYPE_STRING */
+        int fd[2];              /* sends go to fd[0], receives read fd[1] */
+        int closed;             /* this process closed it or received the close */
+};
+
+/* nonzero in a task's process */
+extern int task_child;
+
+int task_spawn(Node* call);
+Var task_join(Node* at, int handle);
+ArrayList* task_map(Node* at, Node* func, ArrayList* arr, int n_workers);
+
+int chan_is_elem_type(VarType type);
+Chan* chan_new(Node* at, VarType type);
+void chan_send(Node* at, Chan* c, Var val);
+Var chan_recv(Node* at, Chan* c);
+void chan_close(Node* at, Chan* c);
+
+#endif
@@ -9,6 +9,9 @@
 
 typedef struct ArrayList ArrayList;
 typedef struct RecInst RecInst;
+typedef struct Dict Dict;
+typedef struct Chan Chan;
+typedef struct Gen Gen;
 
 typedef enum VarType {
         TYPE_INT,
@@ -21,23 +24,31 @@ typedef enum VarType {
         TYPE_ARRAY,
         TYPE_VOID,
         TYPE_REC,
-        TYPE_ANY
+        TYPE_ANY,
+        TYPE_DICT,
+        TYPE_CHAN,
+        TYPE_GEN
 } VarType;
 
+/* the value of a Var, dicts store it without the type */
+typedef union VarData {
+        int i;
+        unsigned int ui;
+        long l;
+        int b;
+        float f;
+        String* s;
+        char c;
+        ArrayList* a;
+        RecInst* r;
+        Dict* d;
+        Chan* ch;
+        Gen* g;
+} VarData;
+
 typedef struct Var {
         VarType type;
-
-        union {
-                int i;
-                unsigned int ui;
-                long l;
-                int b;
-                float f;
-                String* s;
-                char c;
-                ArrayList* a;
-                RecInst* r;
-        } data;
+        VarData data;
 
         int is_const;
 } Var;
@@ -0,0 +1,133 @@
+#include "allocprof.h"
+#include "gc_tri.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define REPORT_ROWS 25
+
+int allocprof_enabled = 0;
+const Node* alloc_site = NULL;
+
+/* indexed by NodeId, the last slot is for allocations outside any node */
+static unsigned long* site_counts = NULL;
+static unsigned long* site_bytes = NULL;
+static unsigned int n_sites = 0;
+static unsigned long kind_counts[GC_NUM_KINDS];
+static unsigned long kind_bytes[GC_NUM_KINDS];
+static unsigned int every = 1;
+static unsigned int countdown = 1;
+
+static void on_alloc(size_t size, GC_ScanFn scan)
+{
+        unsigned int id;
+        GC_Kind kind;
+
+        if (--countdown)
+                return;
+        countdown = every;
+
+        id = alloc_site ? (unsigned int) (alloc_site - ast_nodes) : n_sites - 1;
+        kind = gc_kind_of(scan);
+        site_counts[id] += every;
+        site_bytes[id] += size * every;
+        kind_counts[kind] += every;
+        kind_bytes[kind] += size * every;
+}
+
+/* records allocations from now on, the report is printed at exit */
+void allocprof_start(unsigned int sample_every)
+{
+        n_sites = ast_node_count() + 1;
+        site_counts = calloc(n_sites, sizeof(unsigned long));
+        site_bytes = calloc(n_sites, sizeof(unsigned long));
+        if (!site_counts || !site_bytes) {
+                fprintf(stderr, "Out of Memory Error\n");
+                exit(1);
+        }
+        every = sample_every ? sample_every : 1;
+        countdown = every;
+        allocprof_enabled = 1;
+        gc_set_alloc_hook(on_alloc);
+        /* die() exits, the report is still wanted */
+        atexit(allocprof_report);
+}
+
+static int by_bytes(const void* a, const void* b)
+{
+        unsigned long x = site_bytes[*(const unsigned int*) a];
+        unsigned long y = site_bytes[*(const unsigned int*) b];
+        return (x < y) - (x > y);
+}
+
+static void report_sites(unsigned long total)
+{
+        unsigned int* ids = malloc(sizeof(unsigned int) * n_sites);
+        unsigned int i;
+
+        for (i = 0; i < n_sites; i++)
+                ids[i] = i;
+        qsort(ids, n_sites, sizeof(unsigned int), by_bytes);
+
+        fprintf(stderr, "\n%-12s %-18s %14s %14s %7s\n",
+                "site", "type", "allocs", "bytes", "%");
+        for (i = 0; i < n_sites && i < REPORT_ROWS; i++) {
+                unsigned int id = ids[i];
+                char loc[32];
+                const char* type = "-";
+
+                if (!site_counts[id])
+                        break;
+                if (id == n_sites - 1) {
+                        sprintf(loc, "runtime");
+                }
+                else {
+                        const Node* n = &ast_nodes[id];
+                        sprintf(loc, "%d:%d", node_lineno(n), node_column(n));
+                        type = node_type_to_str((NodeType) n->type);
+                }
+                fprintf(stderr, "%-12s %-18s %14lu %14lu %6.2f%%\n",
+                        loc, type, site_counts[id], site_bytes[id],
+                        total ? 100.0 * site_bytes[id] / total : 0.0);
+        }
+        free(ids);
+}
+
+static void report_kinds(unsigned long total)
+{
+        int i;
+
+        fprintf(stderr, "\n%-18s %14s %14s %7s\n", "kind", "allocs", "bytes", "%");
+        for (i = 0; i < GC_NUM_KINDS; i++) {
+                if (!kind_counts[i])
+                        continue;
+                fprintf(stderr, "%-18s %14lu %14lu %6.2f%%\n",
+                        gc_kind_name((GC_Kind) i), kind_counts[i], kind_bytes[i],
+                        total ? 100.0 * kind_bytes[i] / total : 0.0);
+        }
+}
+
+/* prints the report to stderr once. must run before the ast is freed */
+void allocprof_report(void)
+{
+        unsigned long total = 0;
+        int i;
+
+        if (!allocprof_enabled)
+                return;
+        allocprof_enabled = 0;
+        gc_set_alloc_hook(NULL);
+
+        for (i = 0; i < GC_NUM_KINDS; i++)
+                total += kind_bytes[i];
+        if (every > 1)
+                fprintf(stderr, "\nsampled every %u allocations, totals are estimates\n", every);
+        report_sites(total);
+        report_kinds(total);
+
+        free(site_counts);
+        free(site_bytes);
+        site_counts = NULL;
+        site_bytes = NULL;
+        alloc_site = NULL;
+}
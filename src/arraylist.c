@@ -32,14 +32,14 @@ void arraylist_grow(ArrayList* a)
          * algorithm for determining new capacity
          * instead of just doubling it
          */
-        int new_cap = a->capacity *= 2;
-        Var* new_items = gc_realloc(
+        unsigned int new_cap = a->capacity * 2;
+
+        /* resized in place when possible, old buffer is freed right away */
+        a->items = gc_realloc(
                 a->items,
                 sizeof(Var) * new_cap,
                 scan_raw
         );
-
-        a->items = new_items;
         a->capacity = new_cap;
 }
 
@@ -57,7 +57,7 @@ void check_arr_bounds(ArrayList* a, int index)
                 die(NULL, "index out of bounds for index: %d in array", index);
 }
 
-Var build_zero_array_1d(VarType base, const char* recname, int size)
+Var build_zero_array_1d(VarType base, Symbol recname, int size)
 {
         ArrayList* a = arraylist_new(base, size);
         Var out;
@@ -95,7 +95,7 @@ Var build_zero_array_1d(VarType base, const char* recname, int size)
         return out;
 }
 
-static Var build_zero_array_nd(VarType base, const char* recname, int* dims, int ndims)
+static Var build_zero_array_nd(VarType base, Symbol recname, int* dims, int ndims)
 {
         ArrayList* a;
         Var out;
@@ -114,7 +114,7 @@ static Var build_zero_array_nd(VarType base, const char* recname, int* dims, int
         return out;
 }
 
-Var build_zero_array(VarType base, const char* recname, int* dims, int ndims)
+Var build_zero_array(VarType base, Symbol recname, int* dims, int ndims)
 {
         if (ndims <= 0)
                 return build_zero_array_1d(base, recname, 0);
@@ -5,15 +5,36 @@
  */
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
 #include "ast.h"
 
-static const char* node_type_to_str(NodeType t)
+/* flat ast, see ast_flatten() */
+Node* ast_nodes = NULL;
+NodeId* ast_kids = NULL;
+static int* ast_lines = NULL;
+static int* ast_columns = NULL;
+static unsigned int ast_n_nodes = 0;
+static unsigned int ast_n_kids = 0;
+
+/* set when the ast was mapped from a cache image instead of malloc'd */
+static void* ast_mapping = NULL;
+static size_t ast_mapping_size = 0;
+
+const char* node_type_to_str(NodeType t)
 {
         switch (t) {
         case NODE_NOP:         return "NODE_NOP";
         case NODE_NUM:         return "NODE_NUM";
+        case NODE_BOOL:        return "NODE_BOOL";
         case NODE_FLOAT:       return "NODE_FLOAT";
+        case NODE_STRING:      return "NODE_STRING";
+        case NODE_CHAR:        return "NODE_CHAR";
+        case NODE_AND:         return "NODE_AND";
+        case NODE_OR:          return "NODE_OR";
         case NODE_BINOP:       return "NODE_BINOP";
+        case NODE_COMPOUND:    return "NODE_COMPOUND";
+        case NODE_NOT:         return "NODE_NOT";
         case NODE_PRINT:       return "NODE_PRINT";
         case NODE_PRINTLN:     return "NODE_PRINTLN";
         case NODE_SEQ:         return "NODE_SEQ";
@@ -23,6 +44,9 @@ static const char* node_type_to_str(NodeType t)
         case NODE_IF:          return "NODE_IF";
         case NODE_IFELSE:      return "NODE_IFELSE";
         case NODE_FOR:         return "NODE_FOR";
+        case NODE_WHILE:       return "NODE_WHILE";
+        case NODE_PARFOR:      return "NODE_PARFOR";
+        case NODE_FORIN:       return "NODE_FORIN";
         case NODE_BREAK:       return "NODE_BREAK";
         case NODE_CONTINUE:    return "NODE_CONTINUE";
         case NODE_LT:          return "NODE_LT";
@@ -33,97 +57,131 @@ static const char* node_type_to_str(NodeType t)
         case NODE_NE:          return "NODE_NE";
         case NODE_FUNCDEF:     return "NODE_FUNCDEF";
         case NODE_FUNCCALL:    return "NODE_FUNCCALL";
+        case NODE_SPAWN:       return "NODE_SPAWN";
+        case NODE_YIELD:       return "NODE_YIELD";
         case NODE_RETURN:      return "NODE_RETURN";
         case NODE_IDX:         return "NODE_IDX";
         case NODE_IDXASSIGN:   return "NODE_IDXASSIGN";
         case NODE_ARRAYLIT:    return "NODE_ARRAYLIT";
         case NODE_ARRAYDECL:   return "NODE_ARRAYDECL";
+        case NODE_DICTDECL:    return "NODE_DICTDECL";
+        case NODE_CHANDECL:    return "NODE_CHANDECL";
+        case NODE_GENDECL:     return "NODE_GENDECL";
         case NODE_RECDEF:      return "NODE_RECDEF";
         case NODE_FIELDDECL:   return "NODE_FIELDDECL";
         case NODE_FIELDASSIGN: return "NODE_FIELDASSIGN";
         case NODE_FIELDACCESS: return "NODE_FIELDACCESS";
         case NODE_INCDEC:      return "NODE_INCDEC";
+        case NODE_LEN:         return "NODE_LEN";
+        case NODE_APPEND:      return "NODE_APPEND";
+        case NODE_ABS:         return "NODE_ABS";
         default:               return "UNKNOWN_NODE";
         }
         return "UNKNOWN_NODE"; /* unreachable */
 }
 
-Node* node(NodeType type, YYLTYPE loc, unsigned int n_children, ...)
+ParseNode* node(NodeType type, YYLTYPE loc, unsigned int n_children, ...)
 {
-        Node* n = malloc(sizeof(Node));
+        ParseNode* n = malloc(sizeof(ParseNode));
         unsigned int i;
         va_list args;
 
         n->type = type;
         n->n_children = n_children;
-        n->children = malloc(sizeof(Node*) * n_children);
+        n->children = malloc(sizeof(ParseNode*) * n_children);
         n->vartype = TYPE_VOID;
-        n->varname = NULL;
-        n->recname = NULL;
-        n->ndims = 0;
+        n->name = SYM_NONE;
+        n->recname = SYM_NONE;
+        n->ival = 0;
         n->lineno = loc.first_line;
         n->column = loc.first_column;
 
         va_start(args, n_children);
         for (i = 0; i < n_children; i++)
-                n->children[i] = va_arg(args, Node*);
+                n->children[i] = va_arg(args, ParseNode*);
         va_end(args);
 
         return n;
 }
 
-Node* node_binop(BinOp op, YYLTYPE loc, Node* lhs, Node* rhs)
+/* builtins that get their own node kind, see eval_expr() */
+static const struct {
+        const char* name;
+        unsigned int n_args;
+        NodeType type;
+} intrinsics[] = {
+        { "len",    1, NODE_LEN },
+        { "append", 2, NODE_APPEND },
+        { "abs",    1, NODE_ABS }
+};
+
+/* a user function of the same name turns one back into a call, see eval_intrinsic() */
+ParseNode* node_call(Symbol name, ParseNode* args, YYLTYPE loc)
 {
-        Node* binop = node(NODE_BINOP, loc, 2, lhs, rhs);
+        ParseNode* n = node(NODE_FUNCCALL, loc, 1, args);
+        const char* s = sym_name(name);
+        unsigned int i;
+
+        setname(n, name);
+        for (i = 0; i < sizeof(intrinsics) / sizeof(intrinsics[0]); i++) {
+                if (args->n_children == intrinsics[i].n_args && strcmp(s, intrinsics[i].name) == 0)
+                        n->type = intrinsics[i].type;
+        }
+        return n;
+}
+
+ParseNode* node_binop(BinOp op, YYLTYPE loc, ParseNode* lhs, ParseNode* rhs)
+{
+        ParseNode* binop = node(NODE_BINOP, loc, 2, lhs, rhs);
         binop->op = op;
         return binop;
 }
 
-Node* node_incdec(BinOp op, YYLTYPE loc, Node* child, int is_prefix)
+ParseNode* node_incdec(BinOp op, YYLTYPE loc, ParseNode* child, int is_prefix)
 {
-        Node* incdec = node(NODE_INCDEC, loc, 1, child);
+        ParseNode* incdec = node(NODE_INCDEC, loc, 1, child);
         incdec->op = op;
         incdec->ival = is_prefix;
         return incdec;
 }
 
-Node* node_compound(BinOp op, YYLTYPE loc, Node* lhs, Node* rhs)
+ParseNode* node_compound(BinOp op, YYLTYPE loc, ParseNode* lhs, ParseNode* rhs)
 {
-        Node* compound = node(NODE_COMPOUND, loc, 2, lhs, rhs);
+        ParseNode* compound = node(NODE_COMPOUND, loc, 2, lhs, rhs);
         compound->op = op;
         return compound;
 }
 
-void setvar(Node* node, VarType type, char* varname)
+void setvar(ParseNode* node, VarType type, Symbol name)
 {
         node->vartype = type;
-        node->varname = varname;
+        node->name = name;
 }
 
-void setname(Node* node, char* varname)
+void setname(ParseNode* node, Symbol name)
 {
-        node->varname = varname;
+        node->name = name;
 }
 
-void settype(Node* node, VarType type)
+void settype(ParseNode* node, VarType type)
 {
         node->vartype = type;
 }
 
-Node* node_uminus(Node* n, YYLTYPE loc)
+ParseNode* node_uminus(ParseNode* n, YYLTYPE loc)
 {
-        Node* zero = node(NODE_NUM, loc, 0);
-        Node* binop = node(NODE_BINOP, loc, 2, zero, n);
+        ParseNode* zero = node(NODE_NUM, loc, 0);
+        ParseNode* binop = node(NODE_BINOP, loc, 2, zero, n);
         zero->ival = 0;
         binop->op = OP_SUB;
         return binop;
 }
 
-Node* node_param(VarType type, int isarr, char* varname, YYLTYPE loc)
+ParseNode* node_param(VarType type, int isarr, Symbol name, YYLTYPE loc)
 {
         NodeType ntype = (isarr) ? NODE_ARRAYDECL : NODE_VARDECL;
-        Node* d = node(ntype, loc, 0);
-        d->varname = varname;
+        ParseNode* d = node(ntype, loc, 0);
+        d->name = name;
         /*d->vartype = type;*/
         d->vartype = (isarr) ? TYPE_ARRAY : type;
 
@@ -133,24 +191,169 @@ Node* node_param(VarType type, int isarr, char* varname, YYLTYPE loc)
         return d;
 }
 
-Node* node_append(Node* list, Node* child)
+ParseNode* node_append(ParseNode* list, ParseNode* child)
 {
         int old = list->n_children;
 
         list->n_children = old + 1;
-        list->children = realloc(list->children, sizeof(Node*) * list->n_children);
+        list->children = realloc(list->children, sizeof(ParseNode*) * list->n_children);
         list->children[old] = child;
 
         return list;
 }
 
-Node* node_append_type(Node* list, NodeType type, YYLTYPE loc)
+ParseNode* node_append_type(ParseNode* list, NodeType type, YYLTYPE loc)
 {
-        Node* n = node(type, loc, 0);
+        ParseNode* n = node(type, loc, 0);
         node_append(list, n);
         return n;
 }
 
+void free_parse_tree(ParseNode* node)
+{
+        unsigned int i;
+        if (!node)
+                return;
+
+        for (i = 0; i < node->n_children; i++) {
+                free_parse_tree(node->children[i]);
+        }
+
+        free(node->children);
+        free(node);
+}
+
+/* flattening */
+
+typedef struct FlatSize {
+        unsigned int n_nodes;
+        unsigned int n_kids;
+} FlatSize;
+
+typedef struct FlatCursor {
+        NodeId next_node;
+        NodeId next_kid;
+} FlatCursor;
+
+static void measure(const ParseNode* p, FlatSize* sz)
+{
+        unsigned int i;
+
+        sz->n_nodes++;
+        sz->n_kids += p->n_children;
+
+        for (i = 0; i < p->n_children; i++)
+                measure(p->children[i], sz);
+}
+
+/* lays out p and its subtree in pre-order, returns its id */
+static NodeId place(const ParseNode* p, FlatCursor* cur)
+{
+        NodeId id = cur->next_node++;
+        Node* n = &ast_nodes[id];
+        unsigned int i;
+
+        n->type = (unsigned char) p->type;
+        n->op = (unsigned char) p->op;
+        n->vartype = (unsigned char) p->vartype;
+        n->n_children = p->n_children;
+        n->kids = cur->next_kid;
+        n->name = p->name;
+
+        switch (p->type) {
+        case NODE_FLOAT:
+                n->u.fval = p->fval;
+                break;
+        case NODE_VARDECL:
+        case NODE_ARRAYDECL:
+                n->u.recname = p->recname;
+                break;
+        default:
+                n->u.ival = p->ival;
+                break;
+        }
+
+        ast_lines[id] = p->lineno;
+        ast_columns[id] = p->column;
+
+        cur->next_kid += p->n_children;
+        for (i = 0; i < p->n_children; i++)
+                ast_kids[n->kids + i] = place(p->children[i], cur);
+
+        return id;
+}
+
+/* the block holds nodes, child ids, lines and columns, in that order */
+static size_t layout_size(unsigned int n_nodes, unsigned int n_kids)
+{
+        return sizeof(Node) * n_nodes
+                + sizeof(NodeId) * n_kids
+                + 2 * sizeof(int) * n_nodes;
+}
+
+static void set_layout(char* block, unsigned int n_nodes, unsigned int n_kids)
+{
+        size_t nodes_bytes = sizeof(Node) * n_nodes;
+        size_t kids_bytes = sizeof(NodeId) * n_kids;
+        size_t lines_bytes = sizeof(int) * n_nodes;
+
+        ast_nodes = (Node*) block;
+        ast_kids = (NodeId*) (block + nodes_bytes);
+        ast_lines = (int*) (block + nodes_bytes + kids_bytes);
+        ast_columns = (int*) (block + nodes_bytes + kids_bytes + lines_bytes);
+        ast_n_nodes = n_nodes;
+        ast_n_kids = n_kids;
+}
+
+/*
+ * copies the parse tree into one allocation: the node array in pre-order,
+ * child indices and the line/column side tables.
+ * frees the parse tree and returns the root node.
+ */
+Node* ast_flatten(ParseNode* root)
+{
+        FlatSize sz = { 0, 0 };
+        FlatCursor cur;
+        char* block;
+
+        measure(root, &sz);
+
+        block = malloc(layout_size(sz.n_nodes, sz.n_kids));
+        if (!block) {
+                fprintf(stderr, "Out of Memory Error\n");
+                exit(1);
+        }
+
+        set_layout(block, sz.n_nodes, sz.n_kids);
+
+        cur.next_node = 0;
+        cur.next_kid = 0;
+        place(root, &cur);
+
+        free_parse_tree(root);
+        return &ast_nodes[0];
+}
+
+static int in_pool(const Node* node)
+{
+        return ast_nodes && node >= ast_nodes && node < ast_nodes + ast_n_nodes;
+}
+
+unsigned int ast_node_count(void)
+{
+        return ast_n_nodes;
+}
+
+int node_lineno(const Node* node)
+{
+        return in_pool(node) ? ast_lines[node - ast_nodes] : 0;
+}
+
+int node_column(const Node* node)
+{
+        return in_pool(node) ? ast_columns[node - ast_nodes] : 0;
+}
+
 void print_ast(Node* node, unsigned int depth)
 {
         unsigned int i;
@@ -160,25 +363,132 @@ void print_ast(Node* node, unsigned int depth)
 
         printf("node type: %s\n", node_type_to_str(node->type));
         for (i = 0; i < node->n_children; i++)
-                print_ast(node->children[i], depth + 1);
+                print_ast(CHILD(node, i), depth + 1);
 }
 
-void free_ast(Node* node)
+/* images, used by the script cache and snapshots */
+
+static int has_recname(const Node* n)
+{
+        return n->type == NODE_VARDECL || n->type == NODE_ARRAYDECL;
+}
+
+/*
+ * writes the flat ast block followed by the name of every symbol, NUL
+ * terminated and in symbol order. symbols are renumbered when the image
+ * is loaded into another process.
+ */
+int ast_write_image(FILE* f, AstImageInfo* info)
 {
+        size_t size = layout_size(ast_n_nodes, ast_n_kids);
         unsigned int i;
-        if (!node)
-                return;
 
-        for (i = 0; i < node->n_children; i++) {
-                free_ast(node->children[i]);
+        info->n_nodes = ast_n_nodes;
+        info->n_kids = ast_n_kids;
+        info->n_syms = sym_count();
+        info->sym_bytes = 0;
+
+        if (fwrite(ast_nodes, 1, size, f) != size)
+                return -1;
+        for (i = 1; i <= info->n_syms; i++) {
+                const char* name = sym_name(i);
+                size_t len = strlen(name) + 1;
+                if (fwrite(name, 1, len, f) != len)
+                        return -1;
+                info->sym_bytes += len;
         }
+        return 0;
+}
 
-        free(node->children);
+size_t ast_image_size(const AstImageInfo* info)
+{
+        return layout_size(info->n_nodes, info->n_kids) + info->sym_bytes;
+}
 
-        if (node->varname)
-                free(node->varname);
-        if (node->recname)
-                free(node->recname);
+static int remap_sym(Symbol* sym, const Symbol* remap, unsigned long n_syms)
+{
+        if (*sym > n_syms)
+                return -1;
+        *sym = remap[*sym];
+        return 0;
+}
 
-        free(node);
+/*
+ * adopts an image written by ast_write_image, interning its names and
+ * renumbering symbols in place. mapping is unmapped by free_ast().
+ * returns the root node, or NULL if the image is malformed.
+ */
+Node* ast_load_image(char* image, const AstImageInfo* info, void* mapping, size_t mapping_size)
+{
+        size_t size = layout_size(info->n_nodes, info->n_kids);
+        const char* names = image + size;
+        const char* end = names + info->sym_bytes;
+        Symbol* remap = malloc(sizeof(Symbol) * (info->n_syms + 1));
+        unsigned long i;
+        int bad = info->n_nodes == 0;
+
+        remap[SYM_NONE] = SYM_NONE;
+        for (i = 1; i <= info->n_syms && !bad; i++) {
+                const char* nul = memchr(names, '\0', end - names);
+                if (!nul) {
+                        bad = 1;
+                        break;
+                }
+                remap[i] = sym_intern(names, nul - names);
+                names = nul + 1;
+        }
+
+        set_layout(image, info->n_nodes, info->n_kids);
+        for (i = 0; i < ast_n_kids && !bad; i++) {
+                if (ast_kids[i] >= ast_n_nodes)
+                        bad = 1;
+        }
+        for (i = 0; i < ast_n_nodes && !bad; i++) {
+                Node* n = &ast_nodes[i];
+                /* CHILD() and the handler tables index with these unchecked */
+                if ((unsigned int) n->type >= NODE_LASTNODE
+                                || n->n_children > ast_n_kids
+                                || n->kids > ast_n_kids - n->n_children) {
+                        bad = 1;
+                        break;
+                }
+                if (remap_sym(&n->name, remap, info->n_syms) != 0
+                                || (has_recname(n) && remap_sym(&n->u.recname, remap, info->n_syms) != 0))
+                        bad = 1;
+                /* builtin call sites are resolved again in this process */
+                if (n->type == NODE_FUNCCALL || n->type == NODE_LEN
+                                || n->type == NODE_APPEND || n->type == NODE_ABS)
+                        n->u.ival = 0;
+        }
+        free(remap);
+
+        if (bad) {
+                ast_nodes = NULL;
+                ast_kids = NULL;
+                ast_n_nodes = 0;
+                ast_n_kids = 0;
+                return NULL;
+        }
+
+        ast_mapping = mapping;
+        ast_mapping_size = mapping_size;
+        return &ast_nodes[0];
+}
+
+/* the whole ast is a single allocation */
+void free_ast(Node* node)
+{
+        (void) node;
+        if (ast_mapping)
+                munmap(ast_mapping, ast_mapping_size);
+        else
+                free(ast_nodes);
+        ast_mapping = NULL;
+        ast_mapping_size = 0;
+        ast_nodes = NULL;
+        ast_kids = NULL;
+        ast_lines = NULL;
+        ast_columns = NULL;
+        ast_n_nodes = 0;
+        ast_n_kids = 0;
 }
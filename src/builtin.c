@@ -4,55 +4,67 @@
  */
 #include "builtin.h"
 #include "util.h"
+#include "profile.h"
+#include "func.h"
 #include "uthash.h"
 #include <stdlib.h>
 #include <string.h>
 
 typedef struct Builtin {
+        Symbol sym;
         const char* name;
-        VarType* param_types;
+        VarType param_types[BUILTIN_MAX_PARAMS];
         unsigned int n_params;
         VarType return_type;
         BuiltinFn fn;
+        int id;                 /* index in builtins */
         UT_hash_handle hh;
 } Builtin;
 
 static Builtin* builtin_table = NULL;
+static Builtin** builtins = NULL;
+static int n_builtins = 0;
 
 void builtin_register(const char* name, BuiltinFn fn, VarType ret_type, int n_params, ...)
 {
         Builtin* b;
-        VarType* param_types = NULL;
-        if (n_params > 0) {
-                va_list ap;
-                int i;
+        Symbol sym;
+        va_list ap;
+        int i;
 
-                param_types = malloc(sizeof(VarType) * n_params);
-                va_start(ap, n_params);
-                for (i = 0; i < n_params; i++)
-                        param_types[i] = va_arg(ap, VarType);
-                va_end(ap);
+        if (n_params > BUILTIN_MAX_PARAMS) {
+                fprintf(stderr, "Builtin function '%s' takes more than %d params.\n", name, BUILTIN_MAX_PARAMS);
+                return;
         }
 
-        HASH_FIND_STR(builtin_table, name, b);
+        sym = sym_intern_str(name);
+        HASH_FIND_SYM(builtin_table, &sym, b);
         if (b) {
                 fprintf(stderr, "Builtin function '%s' is already registered.\n", name);
                 return;
         }
 
         b = malloc(sizeof(Builtin));
-        b->name = strdup(name);
-        b->param_types = param_types;
+        b->sym = sym;
+        b->name = sym_name(sym);
         b->n_params = n_params;
         b->return_type = ret_type;
         b->fn = fn;
-        HASH_ADD_KEYPTR(hh, builtin_table, b->name, strlen(b->name), b);
+        va_start(ap, n_params);
+        for (i = 0; i < n_params; i++)
+                b->param_types[i] = va_arg(ap, VarType);
+        va_end(ap);
+
+        b->id = n_builtins;
+        builtins = realloc(builtins, sizeof(Builtin*) * (n_builtins + 1));
+        builtins[n_builtins++] = b;
+        HASH_ADD_SYM(builtin_table, sym, b);
 }
 
-Builtin* builtin_get(const char* name)
+Builtin* builtin_get(Symbol name)
 {
         Builtin* b;
-        HASH_FIND_STR(builtin_table, name, b);
+        HASH_FIND_SYM(builtin_table, &name, b);
         return b;
 }
 
@@ -62,35 +74,54 @@ void builtin_clear(void)
         Builtin* tmp;
         HASH_ITER(hh, builtin_table, cur, tmp) {
                 HASH_DEL(builtin_table, cur);
-                free(cur->param_types);
-                free((char*)cur->name);
                 free(cur);
         }
+        free(builtins);
+        builtins = NULL;
+        n_builtins = 0;
 }
 
-int call_builtin_if_exists(Node* node, Var* out)
+/*
+ * call sites are resolved on their first run and the result kept in the
+ * FUNCCALL node: 0 unresolved, -1 a user function, otherwise the builtin
+ * id + 1. the arg count is checked here, once per call site. a user
+ * function of the same name hides the builtin, so adding builtins does
+ * not break scripts.
+ */
+static int resolve(Node* node)
 {
-        Builtin* b = builtin_get(node->varname);
-        Var result;
-        Var* argv;
-        Node* argv_nodes;
-        unsigned int i;
+        Builtin* b = builtin_get(node->name);
+        Node* args = CHILD(node, 0);
 
-        if (!b)
-                return 0;
-
-        argv_nodes = node->children[0];
-        if (argv_nodes->n_children != b->n_params) {
+        if (!b || func_get(node->name))
+                return -1;
+        if (args->n_children != b->n_params) {
                 die(
                         node,
                         "function '%s' expects %d args, got %d",
-                        b->name, b->n_params, argv_nodes->n_children
+                        b->name, b->n_params, args->n_children
                 );
         }
+        return b->id + 1;
+}
 
-        argv = malloc(sizeof(Var) * b->n_params);
+/* args are evaluated into a fixed size array on the C stack, nothing is allocated */
+int call_builtin_if_exists(Node* node, Var* out)
+{
+        Var argv[BUILTIN_MAX_PARAMS];
+        Builtin* b;
+        Node* args;
+        unsigned int i;
+
+        if (node->u.ival == 0)
+                node->u.ival = resolve(node);
+        if (node->u.ival < 0)
+                return 0;
+
+        b = builtins[node->u.ival - 1];
+        args = CHILD(node, 0);
         for (i = 0; i < b->n_params; i++) {
-                argv[i] = eval_expr(argv_nodes->children[i]);
+                argv[i] = eval_expr(CHILD(args, i));
                 if (argv[i].type != b->param_types[i] && b->param_types[i] != TYPE_ANY) {
                         die(
                                 node,
@@ -100,16 +131,9 @@ int call_builtin_if_exists(Node* node, Var* out)
                 }
         }
 
-        result = b->fn(node, argv);
-        if (result.type != b->return_type) {
-                die(
-                        node,
-                        "function '%s': return type mismatch (expected %d, got %d)",
-                        b->name, b->return_type, result.type
-                );
-        }
-
-        free(argv);
-        *out = result;
+        /* return types are declared by builtin_register and not checked per call */
+        PROF_ENTER(node, 1);
+        *out = b->fn(node, argv);
+        PROF_LEAVE();
         return 1;
 }
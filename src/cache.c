@@ -0,0 +1,196 @@
+#include "cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CACHE_MAGIC "PUERC\0\0\0"
+#define CACHE_FORMAT 7
+
+/* must match exactly for a cache file to be used */
+typedef struct CacheHeader {
+        char magic[8];
+        char build[64];          /* interpreter version and build */
+        unsigned long format;
+        unsigned long node_size;
+        unsigned long node_types;
+        unsigned long src_hash;
+        unsigned long src_size;
+        AstImageInfo info;
+} CacheHeader;
+
+static char cache_path[4096];
+static CacheHeader pending;
+static int have_pending = 0;
+
+static void fill_build(char* build)
+{
+        memset(build, 0, sizeof(pending.build));
+        strncpy(build, PUER_VERSION " " __DATE__ " " __TIME__, sizeof(pending.build) - 1);
+}
+
+/* 64 bit FNV-1a */
+static unsigned long hash_bytes(const unsigned char* p, size_t n)
+{
+        unsigned long h = 14695981039346656037UL;
+        size_t i;
+        for (i = 0; i < n; i++) {
+                h ^= p[i];
+                h *= 1099511628211UL;
+        }
+        return h;
+}
+
+static int hash_file(const char* path, unsigned long* hash, unsigned long* size)
+{
+        int fd = open(path, O_RDONLY);
+        struct stat st;
+        void* src;
+
+        if (fd < 0)
+                return -1;
+        if (fstat(fd, &st) != 0) {
+                close(fd);
+                return -1;
+        }
+
+        *size = (unsigned long) st.st_size;
+        if (st.st_size == 0) {
+                *hash = hash_bytes(NULL, 0);
+                close(fd);
+                return 0;
+        }
+
+        src = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (src == MAP_FAILED)
+                return -1;
+        *hash = hash_bytes(src, st.st_size);
+        munmap(src, st.st_size);
+        return 0;
+}
+
+static void make_dir(const char* path)
+{
+        mkdir(path, 0755);
+}
+
+/* builds the cache file name for a source hash into cache_path */
+static void set_cache_path(const char* src_path, unsigned long hash)
+{
+        const char* xdg = getenv("XDG_CACHE_HOME");
+        const char* home = getenv("HOME");
+        char dir[4000];
+
+        if (xdg && *xdg) {
+                sprintf(dir, "%.3990s", xdg);
+        }
+        else if (home && *home) {
+                sprintf(dir, "%.3900s/.cache", home);
+                make_dir(dir);
+        }
+        else {
+                sprintf(cache_path, "%.4000sc", src_path);
+                return;
+        }
+
+        make_dir(dir);
+        strcat(dir, "/puer");
+        make_dir(dir);
+        sprintf(cache_path, "%s/%016lx.puerc", dir, hash);
+}
+
+/* returns the program if a valid cache file exists for src_path */
+Node* cache_load(const char* src_path)
+{
+        CacheHeader want;
+        CacheHeader* got;
+        Node* program;
+        struct stat st;
+        char* map;
+        int fd;
+
+        memset(&want, 0, sizeof(want));
+        if (hash_file(src_path, &want.src_hash, &want.src_size) != 0)
+                return NULL;
+
+        memcpy(want.magic, CACHE_MAGIC, sizeof(want.magic));
+        fill_build(want.build);
+        want.format = CACHE_FORMAT;
+        want.node_size = sizeof(Node);
+        want.node_types = NODE_LASTNODE;
+
+        /* remembered for cache_store() on a miss */
+        pending = want;
+        have_pending = 1;
+        set_cache_path(src_path, want.src_hash);
+
+        fd = open(cache_path, O_RDONLY);
+        if (fd < 0)
+                return NULL;
+        if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(CacheHeader)) {
+                close(fd);
+                return NULL;
+        }
+
+        map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED)
+                return NULL;
+
+        got = (CacheHeader*) map;
+        if (memcmp(got->magic, want.magic, sizeof(want.magic)) != 0
+                        || memcmp(got->build, want.build, sizeof(want.build)) != 0
+                        || got->format != want.format
+                        || got->node_size != want.node_size
+                        || got->node_types != want.node_types
+                        || got->src_hash != want.src_hash
+                        || got->src_size != want.src_size
+                        || sizeof(CacheHeader) + ast_image_size(&got->info) != (size_t) st.st_size) {
+                munmap(map, st.st_size);
+                return NULL;
+        }
+
+        program = ast_load_image(map + sizeof(CacheHeader), &got->info, map, st.st_size);
+        if (!program)
+                munmap(map, st.st_size);
+        return program;
+}
+
+/*
+ * writes the current flat ast for the script passed to the last
+ * cache_load(), after it missed. written to a temp file and renamed so readers never see a
+ * partial file. failures are silent, the cache is only an optimization.
+ */
+void cache_store(void)
+{
+        char tmp[4200];
+        FILE* f;
+        int ok;
+
+        if (!have_pending)
+                return;
+
+        sprintf(tmp, "%s.%ld.tmp", cache_path, (long) getpid());
+        f = fopen(tmp, "wb");
+        if (!f)
+                return;
+
+        ok = fwrite(&pending, sizeof(pending), 1, f) == 1;
+        if (ok)
+                ok = ast_write_image(f, &pending.info) == 0;
+        if (ok) {
+                /* header again now that the image sizes are known */
+                ok = fseek(f, 0, SEEK_SET) == 0
+                        && fwrite(&pending, sizeof(pending), 1, f) == 1;
+        }
+        if (fclose(f) != 0)
+                ok = 0;
+
+        if (!ok || rename(tmp, cache_path) != 0)
+                remove(tmp);
+}
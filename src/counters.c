@@ -0,0 +1,181 @@
+#include "counters.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define REPORT_ROWS 25
+
+int counters_enabled = 0;
+
+/* indexed by NodeId */
+static unsigned long* node_counts = NULL;
+static double* node_ms = NULL;
+static unsigned int n_nodes = 0;
+static unsigned long type_counts[NODE_LASTNODE];
+
+static double now_ms(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* counting starts with the current ast, the report is printed at exit */
+void counters_start(void)
+{
+        n_nodes = ast_node_count();
+        node_counts = calloc(n_nodes, sizeof(unsigned long));
+        node_ms = calloc(n_nodes, sizeof(double));
+        if (!node_counts || !node_ms) {
+                fprintf(stderr, "Out of Memory Error\n");
+                exit(1);
+        }
+        counters_enabled = 1;
+        /* die() exits, the counts are still wanted */
+        atexit(counters_report);
+}
+
+double counters_begin(const Node* node)
+{
+        type_counts[node->type]++;
+        return now_ms();
+}
+
+/* inclusive, so a statement that recurses also counts its nested runs */
+void counters_end(const Node* node, double start)
+{
+        unsigned int id = (unsigned int) (node - ast_nodes);
+        node_counts[id]++;
+        node_ms[id] += now_ms() - start;
+}
+
+void counters_expr(const Node* node)
+{
+        type_counts[node->type]++;
+}
+
+static const unsigned long* sort_counts;
+static const double* sort_ms;
+
+static int by_ms(const void* a, const void* b)
+{
+        double x = sort_ms[*(const unsigned int*) a];
+        double y = sort_ms[*(const unsigned int*) b];
+        return (x < y) - (x > y);
+}
+
+static int by_count(const void* a, const void* b)
+{
+        unsigned long x = sort_counts[*(const unsigned int*) a];
+        unsigned long y = sort_counts[*(const unsigned int*) b];
+        return (x < y) - (x > y);
+}
+
+static unsigned int* sorted_ids(unsigned int n, int (*cmp)(const void*, const void*))
+{
+        unsigned int* ids = malloc(sizeof(unsigned int) * (n + 1));
+        unsigned int i;
+        for (i = 0; i < n; i++)
+                ids[i] = i;
+        qsort(ids, n, sizeof(unsigned int), cmp);
+        return ids;
+}
+
+static void report_statements(void)
+{
+        unsigned int* ids;
+        unsigned int i;
+
+        sort_counts = node_counts;
+        sort_ms = node_ms;
+        ids = sorted_ids(n_nodes, by_ms);
+
+        fprintf(stderr, "\n%-12s %-18s %14s %12s %10s\n",
+                "statement", "type", "count", "incl ms", "ns/exec");
+        for (i = 0; i < n_nodes && i < REPORT_ROWS; i++) {
+                const Node* n = &ast_nodes[ids[i]];
+                char loc[32];
+                if (!node_counts[ids[i]])
+                        break;
+                sprintf(loc, "%d:%d", node_lineno(n), node_column(n));
+                fprintf(stderr, "%-12s %-18s %14lu %12.3f %10.1f\n",
+                        loc,
+                        node_type_to_str((NodeType) n->type),
+                        node_counts[ids[i]],
+                        node_ms[ids[i]],
+                        node_ms[ids[i]] * 1e6 / node_counts[ids[i]]);
+        }
+        free(ids);
+}
+
+static void report_lines(void)
+{
+        unsigned long* line_counts;
+        unsigned int* ids;
+        unsigned int max_line = 0;
+        unsigned int i;
+
+        for (i = 0; i < n_nodes; i++) {
+                int line = node_lineno(&ast_nodes[i]);
+                if (line > 0 && (unsigned int) line > max_line)
+                        max_line = (unsigned int) line;
+        }
+
+        line_counts = calloc(max_line + 1, sizeof(unsigned long));
+        for (i = 0; i < n_nodes; i++)
+                line_counts[node_lineno(&ast_nodes[i])] += node_counts[i];
+
+        sort_counts = line_counts;
+        ids = sorted_ids(max_line + 1, by_count);
+
+        fprintf(stderr, "\n%-12s %14s\n", "line", "count");
+        for (i = 0; i <= max_line && i < REPORT_ROWS; i++) {
+                if (!line_counts[ids[i]])
+                        break;
+                fprintf(stderr, "%-12u %14lu\n", ids[i], line_counts[ids[i]]);
+        }
+        free(ids);
+        free(line_counts);
+}
+
+static void report_types(void)
+{
+        unsigned long total = 0;
+        unsigned int* ids;
+        unsigned int i;
+
+        for (i = 0; i < NODE_LASTNODE; i++)
+                total += type_counts[i];
+
+        sort_counts = type_counts;
+        ids = sorted_ids(NODE_LASTNODE, by_count);
+
+        fprintf(stderr, "\n%-18s %14s %7s\n", "node type", "dispatches", "%");
+        for (i = 0; i < NODE_LASTNODE; i++) {
+                if (!type_counts[ids[i]])
+                        break;
+                fprintf(stderr, "%-18s %14lu %6.2f%%\n",
+                        node_type_to_str((NodeType) ids[i]),
+                        type_counts[ids[i]],
+                        100.0 * type_counts[ids[i]] / total);
+        }
+        free(ids);
+}
+
+/* prints the report to stderr once. must run before the ast is freed */
+void counters_report(void)
+{
+        if (!counters_enabled)
+                return;
+        counters_enabled = 0;
+
+        report_statements();
+        report_lines();
+        report_types();
+
+        free(node_counts);
+        free(node_ms);
+        node_counts = NULL;
+        node_ms = NULL;
+}
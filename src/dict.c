@@ -0,0 +1,409 @@
+#include "dict.h"
+#include "puerstring.h"
+#include "scan.h"
+#include "parfor.h"
+#include "util.h"
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define CTRL_EMPTY 0x80
+#define CTRL_DELETED 0xFE
+#define DICT_MAX_CAP (1U << 28)
+
+/* h1 picks the first group to probe, h2 is kept in the control byte */
+#define H1(h) ((h) >> 7)
+#define H2(h) ((unsigned char) ((h) & 0x7F))
+#define IS_FULL(c) (!((c) & 0x80))
+
+/* bit i is set when control byte i of the group equals b */
+static unsigned int group_match(const unsigned char* g, unsigned char b)
+{
+#ifdef __SSE2__
+        __m128i ctrl = _mm_loadu_si128((const __m128i*) g);
+        return (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char) b)));
+#else
+        unsigned int m = 0;
+        unsigned int i;
+        for (i = 0; i < DICT_GROUP; i++)
+                m |= (unsigned int) (g[i] == b) << i;
+        return m;
+#endif
+}
+
+/* empty and deleted slots, both have the high bit set */
+static unsigned int group_free(const unsigned char* g)
+{
+#ifdef __SSE2__
+        return (unsigned int) _mm_movemask_epi8(_mm_loadu_si128((const __m128i*) g));
+#else
+        unsigned int m = 0;
+        unsigned int i;
+        for (i = 0; i < DICT_GROUP; i++)
+                m |= (unsigned int) (g[i] >> 7) << i;
+        return m;
+#endif
+}
+
+static unsigned int first_bit(unsigned int m)
+{
+#ifdef __GNUC__
+        return (unsigned int) __builtin_ctz(m);
+#else
+        unsigned int i = 0;
+        while (!(m & 1)) {
+                m >>= 1;
+                i++;
+        }
+        return i;
+#endif
+}
+
+static unsigned int mix(unsigned long x)
+{
+        x ^= (x >> 16) >> 16;
+        x ^= x >> 16;
+        x *= 0x45d9f3bUL;
+        x ^= x >> 16;
+        x *= 0x45d9f3bUL;
+        x ^= x >> 16;
+        return (unsigned int) x;
+}
+
+static unsigned int hash_key(const Dict* d, VarData key)
+{
+        unsigned long h = 2166136261UL;
+        unsigned int i;
+
+        if (d->key_type != TYPE_STRING)
+                return mix((unsigned long) key.l);
+
+        for (i = 0; i < key.s->length; i++) {
+                h ^= (unsigned char) key.s->data[i];
+                h = (h * 16777619UL) & 0xFFFFFFFFUL;
+        }
+        return mix(h);
+}
+
+int dict_is_key_type(VarType type)
+{
+        switch (type) {
+        case TYPE_INT:
+        case TYPE_UINT:
+        case TYPE_LONG:
+        case TYPE_CHAR:
+        case TYPE_BOOL:
+        case TYPE_STRING:
+                return 1;
+        default:
+                return 0;
+        }
+}
+
+/* the key with unused bytes cleared, so scalar keys compare as longs */
+static VarData key_of(Node* at, const Dict* d, Var key)
+{
+        VarData out;
+
+        if (key.type != d->key_type)
+                die(at, "dict key: expected type %d, got %d", d->key_type, key.type);
+
+        out.l = 0;
+        switch (key.type) {
+        case TYPE_INT:
+                out.i = key.data.i;
+                break;
+        case TYPE_UINT:
+                out.ui = key.data.ui;
+                break;
+        case TYPE_CHAR:
+                out.c = key.data.c;
+                break;
+        case TYPE_BOOL:
+                out.b = key.data.b;
+                break;
+        default:
+                out = key.data;
+                break;
+        }
+        return out;
+}
+
+static int key_equal(const Dict* d, const DictSlot* slot, VarData key, unsigned int hash)
+{
+        if (slot->hash != hash)
+                return 0;
+        if (d->key_type != TYPE_STRING)
+                return slot->key.l == key.l;
+        return slot->key.s->length == key.s->length
+                && memcmp(slot->key.s->data, key.s->data, key.s->length) == 0;
+}
+
+/*
+ * groups are probed in triangular order, which visits every group of a
+ * power of two table. a group holding an empty slot ends the search.
+ */
+static long find_slot(const Dict* d, VarData key, unsigned int hash)
+{
+        unsigned int mask;
+        unsigned int g;
+        unsigned int step;
+
+        if (!d->size)
+                return -1;
+
+        mask = d->cap / DICT_GROUP - 1;
+        g = H1(hash) & mask;
+        for (step = 1; ; step++) {
+                const unsigned char* ctrl = d->ctrl + g * DICT_GROUP;
+                unsigned int m;
+
+                for (m = group_match(ctrl, H2(hash)); m; m &= m - 1) {
+                        unsigned int i = g * DICT_GROUP + first_bit(m);
+                        if (key_equal(d, &d->slots[i], key, hash))
+                                return (long) i;
+                }
+                if (group_match(ctrl, CTRL_EMPTY))
+                        return -1;
+                g = (g + step) & mask;
+        }
+}
+
+static unsigned int find_free(const Dict* d, unsigned int hash)
+{
+        unsigned int mask = d->cap / DICT_GROUP - 1;
+        unsigned int g = H1(hash) & mask;
+        unsigned int step;
+
+        for (step = 1; ; step++) {
+                unsigned int m = group_free(d->ctrl + g * DICT_GROUP);
+                if (m)
+                        return g * DICT_GROUP + first_bit(m);
+                g = (g + step) & mask;
+        }
+}
+
+/* smallest capacity holding n entries under the 7/8 load limit */
+static unsigned int cap_for(Node* at, unsigned long n)
+{
+        unsigned int cap = DICT_GROUP;
+
+        while (n * 8 > (unsigned long) cap * 7) {
+                if (cap >= DICT_MAX_CAP)
+                        die(at, "dict too large");
+                cap *= 2;
+        }
+        return cap;
+}
+
+/* moves every entry into fresh buffers of new_cap slots, dropping tombstones */
+static void rehash(Dict* d, unsigned int new_cap)
+{
+        unsigned char* old_ctrl = d->ctrl;
+        DictSlot* old_slots = d->slots;
+        unsigned int old_cap = d->cap;
+        unsigned int i;
+
+        d->ctrl = gc_alloc(new_cap, scan_raw);
+        memset(d->ctrl, CTRL_EMPTY, new_cap);
+        d->slots = gc_alloc(sizeof(DictSlot) * new_cap, scan_raw);
+        d->cap = new_cap;
+        d->tombstones = 0;
+
+        for (i = 0; i < old_cap; i++) {
+                unsigned int j;
+                if (!IS_FULL(old_ctrl[i]))
+                        continue;
+                j = find_free(d, old_slots[i].hash);
+                d->ctrl[j] = H2(old_slots[i].hash);
+                d->slots[j] = old_slots[i];
+        }
+
+        gc_free(old_ctrl);
+        gc_free(old_slots);
+}
+
+Dict* dict_new(VarType key_type, VarType val_type)
+{
+        Dict* d = gc_alloc(sizeof(Dict), scan_dict);
+        d->key_type = key_type;
+        d->val_type = val_type;
+        d->size = 0;
+        d->tombstones = 0;
+        d->cap = 0;
+        d->ctrl = NULL;
+        d->slots = NULL;
+        return d;
+}
+
+/* same layout as src, keys and values are cloned */
+Dict* dict_clone(const Dict* src)
+{
+        Dict* dst = dict_new(src->key_type, src->val_type);
+        unsigned int i;
+
+        if (!src->cap)
+                return dst;
+
+        dst->ctrl = gc_alloc(src->cap, scan_raw);
+        memcpy(dst->ctrl, src->ctrl, src->cap);
+        dst->slots = gc_alloc(sizeof(DictSlot) * src->cap, scan_raw);
+        memcpy(dst->slots, src->slots, sizeof(DictSlot) * src->cap);
+        dst->cap = src->cap;
+        dst->size = src->size;
+        dst->tombstones = src->tombstones;
+
+        for (i = dict_next(dst, 0); i < dst->cap; i = dict_next(dst, i + 1)) {
+                Var v = dict_val_at(dst, i);
+                if (dst->key_type == TYPE_STRING)
+                        dst->slots[i].key.s = string_clone(dst->slots[i].key.s);
+                dst->slots[i].val = var_clone(&v).data;
+        }
+        return dst;
+}
+
+Var dict_get(Node* at, const Dict* d, Var key)
+{
+        VarData k = key_of(at, d, key);
+        long i = find_slot(d, k, hash_key(d, k));
+
+        if (i < 0)
+                die(at, "key not found in dict");
+        return dict_val_at(d, (unsigned int) i);
+}
+
+int dict_has(Node* at, const Dict* d, Var key)
+{
+        VarData k = key_of(at, d, key);
+        return find_slot(d, k, hash_key(d, k)) >= 0;
+}
+
+void dict_set(Node* at, Dict* d, Var key, Var val)
+{
+        VarData k = key_of(at, d, key);
+        unsigned int hash = hash_key(d, k);
+        long i;
+        unsigned int j;
+
+        if (val.type != d->val_type)
+                die(at, "type mismatch: dict holds %d but got %d", d->val_type, val.type);
+        if (parfor_worker)
+                parfor_check_owned(at, d, "change a dict");
+
+        if ((i = find_slot(d, k, hash)) >= 0) {
+                d->slots[i].val = val.data;
+                return;
+        }
+
+        if ((unsigned long) (d->size + d->tombstones + 1) * 8 > (unsigned long) d->cap * 7) {
+                unsigned int cap = cap_for(at, ((unsigned long) d->size + 1) * 2);
+                rehash(d, cap > d->cap ? cap : d->cap);
+        }
+
+        /* the key can be changed by its owner, keep a copy */
+        if (d->key_type == TYPE_STRING)
+                k.s = string_clone(k.s);
+
+        j = find_free(d, hash);
+        if (d->ctrl[j] == CTRL_DELETED)
+                d->tombstones--;
+        d->ctrl[j] = H2(hash);
+        d->slots[j].key = k;
+        d->slots[j].val = val.data;
+        d->slots[j].hash = hash;
+        d->size++;
+}
+
+/*
+ * a slot goes back to empty when its group still has an empty slot, no
+ * probe went past that group. otherwise it becomes a tombstone.
+ */
+int dict_remove(Node* at, Dict* d, Var key)
+{
+        VarData k = key_of(at, d, key);
+        long i = find_slot(d, k, hash_key(d, k));
+        unsigned char* group;
+
+        if (i < 0)
+                return 0;
+        if (parfor_worker)
+                parfor_check_owned(at, d, "change a dict");
+
+        group = d->ctrl + (i & ~(long) (DICT_GROUP - 1));
+        if (group_match(group, CTRL_EMPTY)) {
+                d->ctrl[i] = CTRL_EMPTY;
+        }
+        else {
+                d->ctrl[i] = CTRL_DELETED;
+                d->tombstones++;
+        }
+        d->size--;
+        return 1;
+}
+
+/* makes room for n entries without growing */
+void dict_reserve(Node* at, Dict* d, long n)
+{
+        unsigned int cap;
+
+        if (n < 0)
+                die(at, "reserve: size must not be negative");
+        cap = cap_for(at, (unsigned long) n);
+        if (cap > d->cap) {
+                if (parfor_worker)
+                        parfor_check_owned(at, d, "change a dict");
+                rehash(d, cap);
+        }
+}
+
+/* index of the first full slot at or after i, d->cap when there is none */
+unsigned int dict_next(const Dict* d, unsigned int i)
+{
+        while (i < d->cap && !IS_FULL(d->ctrl[i]))
+                i++;
+        return i;
+}
+
+Var dict_key_at(const Dict* d, unsigned int i)
+{
+        Var out;
+        out.type = d->key_type;
+        out.data = d->slots[i].key;
+        out.is_const = 0;
+        return out;
+}
+
+Var dict_val_at(const Dict* d, unsigned int i)
+{
+        Var out;
+        out.type = d->val_type;
+        out.data = d->slots[i].val;
+        out.is_const = 0;
+        return out;
+}
+
+/* string keys are copied, the dict's own copies must not be changed */
+ArrayList* dict_keys(const Dict* d)
+{
+        ArrayList* a = arraylist_new(d->key_type, d->size);
+        unsigned int i;
+
+        for (i = dict_next(d, 0); i < d->cap; i = dict_next(d, i + 1)) {
+                Var k = dict_key_at(d, i);
+                arraylist_push(a, var_clone(&k));
+        }
+        return a;
+}
+
+ArrayList* dict_values(const Dict* d)
+{
+        ArrayList* a = arraylist_new(d->val_type, d->size);
+        unsigned int i;
+
+        for (i = dict_next(d, 0); i < d->cap; i = dict_next(d, i + 1))
+                arraylist_push(a, dict_val_at(d, i));
+        return a;
+}
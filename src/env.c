@@ -5,7 +5,6 @@
 #include "env.h"
 #include "scan.h"
 #include <stdlib.h>
-#include <string.h>
 #include <stdio.h>
 
 
@@ -23,53 +22,69 @@ void env_push(void)
 /* remove a variable scope from the stack */
 void env_pop(void)
 {
-        VarEntry* cur;
-        VarEntry* tmp;
-
         if (!env_stack)
                 return;
 
-        HASH_ITER(hh, env_stack->table, cur, tmp) {
-                HASH_DEL(env_stack->table, cur);
-                free((char*)cur->name);
-        }
+        /* names are interned, only the bucket array needs freeing */
+        HASH_CLEAR(hh, env_stack->table);
 
         env_stack = env_stack->next;
 }
 
-Var* env_get(const char* name)
+/* remove the top scope but keep its variables, for a generator to run in later */
+Scope* env_detach(void)
+{
+        Scope* s = env_stack;
+
+        if (s)
+                env_stack = s->next;
+        return s;
+}
+
+Var* env_get(Symbol name)
+{
+        Scope* scope = env_stack;
+
+        while (scope) {
+                VarEntry* entry;
+                HASH_FIND_SYM(scope->table, &name, entry);
+                if (entry)
+                        return env_entry_var(entry);
+                scope = scope->next;
+        }
+        return NULL;
+}
+
+/* the entry a name resolves to, references are not followed */
+VarEntry* env_get_entry(Symbol name)
 {
         Scope* scope = env_stack;
 
         while (scope) {
                 VarEntry* entry;
-                HASH_FIND_STR(scope->table, name, entry);
-                if (entry && entry->is_ptr)
-                        return entry->alias;
-                else if (entry)
-                        return &entry->val;
+                HASH_FIND_SYM(scope->table, &name, entry);
+                if (entry)
+                        return entry;
                 scope = scope->next;
         }
         return NULL;
 }
 
 /* only search top level scope */
-Var* env_get_top(const char* name)
+Var* env_get_top(Symbol name)
 {
         VarEntry* entry;
 
         if (!env_stack)
                 return NULL;
 
-        HASH_FIND_STR(env_stack->table, name, entry);
-        if (entry && entry->is_ptr)
-                return entry->alias;
-        else if (entry)
-                return &entry->val;
+        HASH_FIND_SYM(env_stack->table, &name, entry);
+        if (entry)
+                return env_entry_var(entry);
         return NULL;
 }
 
-void env_set(const char* name, Var val)
+void env_set(Symbol name, Var val)
 {
         VarEntry* entry;
 
@@ -77,18 +92,19 @@ void env_set(const char* name, Var val)
                 env_push();
         }
 
-        HASH_FIND_STR(env_stack->table, name, entry);
+        HASH_FIND_SYM(env_stack->table, &name, entry);
         if (!entry) {
                 entry = gc_alloc(sizeof(VarEntry), scan_varentry);
-                entry->name = strdup(name);
+                entry->name = name;
                 entry->is_ptr = 0;
-                HASH_ADD_KEYPTR(hh, env_stack->table, entry->name, strlen(entry->name), entry);
+                HASH_ADD_SYM(env_stack->table, name, entry);
         }
         entry->val = val;
         entry->alias = NULL;
+        entry->elem_of = NULL;
 }
 
-void env_set_ptr(const char* name, Var* target)
+static VarEntry* set_ref(Symbol name)
 {
         VarEntry* entry;
 
@@ -96,14 +112,42 @@ void env_set_ptr(const char* name, Var* target)
                 env_push();
         }
 
-        HASH_FIND_STR(env_stack->table, name, entry);
+        HASH_FIND_SYM(env_stack->table, &name, entry);
         if (!entry) {
                 entry = gc_alloc(sizeof(VarEntry), scan_varentry);
-                entry->name = strdup(name);
+                entry->name = name;
                 entry->is_ptr = 1;
-                HASH_ADD_KEYPTR(hh, env_stack->table, entry->name, strlen(entry->name), entry);
+                HASH_ADD_SYM(env_stack->table, name, entry);
         }
+        return entry;
+}
+
+void env_set_ptr(Symbol name, Var* target)
+{
+        VarEntry* entry = set_ref(name);
+
         entry->alias = target;
+        entry->elem_of = NULL;
+}
+
+/* by index, a pointer into items would dangle once the array grows */
+void env_set_elem(Symbol name, ArrayList* a, int idx)
+{
+        VarEntry* entry = set_ref(name);
+
+        entry->alias = NULL;
+        entry->elem_of = a;
+        entry->elem_idx = idx;
+}
+
+/* the Var a name stands for, following references */
+Var* env_entry_var(VarEntry* entry)
+{
+        if (entry->elem_of)
+                return &entry->elem_of->items[entry->elem_idx];
+        if (entry->is_ptr)
+                return entry->alias;
+        return &entry->val;
 }
 
 void env_clear()
@@ -4,15 +4,38 @@
 #include "ops.h"
 #include "func.h"
 #include "builtin.h"
+#include "puerlib.h"
 #include "arraylist.h"
 #include "rec.h"
+#include "dict.h"
 #include "gc_tri.h"
+#include "heapdump.h"
+#include "profile.h"
+#include "counters.h"
+#include "allocprof.h"
+#include "parfor.h"
+#include "task.h"
+#include "gen.h"
+#include "output.h"
 
 #include <stdlib.h>
 #include <stdio.h>
 
 typedef void (*StmtHandler)(Node*);
 
+/*
+ * an assignable location, resolved once so compound assignment and
+ * inc/dec evaluate the index and container expressions a single time.
+ * slots are found again on every access, evaluating the right hand side
+ * can grow an array or compact the buffer a slot lives in.
+ */
+typedef struct LValue {
+        Node* node;
+        Var container;  /* NODE_IDX: the array, string or dict, NODE_FIELDACCESS: the record */
+        int idx;        /* element or field index */
+        Var key;        /* NODE_IDX of a dict */
+} LValue;
+
 typedef enum {
         CTRL_NONE,
         CTRL_BREAK,
@@ -37,17 +60,26 @@ void eval_if(Node* node);
 void eval_ifelse(Node* node);
 void eval_for(Node* node);
 void eval_while(Node* node);
+void eval_parfor(Node* node);
+void eval_forin(Node* node);
 void eval_nop(Node* node);
 void eval_funcdef(Node* node);
 void eval_funccall_stmt(Node* node);
 void eval_idxassign_stmt(Node* node);
 void eval_arraydecl(Node* node);
+void eval_dictdecl(Node* node);
+void eval_chandecl(Node* node);
+void eval_gendecl(Node* node);
+void eval_spawn_stmt(Node* node);
+void eval_yield_stmt(Node* node);
 void eval_compound_stmt(Node* node);
 void eval_incdec_stmt(Node* node);
 void eval_recdef(Node* node);
 void eval_fieldassign_stmt(Node* node);
+void eval_intrinsic_stmt(Node* node);
 
 Var eval_funccall(Node* node);
+Var eval_intrinsic(Node* node);
 Var eval_assign_expr(Node* node);
 Var eval_idxassign_expr(Node* node);
 Var eval_compound_expr(Node* node);
@@ -60,10 +92,16 @@ void print_var(Node* node, const Var* v);
 int var_to_idx(Node* node, Var v);
 Var index_store(Node* node, Var container, int idx, Var val);
 Var index_load(Node* node, Var container, int idx);
-Var load_lvalue(Node* L);
-Var* lvalue_ptr(Node* L);
-void assign_lvalue(Node* L, Var val);
-Var init_var(Node* ctx, VarType type, Node* init_node, const char* recname);
+int is_lvalue(const Node* n);
+void resolve_lvalue(Node* L, LValue* out);
+Var* lvalue_slot(const LValue* lv);
+ArrayList* lvalue_elem(const LValue* lv, int* idx);
+Var load_lvalue(const LValue* lv);
+void assign_lvalue(const LValue* lv, Var val);
+Var init_var(Node* ctx, VarType type, Node* init_node, Symbol recname);
+Var init_dict(Node* decl);
+Var init_chan(Node* decl);
+Var init_gen(Node* decl);
 
 static StmtHandler handlers[NODE_LASTNODE];
 
@@ -79,33 +117,82 @@ void init_handlers(void)
         handlers[NODE_IFELSE]      = eval_ifelse;
         handlers[NODE_FOR]         = eval_for;
         handlers[NODE_WHILE]       = eval_while;
+        handlers[NODE_PARFOR]      = eval_parfor;
+        handlers[NODE_FORIN]       = eval_forin;
         handlers[NODE_FUNCDEF]     = eval_funcdef;
         handlers[NODE_FUNCCALL]    = eval_funccall_stmt;
         handlers[NODE_IDXASSIGN]   = eval_idxassign_stmt;
         handlers[NODE_ARRAYDECL]   = eval_arraydecl;
+        handlers[NODE_DICTDECL]    = eval_dictdecl;
+        handlers[NODE_CHANDECL]    = eval_chandecl;
+        handlers[NODE_GENDECL]     = eval_gendecl;
+        handlers[NODE_SPAWN]       = eval_spawn_stmt;
+        handlers[NODE_YIELD]       = eval_yield_stmt;
         handlers[NODE_COMPOUND]    = eval_compound_stmt;
         handlers[NODE_INCDEC]      = eval_incdec_stmt;
         handlers[NODE_RECDEF]      = eval_recdef;
         handlers[NODE_FIELDASSIGN] = eval_fieldassign_stmt;
+        handlers[NODE_LEN]         = eval_intrinsic_stmt;
+        handlers[NODE_APPEND]      = eval_intrinsic_stmt;
+        handlers[NODE_ABS]         = eval_intrinsic_stmt;
 }
 
 void eval(Node* node)
 {
         StmtHandler h = handlers[node->type];
+        const Node* outer = alloc_site;
+        double start;
+
         if (!h)
                 die(node, "unhandled stmt type: %d", node->type);
-        h(node);
+        if (allocprof_enabled)
+                alloc_site = node;
+        if (counters_enabled) {
+                start = counters_begin(node);
+                h(node);
+                counters_end(node, start);
+        }
+        else {
+                h(node);
+        }
+        alloc_site = outer;
 }
 
+static CtrlSignal dispatch_ctrl(Node* node);
+
 /* for handling break & continue in loops */
 CtrlSignal eval_with_ctrl(Node* node)
+{
+        CtrlSignal sig;
+        double start;
+
+        if (!counters_enabled)
+                return dispatch_ctrl(node);
+
+        /* other statements are counted by eval() */
+        switch (node->type) {
+        case NODE_BREAK:
+        case NODE_CONTINUE:
+        case NODE_IF:
+        case NODE_IFELSE:
+        case NODE_RETURN:
+                start = counters_begin(node);
+                sig = dispatch_ctrl(node);
+                counters_end(node, start);
+                return sig;
+        default:
+                return dispatch_ctrl(node);
+        }
+}
+
+static CtrlSignal dispatch_ctrl(Node* node)
 {
         unsigned int i;
 
         switch (node->type) {
         case NODE_SEQ:
                 for (i = 0; i < node->n_children; i++) {
-                        CtrlSignal sig = eval_with_ctrl(node->children[i]);
+                        CtrlSignal sig = eval_with_ctrl(CHILD(node, i));
                         if (sig != CTRL_NONE)
                                 return sig;
                 }
@@ -122,7 +209,7 @@ CtrlSignal eval_with_ctrl(Node* node)
                 if (node->n_children == 0)
                         set_void(&g_retval);
                 else
-                        g_retval = eval_expr(node->children[0]);
+                        g_retval = eval_expr(CHILD(node, 0));
                 return CTRL_RETURN;
         default:
                 eval(node);
@@ -132,17 +219,17 @@ CtrlSignal eval_with_ctrl(Node* node)
 
 CtrlSignal eval_if_ctrl(Node* node)
 {
-        if (as_bool(eval_expr(node->children[0])))
-                return eval_block(node->children[1]);
+        if (as_bool(eval_expr(CHILD(node, 0))))
+                return eval_block(CHILD(node, 1));
         return CTRL_NONE;
 }
 
 CtrlSignal eval_ifelse_ctrl(Node* node)
 {
-        if (as_bool(eval_expr(node->children[0])))
-                return eval_block(node->children[1]);
+        if (as_bool(eval_expr(CHILD(node, 0))))
+                return eval_block(CHILD(node, 1));
         else
-                return eval_block(node->children[2]);
+                return eval_block(CHILD(node, 2));
 }
 
 CtrlSignal eval_block(Node* node)
@@ -158,100 +245,171 @@ void eval_seq(Node* node)
 {
         unsigned int i;
         for (i = 0; i < node->n_children; i++) {
-                eval(node->children[i]);
+                eval(CHILD(node, i));
                 gc_collect_step();
+                heap_dump_poll();
                 /*gc_collect_full();*/
         }
 }
 
+/* index of the top-level statement being evaluated, saved by snapshots */
+static unsigned int toplevel = 0;
+
+/* evaluates the program's top-level statements from start on */
+void eval_program(Node* root, unsigned int start)
+{
+        unsigned int i;
+        for (i = start; i < root->n_children; i++) {
+                toplevel = i;
+                eval(CHILD(root, i));
+                gc_collect_fds();
+                gc_collect_step();
+                heap_dump_poll();
+        }
+}
+
+unsigned int current_toplevel(void)
+{
+        return toplevel;
+}
+
+/* function bodies being run, their callers may hold temporaries */
+static unsigned int call_depth = 0;
+
+/* between iterations of a loop, outside any function or generator */
+static void loop_safe_point(void)
+{
+        heap_dump_poll();
+        if (call_depth == 0 && !gen_running())
+                gc_collect_fds();
+}
+
+static void print_quoted(const String* s)
+{
+        out_char('"');
+        out_write(s->data, s->length);
+        out_char('"');
+}
+
 void print_var(Node* node, const Var* v)
 {
         unsigned int i;
         unsigned int n;
         ArrayList* a;
         RecInst* r;
+        Dict* d;
+        const char* sep = "";
 
         switch (v->type) {
         case TYPE_INT:
-                printf("%d", v->data.i);
+                out_long(v->data.i);
                 break;
         case TYPE_CHAR:
-                printf("%c", v->data.c);
+                out_char(v->data.c);
                 break;
         case TYPE_UINT:
-                printf("%u", v->data.ui);
+                out_ulong(v->data.ui);
                 break;
         case TYPE_LONG:
-                printf("%ld", v->data.l);
+                out_long(v->data.l);
                 break;
         case TYPE_FLOAT:
-                printf("%f", v->data.f);
+                out_double(v->data.f);
                 break;
         case TYPE_BOOL:
-                printf(v->data.b ? "true" : "false");
+                out_str(v->data.b ? "true" : "false");
                 break;
         case TYPE_STRING:
-                printf("%s", v->data.s->data);
+                out_write(v->data.s->data, v->data.s->length);
                 break;
         case TYPE_ARRAY:
                 a = v->data.a;
-                printf("[");
+                out_char('[');
                 for (i = 0; i < a->size; i++) {
                         int is_str = (a->items[i].type == TYPE_STRING);
                         if (is_str)
-                                printf("\"");
+                                out_char('"');
                         print_var(node, &a->items[i]);
                         if (is_str)
-                                printf("\"");
+                                out_char('"');
                         if (i + 1 < a->size)
-                                printf(", ");
+                                out_write(", ", 2);
                 }
-                printf("]");
+                out_char(']');
                 break;
         case TYPE_REC:
                 r = v->data.r;
                 n = r->def->n_fields;
 
-                printf("{");
+                out_char('{');
                 for (i = 0; i < n; i++) {
                         int is_str = (r->fields[i].type == TYPE_STRING);
                         if (is_str)
-                                printf("\"");
+                                out_char('"');
                         print_var(node, &r->fields[i]);
                         if (is_str)
-                                printf("\"");
+                                out_char('"');
                         if (i + 1 < n)
-                                printf(", ");
+                                out_write(", ", 2);
                 }
-                printf("}");
+                out_char('}');
+                break;
+        case TYPE_DICT:
+                d = v->data.d;
+                out_char('{');
+                for (i = dict_next(d, 0); i < d->cap; i = dict_next(d, i + 1)) {
+                        Var key = dict_key_at(d, i);
+                        Var val = dict_val_at(d, i);
+                        out_str(sep);
+                        if (key.type == TYPE_STRING)
+                                print_quoted(key.data.s);
+                        else
+                                print_var(node, &key);
+                        out_write(": ", 2);
+                        if (val.type == TYPE_STRING)
+                                print_quoted(val.data.s);
+                        else
+                                print_var(node, &val);
+                        sep = ", ";
+                }
+                out_char('}');
+                break;
+        case TYPE_CHAN:
+                out_str("<chan>");
+                break;
+        case TYPE_GEN:
+                out_str("<gen>");
                 break;
         default:
                 die(node, "unsupported type in print");
         }
 }
 
-void eval_print(Node* node)
+static void print_args(Node* node)
 {
-        Node* args = node->children[0];
+        Node* args = CHILD(node, 0);
         unsigned int i;
         for (i = 0; i < args->n_children; i++) {
-                Var v = eval_expr(args->children[i]);
+                Var v = eval_expr(CHILD(args, i));
                 print_var(node, &v);
 
                 /* spaces between args */
                 if (i < args->n_children - 1)
-                        printf(" ");
+                        out_char(' ');
         }
 }
 
+void eval_print(Node* node)
+{
+        print_args(node);
+        out_end(0);
+}
+
 void eval_println(Node* node)
 {
-        if (node->children[0]->type == NODE_NOP) {
-                printf("\n");
-                return;
-        }
-        eval_print(node);
-        printf("\n");
+        if (CHILD(node, 0)->type != NODE_NOP)
+                print_args(node);
+        out_end(1);
 }
 
 void eval_vardecl(Node* node)
@@ -260,17 +418,17 @@ void eval_vardecl(Node* node)
         Var* get;
         v.type = node->vartype;
 
-        if ((get = env_get_top(node->varname)))
-                die(node, "'%s' has already been declared as type: '%d'", node->varname, get->type);
+        if ((get = env_get_top(node->name)))
+                die(node, "'%s' has already been declared as type: '%d'", sym_name(node->name), get->type);
 
         v = init_var(
                 node,
                 node->vartype,
-                node->n_children > 0 ? node->children[0] : NULL,
-                node->recname
+                node->n_children > 0 ? CHILD(node, 0) : NULL,
+                node->u.recname
         );
 
-        env_set(node->varname, v);
+        env_set(node->name, v);
 }
 
 void eval_assign_stmt(Node* node)
@@ -280,16 +438,20 @@ void eval_assign_stmt(Node* node)
 
 Var eval_assign_expr(Node* node)
 {
-        Var* v = env_get(node->varname);
+        Var* v = env_get(node->name);
         Var result;
         if (!v) {
-                die(node, "assignment to undeclared variable '%s'", node->varname);
+                die(node, "assignment to undeclared variable '%s'", sym_name(node->name));
         }
+        if (parfor_worker)
+                parfor_check_var(node, node->name);
 
-        result = eval_expr(node->children[0]);
+        result = eval_expr(CHILD(node, 0));
+        /* again, a compacting collection inside it can move the buffer an alias points into */
+        v = env_get(node->name);
         result = implicit_convert(result, v->type);
         if (result.type != v->type)
-                die(node, "Type error: cannot assign to variable '%s'", node->varname);
+                die(node, "Type error: cannot assign to variable '%s'", sym_name(node->name));
         v->data = result.data;
         return result;
 }
@@ -297,36 +459,37 @@ Var eval_assign_expr(Node* node)
 
 void eval_if(Node* node)
 {
-        if (as_bool(eval_expr(node->children[0])))
-                eval_block(node->children[1]);
+        if (as_bool(eval_expr(CHILD(node, 0))))
+                eval_block(CHILD(node, 1));
 }
 
 void eval_ifelse(Node* node)
 {
-        if (as_bool(eval_expr(node->children[0])))
-                eval_block(node->children[1]);
+        if (as_bool(eval_expr(CHILD(node, 0))))
+                eval_block(CHILD(node, 1));
         else
-                eval_block(node->children[2]);
+                eval_block(CHILD(node, 2));
 }
 
 void eval_for(Node* node)
 {
         /* for init */
         env_push();
-        eval(node->children[0]);
+        eval(CHILD(node, 0));
 
-        while (as_bool(eval_expr(node->children[1]))) {
+        while (as_bool(eval_expr(CHILD(node, 1)))) {
                 /* for body */
-                CtrlSignal sig = eval_block(node->children[3]);
+                CtrlSignal sig = eval_block(CHILD(node, 3));
+                loop_safe_point();
                 if (sig == CTRL_BREAK)
                         break;
                 if (sig == CTRL_CONTINUE) {
-                        eval(node->children[2]);
+                        eval(CHILD(node, 2));
                         continue;
                 }
 
                 /* for incr */
-                eval(node->children[2]);
+                eval(CHILD(node, 2));
 
         }
         env_pop();
@@ -334,8 +497,9 @@ void eval_for(Node* node)
 
 void eval_while(Node* node)
 {
-        while(as_bool(eval_expr(node->children[0]))) {
-                CtrlSignal sig = eval_block(node->children[1]);
+        while(as_bool(eval_expr(CHILD(node, 0)))) {
+                CtrlSignal sig = eval_block(CHILD(node, 1));
+                loop_safe_point();
                 if (sig == CTRL_BREAK)
                         break;
                 if (sig == CTRL_CONTINUE) {
@@ -344,6 +508,73 @@ void eval_while(Node* node)
         }
 }
 
+/* one iteration of a parfor, in its own scope */
+static void parfor_iteration(Node* node, int i)
+{
+        Var v;
+        CtrlSignal sig;
+
+        env_push();
+        set_int(&v, i);
+        env_set(node->name, v);
+        sig = eval_block(CHILD(node, 2));
+        env_pop();
+        if (sig == CTRL_BREAK || sig == CTRL_RETURN)
+                die(node, "parfor: break and return are not allowed in a parfor body");
+}
+
+void eval_parfor(Node* node)
+{
+        Var start = eval_expr(CHILD(node, 0));
+        Var end = eval_expr(CHILD(node, 1));
+
+        if (start.type != TYPE_INT || end.type != TYPE_INT)
+                die(node, "parfor: bounds must be int");
+        parfor_run(node, start.data.i, end.data.i, parfor_iteration);
+}
+
+/* for (x in seq): x takes each value of a generator or element of an array */
+void eval_forin(Node* node)
+{
+        Var seq = eval_expr(CHILD(node, 0));
+        unsigned int i = 0;
+        Var* x;
+
+        /* a dict is walked through a copy of its keys, the body may change it */
+        if (seq.type == TYPE_DICT)
+                set_array(&seq, dict_keys(seq.data.d));
+        if (seq.type != TYPE_GEN && seq.type != TYPE_ARRAY)
+                die(node, "for in: expected a generator, an array or a dict, got type %d", seq.type);
+
+        env_push();
+        /* the loop scope keeps a temporary generator or array alive */
+        env_set(sym_intern_str("for sequence"), seq);
+        env_set(node->name, seq);
+        x = env_get_top(node->name);
+
+        for (;;) {
+                CtrlSignal sig;
+
+                if (seq.type == TYPE_GEN) {
+                        if (!gen_ready(node, seq.data.g))
+                                break;
+                        *x = gen_take(node, seq.data.g);
+                }
+                else {
+                        /* the length is read again, appends in the body are visited */
+                        if (i >= seq.data.a->size)
+                                break;
+                        *x = seq.data.a->items[i++];
+                }
+
+                sig = eval_block(CHILD(node, 1));
+                loop_safe_point();
+                if (sig == CTRL_BREAK)
+                        break;
+        }
+        env_pop();
+}
+
 void eval_nop(Node* node)
 {
         (void) node;
@@ -353,22 +584,22 @@ void eval_nop(Node* node)
 void eval_funcdef(Node* node)
 {
         /*
-        Node* plist = node->children[0];
+        Node* plist = CHILD(node, 0);
         int   pcount = plist->n_children;
         int i;
 
         printf(
                 "Parsed function `%s` (returns %d) with %d params:\n",
-                node->varname,
+                sym_name(node->name),
                 node->vartype,
                 pcount
         );
 
         for (i = 0; i < pcount; i++) {
-                Node *param = plist->children[i];
-                printf("  - %d %s\n", param->vartype, param->varname);
+                Node *param = CHILD(plist, i);
+                printf("  - %d %s\n", param->vartype, sym_name(param->name));
         }*/
-        func_set(node->varname, node);
+        func_set(node->name, node);
 
         /*printf("Body AST:\n");
         print_ast(body, 0);*/
@@ -379,119 +610,304 @@ void eval_funccall_stmt(Node* node)
         (void)eval_funccall(node);
 }
 
+/* dies unless arg can be passed as parameter i of func */
+static void check_arg(Node* node, Node* func, Node* param, int i, Var arg)
+{
+        if (arg.type != param->vartype) {
+                die(node, "function '%s' argument %d: expected type %d, got %d",
+                        sym_name(func->name),
+                        i + 1,
+                        param->vartype,
+                        arg.type
+                );
+        }
+
+        if (param->vartype == TYPE_REC) {
+                RecInst* ri = arg.data.r;
+
+                if (ri->def->sym != param->u.recname) {
+                        die(node, "function '%s' argument %d: expected record '%s', got '%s'",
+                                sym_name(func->name),
+                                i + 1,
+                                sym_name(param->u.recname),
+                                ri->def->name
+                        );
+                }
+        }
+
+        if (param->vartype == TYPE_DICT
+            && DICT_TYPES(arg.data.d->key_type, arg.data.d->val_type) != param->u.ival) {
+                die(node, "function '%s' argument %d: dict key or value type mismatch",
+                        sym_name(func->name),
+                        i + 1
+                );
+        }
+
+        if (param->vartype == TYPE_CHAN && arg.data.ch->type != (VarType) param->u.ival) {
+                die(node, "function '%s' argument %d: channel element type mismatch",
+                        sym_name(func->name),
+                        i + 1
+                );
+        }
+
+        if (param->vartype == TYPE_GEN && arg.data.g->type != (VarType) param->u.ival) {
+                die(node, "function '%s' argument %d: generator element type mismatch",
+                        sym_name(func->name),
+                        i + 1
+                );
+        }
+}
+
+/* the body of a generator, run on its own stack by gen.c */
+static void gen_body(Node* func)
+{
+        CtrlSignal sig;
+
+        PROF_ENTER(func, 0);
+        sig = eval_with_ctrl(CHILD(func, 1));
+        PROF_LEAVE();
+        if (sig == CTRL_RETURN && g_retval.type != TYPE_VOID)
+                die(func, "generator '%s' cannot return a value", sym_name(func->name));
+}
+
+/* runs the body of func in the scope holding its arguments, pops that scope */
+static Var run_function(Node* node, Node* func)
+{
+        CtrlSignal sig;
+
+        /* the body runs later, as values are taken from the generator */
+        if (func->vartype == TYPE_GEN) {
+                g_retval.type = TYPE_GEN;
+                g_retval.data.g = gen_new(func, gen_body);
+                g_retval.is_const = 0;
+                return g_retval;
+        }
+
+        PROF_ENTER(func, 0);
+        call_depth++;
+        sig = eval_with_ctrl(CHILD(func, 1));
+        call_depth--;
+        PROF_LEAVE();
+        if (sig == CTRL_RETURN) {
+                if (g_retval.type != func->vartype) {
+                        die(node, "function '%s': return type mismatch (expected %d, got %d)",
+                                sym_name(func->name), func->vartype, g_retval.type);
+                }
+                if (func->vartype == TYPE_ARRAY || func->vartype == TYPE_STRING
+                    || func->vartype == TYPE_REC || func->vartype == TYPE_DICT) {
+                        g_retval = var_clone(&g_retval);
+                }
+        }
+        else {
+                if (func->vartype != TYPE_VOID)
+                        die(node, "function '%s': missing return value", sym_name(func->name));
+                set_void(&g_retval);
+        }
+
+        env_pop();
+        return g_retval;
+}
+
 Var eval_funccall(Node* node)
 {
         Node* func;
         Node* param_list;
-        Node* body;
         int expected;
         int given;
         int i;
-        CtrlSignal sig;
         Var result;
 
         if (call_builtin_if_exists(node, &result))
                 return result;
 
-        if (!(func = func_get(node->varname)))
-                die(node, "undefined function '%s'", node->varname);
+        if (!(func = func_get(node->name)))
+                die(node, "undefined function '%s'", sym_name(node->name));
 
-        param_list = func->children[0];
-        body = func->children[1];
+        param_list = CHILD(func, 0);
 
         expected = param_list->n_children;
-        given = node->children[0]->n_children;
+        given = CHILD(node, 0)->n_children;
 
         if (expected != given)
-                die(node, "function '%s' expects %d args, got %d", node->varname, expected, given);
+                die(node, "function '%s' expects %d args, got %d", sym_name(node->name), expected, given);
 
         env_push();
         for (i = 0; i < expected; i++) {
-                Node* param = param_list->children[i];
-                Node* arg_expr = node->children[0]->children[i];
-                Var arg_val = eval_expr(arg_expr);
-
-                if (arg_val.type != param->vartype) {
-                        die(node, "function '%s' argument %d: expected type %d, got %d",
-                                node->varname,
-                                i + 1,
-                                param->vartype,
-                                arg_val.type
-                        );
+                Node* param = CHILD(param_list, i);
+                Node* arg_expr = CHILD(CHILD(node, 0), i);
+                Var* ref = NULL;
+                ArrayList* elem_of = NULL;
+                int elem_idx = 0;
+                Var arg_val;
+
+                /* arrays, records and dicts are passed by reference */
+                if ((param->vartype == TYPE_ARRAY || param->vartype == TYPE_REC || param->vartype == TYPE_DICT)
+                    && is_lvalue(arg_expr)) {
+                        LValue lv;
+                        resolve_lvalue(arg_expr, &lv);
+                        ref = lvalue_slot(&lv);
+                        arg_val = ref ? *ref : load_lvalue(&lv);
+                        if (ref)
+                                elem_of = lvalue_elem(&lv, &elem_idx);
+                }
+                else {
+                        arg_val = eval_expr(arg_expr);
                 }
 
-                if (param->vartype == TYPE_REC) {
-                        RecInst* ri = arg_val.data.r;
+                check_arg(node, func, param, i, arg_val);
 
-                        if (strcmp(ri->def->name, param->recname) != 0) {
-                                die(node, "function '%s' argument %d: expected record '%s', got '%s'",
-                                        node->varname,
-                                        i + 1,
-                                        param->recname,
-                                        ri->def->name
-                                );
-                        }
+                if (elem_of) {
+                        env_set_elem(param->name, elem_of, elem_idx);
                 }
-
-                if (param->vartype == TYPE_ARRAY || param->vartype == TYPE_REC) {
-                        Var* v = lvalue_ptr(arg_expr);
-                        env_set_ptr(param->varname, v);
+                else if (ref) {
+                        env_set_ptr(param->name, ref);
                 }
                 else {
-                        env_set(param->varname, arg_val);
+                        env_set(param->name, arg_val);
                 }
 
         }
 
-        sig = eval_with_ctrl(body);
-        if (sig == CTRL_RETURN) {
-                if (g_retval.type != func->vartype) {
-                        die(node, "function '%s': return type mismatch (expected %d, got %d)",
-                                node->varname, func->vartype, g_retval.type);
-                }
-                if (func->vartype == TYPE_ARRAY || func->vartype == TYPE_STRING || func->vartype == TYPE_REC) {
-                        g_retval = var_clone(&g_retval);
+        return run_function(node, func);
+}
+
+/* calls func with values already evaluated, for builtins that take a function */
+Var call_function(Node* at, Node* func, Var* args, int n)
+{
+        Node* param_list = CHILD(func, 0);
+        int i;
+
+        if (param_list->n_children != (unsigned int) n)
+                die(at, "function '%s' expects %d args, got %d", sym_name(func->name), (int) param_list->n_children, n);
+
+        env_push();
+        for (i = 0; i < n; i++) {
+                check_arg(at, func, CHILD(param_list, i), i, args[i]);
+                env_set(CHILD(param_list, i)->name, args[i]);
+        }
+        return run_function(at, func);
+}
+
+void eval_intrinsic_stmt(Node* node)
+{
+        (void) eval_intrinsic(node);
+}
+
+/* len, append and abs without the generic builtin call, see node_call() */
+Var eval_intrinsic(Node* node)
+{
+        Node* args = CHILD(node, 0);
+        Var argv[2];
+        Var result;
+
+        /* a user function of the same name hides it, checked once like resolve() */
+        if (node->u.ival == 0) {
+                if (func_get(node->name)) {
+                        node->type = NODE_FUNCCALL;
+                        return eval_funccall(node);
                 }
+                node->u.ival = 1;
         }
-        else {
-                if (func->vartype != TYPE_VOID)
-                        die(node, "function '%s': missing return value", node->varname);
-                set_void(&g_retval);
+
+        argv[0] = eval_expr(CHILD(args, 0));
+        if (node->type == NODE_APPEND)
+                argv[1] = eval_expr(CHILD(args, 1));
+
+        /* profiled like the builtins they stand for */
+        PROF_ENTER(node, 1);
+        switch (node->type) {
+        case NODE_LEN:
+                if (argv[0].type == TYPE_ARRAY)
+                        set_int(&result, argv[0].data.a->size);
+                else
+                        result = puer_len(node, argv);
+                break;
+        case NODE_ABS:
+                if (argv[0].type != TYPE_INT)
+                        die(node, "function 'abs' arg 1: expected type %d, got %d", TYPE_INT, argv[0].type);
+                result = puer_abs(node, argv);
+                break;
+        default:
+                result = puer_append(node, argv);
+                break;
         }
+        PROF_LEAVE();
+        return result;
+}
 
-        env_pop();
-        return g_retval;
+int is_lvalue(const Node* n)
+{
+        return n->type == NODE_VAR || n->type == NODE_IDX || n->type == NODE_FIELDACCESS;
+}
+
+void resolve_lvalue(Node* L, LValue* out)
+{
+        out->node = L;
+        out->idx = 0;
+
+        switch (L->type) {
+        case NODE_VAR:
+                set_void(&out->container);
+                return;
+        case NODE_IDX:
+                out->container = eval_expr(CHILD(L, 0));
+                if (out->container.type == TYPE_DICT) {
+                        out->key = eval_expr(CHILD(L, 1));
+                        return;
+                }
+                out->idx = var_to_idx(L, eval_expr(CHILD(L, 1)));
+                if (out->container.type == TYPE_STRING)
+                        check_str_bounds(out->container.data.s, out->idx);
+                else if (out->container.type == TYPE_ARRAY)
+                        check_arr_bounds(out->container.data.a, out->idx);
+                else
+                        die(L, "cannot index into type %d", out->container.type);
+                return;
+        case NODE_FIELDACCESS:
+                out->container = eval_expr(CHILD(L, 0));
+                if (out->container.type != TYPE_REC)
+                        die(L, "cannot access field on non-record");
+                out->idx = (int) rec_field_index(out->container.data.r->def, L->name);
+                return;
+        default:
+                die(L, "Left hand side is not assignable");
+        }
 }
 
-Var* lvalue_ptr(Node* L)
+/* NULL for a character of a string or a dict value, those have no Var */
+Var* lvalue_slot(const LValue* lv)
 {
         Var* v;
-        RecInst* ri;
-        Var container;
-        int idx;
 
-        switch(L->type) {
+        switch (lv->node->type) {
         case NODE_VAR:
-                v = env_get(L->varname);
+                v = env_get(lv->node->name);
                 if (!v)
-                        die(L, "undefined variable '%s'", L->varname);
+                        die(lv->node, "undefined variable '%s'", sym_name(lv->node->name));
                 return v;
         case NODE_IDX:
-                container = eval_expr(L->children[0]);
-                idx = var_to_idx(L, eval_expr(L->children[1]));
-                if (container.type != TYPE_ARRAY)
-                        die(L, "cannot index into type %d", container.type);
-                return &container.data.a->items[idx];
-        case NODE_FIELDACCESS:
-                container = eval_expr(L->children[0]);
-                if (container.type != TYPE_REC)
-                        die(L, "cannot access field on non-record");
-                ri = container.data.r;
-                return rec_get_field(ri, L->varname);
+                if (lv->container.type == TYPE_STRING || lv->container.type == TYPE_DICT)
+                        return NULL;
+                return &lv->container.data.a->items[lv->idx];
         default:
-                die(L, "not an l-value");
+                return &lv->container.data.r->fields[lv->idx];
+        }
+}
+
+/* the array lvalue_slot() points into, if any, so a reference can hold it by index */
+ArrayList* lvalue_elem(const LValue* lv, int* idx)
+{
+        VarEntry* e;
+
+        if (lv->node->type == NODE_IDX && lv->container.type == TYPE_ARRAY) {
+                *idx = lv->idx;
+                return lv->container.data.a;
         }
-        return NULL; /* unreachable */
+        if (lv->node->type == NODE_VAR && (e = env_get_entry(lv->node->name)) && e->elem_of) {
+                *idx = e->elem_idx;
+                return e->elem_of;
+        }
+        return NULL;
 }
 
 void eval_idxassign_stmt(Node* node)
@@ -501,18 +917,26 @@ void eval_idxassign_stmt(Node* node)
 
 Var eval_idxassign_expr(Node* node)
 {
-        Var container = eval_expr(node->children[0]);
-        Var v = eval_expr(node->children[1]);
-        int idx = var_to_idx(node, v);
-        Var val = eval_expr(node->children[2]);
+        Var container = eval_expr(CHILD(node, 0));
+        Var v = eval_expr(CHILD(node, 1));
+        Var val;
+        int idx;
+
+        if (container.type == TYPE_DICT) {
+                val = eval_expr(CHILD(node, 2));
+                dict_set(node, container.data.d, v, val);
+                return val;
+        }
 
+        idx = var_to_idx(node, v);
+        val = eval_expr(CHILD(node, 2));
         return index_store(node, container, idx, val);
 }
 
 void eval_arraydecl(Node* node)
 {
-        Node* dims_node = node->children[0];
-        Node* init_node = node->children[1];
+        Node* dims_node = CHILD(node, 0);
+        Node* init_node = CHILD(node, 1);
         int ndims = dims_node->n_children;
         Var value;
 
@@ -521,7 +945,7 @@ void eval_arraydecl(Node* node)
                 if (init_node->type != NODE_NOP) {
                         value = eval_expr(init_node);
                         if (value.type != TYPE_ARRAY)
-                                die(node, "initializer for '%s' must be an array", node->varname);
+                                die(node, "initializer for '%s' must be an array", sym_name(node->name));
                 }
                 else {
                         ArrayList* a = arraylist_new(node->vartype, 0);
@@ -533,7 +957,7 @@ void eval_arraydecl(Node* node)
                 int* sizes = malloc(sizeof(int) * ndims);
                 int i;
                 for (i = 0; i < ndims; i++) {
-                        Node* dim_expr = dims_node->children[i];
+                        Node* dim_expr = CHILD(dims_node, i);
                         if (dim_expr->type == NODE_NOP) {
                                 sizes[i] = 0;
                         }
@@ -544,10 +968,110 @@ void eval_arraydecl(Node* node)
                                 sizes[i] = v.data.i;
                         }
                 }
-                value = build_zero_array(node->vartype, node->recname, sizes, ndims);
+                value = build_zero_array(node->vartype, node->u.recname, sizes, ndims);
                 free(sizes);
         }
-        env_set(node->varname, value);
+        env_set(node->name, value);
+}
+
+void eval_dictdecl(Node* node)
+{
+        Var* get;
+
+        if ((get = env_get_top(node->name)))
+                die(node, "'%s' has already been declared as type: '%d'", sym_name(node->name), get->type);
+
+        env_set(node->name, init_dict(node));
+}
+
+/* an empty dict, or the initializer when its key and value types match */
+Var init_dict(Node* decl)
+{
+        Node* init_node = decl->n_children > 0 ? CHILD(decl, 0) : NULL;
+        Var v;
+
+        if (!init_node || init_node->type == NODE_NOP) {
+                v.type = TYPE_DICT;
+                v.data.d = dict_new(DICT_KEY(decl->u.ival), DICT_VAL(decl->u.ival));
+                v.is_const = 0;
+                return v;
+        }
+
+        v = eval_expr(init_node);
+        if (v.type != TYPE_DICT
+            || DICT_TYPES(v.data.d->key_type, v.data.d->val_type) != decl->u.ival) {
+                die(decl, "init expr type mismatch for '%s': expected dict[%d,%d]",
+                        sym_name(decl->name), DICT_KEY(decl->u.ival), DICT_VAL(decl->u.ival));
+        }
+        return v;
+}
+
+void eval_chandecl(Node* node)
+{
+        Var* get;
+
+        if ((get = env_get_top(node->name)))
+                die(node, "'%s' has already been declared as type: '%d'", sym_name(node->name), get->type);
+
+        env_set(node->name, init_chan(node));
+}
+
+/* a new channel, or the initializer when it carries the same type */
+Var init_chan(Node* decl)
+{
+        Node* init_node = decl->n_children > 0 ? CHILD(decl, 0) : NULL;
+        Var v;
+
+        if (!init_node || init_node->type == NODE_NOP) {
+                v.type = TYPE_CHAN;
+                v.data.ch = chan_new(decl, (VarType) decl->u.ival);
+                v.is_const = 0;
+                return v;
+        }
+
+        v = eval_expr(init_node);
+        if (v.type != TYPE_CHAN || v.data.ch->type != (VarType) decl->u.ival) {
+                die(decl, "init expr type mismatch for '%s': expected chan[%d]",
+                        sym_name(decl->name), decl->u.ival);
+        }
+        return v;
+}
+
+void eval_spawn_stmt(Node* node)
+{
+        (void) task_spawn(CHILD(node, 0));
+}
+
+void eval_gendecl(Node* node)
+{
+        Var* get;
+
+        if ((get = env_get_top(node->name)))
+                die(node, "'%s' has already been declared as type: '%d'", sym_name(node->name), get->type);
+
+        env_set(node->name, init_gen(node));
+}
+
+/* generators only come from calls, the initializer is required */
+Var init_gen(Node* decl)
+{
+        Node* init_node = decl->n_children > 0 ? CHILD(decl, 0) : NULL;
+        Var v;
+
+        if (!init_node || init_node->type == NODE_NOP)
+                die(decl, "generator '%s' must be initialized", sym_name(decl->name));
+
+        v = eval_expr(init_node);
+        if (v.type != TYPE_GEN || v.data.g->type != (VarType) decl->u.ival) {
+                die(decl, "init expr type mismatch for '%s': expected a generator of %d",
+                        sym_name(decl->name), decl->u.ival);
+        }
+        return v;
+}
+
+void eval_yield_stmt(Node* node)
+{
+        gen_yield(node, eval_expr(CHILD(node, 0)));
 }
 
 Var eval_arraylit(Node* node)
@@ -559,13 +1083,13 @@ Var eval_arraylit(Node* node)
         Var out;
 
         if (n > 0) {
-                Var first = eval_expr(node->children[0]);
+                Var first = eval_expr(CHILD(node, 0));
                 type = first.type;
         }
 
         arr = arraylist_new(type, n);
         for (i = 0; i < n; i++) {
-                Var v = eval_expr(node->children[i]);
+                Var v = eval_expr(CHILD(node, i));
                 if (v.type != type) {
                         die(
                                 node,
@@ -633,12 +1157,16 @@ Var index_store(Node* node, Var container, int idx, Var val)
         case TYPE_STRING:
                 if (val.type != TYPE_INT && val.type != TYPE_CHAR)
                         die(node, "can only assign char to string character");
+                if (parfor_worker)
+                        parfor_check_owned(node, container.data.s, "change a string");
                 string_set(container.data.s, idx, as_int(val));
                 return val;
         case TYPE_ARRAY:
                 a = container.data.a;
                 if (val.type != a->type)
                         die(node, "type mismatch: array holds %d but got %d", a->type, val.type);
+                if (parfor_worker)
+                        parfor_store(node, a, 0, (unsigned int) idx, val);
                 a->items[idx] = val;
                 return val;
         default:
@@ -674,8 +1202,8 @@ Var eval_binop(Node* node)
         Var b;
         BinOp op = node->op;
 
-        a = eval_expr(node->children[0]);
-        b = eval_expr(node->children[1]);
+        a = eval_expr(CHILD(node, 0));
+        b = eval_expr(CHILD(node, 1));
 
         return do_binop(node, op, a, b);
 }
@@ -687,101 +1215,71 @@ void eval_compound_stmt(Node* node)
 
 Var eval_compound_expr(Node* node)
 {
-        Node* L = node->children[0];
-        Var old = load_lvalue(L);
-        Var rhs = eval_expr(node->children[1]);
-        Var result = do_binop(node, node->op, old, rhs);
+        LValue lv;
+        Var old;
+        Var rhs;
+        Var result;
 
-        if (L->type == NODE_VAR) {
-                Var* v = env_get(L->varname);
-                result = implicit_convert(result, v->type);
-        }
-        else {
-                Var container = eval_expr(L->children[0]);
-                int is_str = (container.type == TYPE_STRING);
-                VarType type = (is_str) ? TYPE_INT : container.data.a->type;
-                result = implicit_convert(result, type);
-        }
+        resolve_lvalue(CHILD(node, 0), &lv);
+        old = load_lvalue(&lv);
+        rhs = eval_expr(CHILD(node, 1));
+        result = do_binop(node, node->op, old, rhs);
+        /* a slot keeps its type, string characters are stored from ints */
+        result = implicit_convert(result, lv.container.type == TYPE_STRING ? TYPE_INT : old.type);
 
-        assign_lvalue(L, result);
+        assign_lvalue(&lv, result);
         return result;
 }
 
 Var eval_idx(Node* node)
 {
-        Var container = eval_expr(node->children[0]);
-        Var v = eval_expr(node->children[1]);
-        int idx = var_to_idx(node, v);
-        return index_load(node, container, idx);
+        Var container = eval_expr(CHILD(node, 0));
+        Var v = eval_expr(CHILD(node, 1));
+
+        if (container.type == TYPE_DICT)
+                return dict_get(node, container.data.d, v);
+        return index_load(node, container, var_to_idx(node, v));
 }
 
-Var load_lvalue(Node* L)
+Var load_lvalue(const LValue* lv)
 {
-        Var* v;
-        Var container;
-        Var idxv;
-        int idx;
-        RecInst* ri;
-        Var dummy = { 0 };
-
-        switch (L->type) {
-        case NODE_VAR:
-                v = env_get(L->varname);
-                if (!v)
-                        die(L, "undefined variable '%s'", L->varname);
+        Var* v = lvalue_slot(lv);
+        if (v)
                 return *v;
-        case NODE_IDX:
-                container = eval_expr(L->children[0]);
-                idxv = eval_expr(L->children[1]);
-                idx = var_to_idx(L, idxv);
-                return index_load(L, container, idx);
-        case NODE_FIELDACCESS:
-                container = eval_expr(L->children[0]);
-                if (container.type != TYPE_REC)
-                        die(L, "cannot access field on non-record");
-                ri = container.data.r;
-                return *rec_get_field(ri, L->varname);
-        default:
-                die(L, "Left hand side is not assignable");
-        }
-
-        return dummy; /* unreachable */
+        if (lv->container.type == TYPE_DICT)
+                return dict_get(lv->node, lv->container.data.d, lv->key);
+        return index_load(lv->node, lv->container, lv->idx);
 }
 
-void assign_lvalue(Node* L, Var val)
+void assign_lvalue(const LValue* lv, Var val)
 {
         Var* v;
-        Var container;
-        Var idxv;
-        int idx;
-        RecInst* ri;
 
-        switch (L->type) {
+        switch (lv->node->type) {
         case NODE_VAR:
-                v = env_get(L->varname);
-                if (!v)
-                        die(L, "undefined variable '%s'", L->varname);
-                *v = val;
+                if (parfor_worker)
+                        parfor_check_var(lv->node, lv->node->name);
+                *lvalue_slot(lv) = val;
                 return;
         case NODE_IDX:
-                container = eval_expr(L->children[0]);
-                idxv = eval_expr(L->children[1]);
-                idx = var_to_idx(L, idxv);
-                index_store(L, container, idx, val);
-                return;
-        case NODE_FIELDACCESS:
-                container = eval_expr(L->children[0]);
-                if (container.type != TYPE_REC)
-                        die(L, "cannot access field on non-record");
-                ri = container.data.r;
-                rec_set_field(ri, L->varname, val);
+                if (lv->container.type == TYPE_DICT)
+                        dict_set(lv->node, lv->container.data.d, lv->key, val);
+                else
+                        index_store(lv->node, lv->container, lv->idx, val);
                 return;
         default:
-                die(L, "Left hand side is not assignable");
+                v = lvalue_slot(lv);
+                if (v->type != val.type) {
+                        die(lv->node, "type error: Can't assign record field: %s to type %d (field is of type %d)",
+                                sym_name(lv->node->name), val.type, v->type);
+                }
+                if (parfor_worker)
+                        parfor_store(lv->node, lv->container.data.r, 1, (unsigned int) lv->idx, val);
+                *v = val;
         }
 }
 
-Var init_var(Node* ctx, VarType type, Node* init_node, const char* recname)
+Var init_var(Node* ctx, VarType type, Node* init_node, Symbol recname)
 {
         Var v;
         v.type = type;
@@ -793,7 +1291,7 @@ Var init_var(Node* ctx, VarType type, Node* init_node, const char* recname)
                         die(
                                 ctx,
                                 "init expr type mismatch for '%s': expected %d got %d",
-                                ctx->varname, type, r.type
+                                sym_name(ctx->name), type, r.type
                         );
                 }
                 return r;
@@ -818,15 +1316,17 @@ Var init_var(Node* ctx, VarType type, Node* init_node, const char* recname)
 
 Var eval_incdec_expr(Node* node)
 {
-        Node* L = node->children[0];
-        int is_prefix = node->ival;
-        Var old = load_lvalue(L);
+        int is_prefix = node->u.ival;
+        LValue lv;
+        Var old;
         Var one;
         Var next;
 
+        resolve_lvalue(CHILD(node, 0), &lv);
+        old = load_lvalue(&lv);
         set_int(&one, 1);
         next = do_binop(node, node->op, old, one);
-        assign_lvalue(L, next);
+        assign_lvalue(&lv, next);
 
         return (is_prefix) ? next : old;
 }
@@ -840,61 +1340,68 @@ void eval_recdef(Node* node)
 {
         unsigned int n = 0;
         unsigned int i;
-        const char** names;
+        Symbol* names;
         Var* defs;
         RecDef* rd;
         Node* seq;
 
         if (node->n_children > 0) {
-                seq = node->children[0];
+                seq = CHILD(node, 0);
                 n = seq->n_children;
         }
 
         if (n == 0)
                 die(node, "record definition must have at least 1 field");
 
-        names = malloc(sizeof(char*) * n);
+        names = malloc(sizeof(Symbol) * n);
         defs = malloc(sizeof(Var) * n);
 
         for (i = 0; i < n; i++) {
                 Var v;
-                Node* f = seq->children[i];
-                names[i] = strdup(f->varname);
+                Node* f = CHILD(seq, i);
+                names[i] = f->name;
+
+                if (f->type == NODE_DICTDECL) {
+                        defs[i] = init_dict(f);
+                        continue;
+                }
+                if (f->type == NODE_CHANDECL)
+                        die(f, "channels cannot be record fields");
+                if (f->type == NODE_GENDECL)
+                        die(f, "generators cannot be record fields");
 
                 v = init_var(
                         node,
                         f->vartype,
-                        (f->n_children==1 && f->children[0]->type!=NODE_NOP) ? f->children[0] : NULL,
-                        f->recname
+                        (f->n_children==1 && CHILD(f, 0)->type!=NODE_NOP) ? CHILD(f, 0) : NULL,
+                        f->u.recname
                 );
 
                 defs[i] = v;
         }
 
-        rd = recdef_new(node->varname, names, defs, n);
+        rd = recdef_new(node->name, names, defs, n);
         recdef_register(rd);
-        for (i = 0; i < n; i++)
-                free((char*)names[i]);
         free(names);
         free(defs);
 }
 
 Var eval_fieldaccess(Node* node)
 {
-        Var container = eval_expr(node->children[0]);
+        Var container = eval_expr(CHILD(node, 0));
         RecInst* ri;
 
         if (container.type != TYPE_REC)
                 die(node, "cannot access field on non-record, value");
 
         ri = container.data.r;
-        return *rec_get_field(ri, node->varname);
+        return *rec_get_field(ri, node->name);
 }
 
 Var eval_fieldassign_expr(Node* node)
 {
-        Var container = eval_expr(node->children[0]);
-        Var v = eval_expr(node->children[1]);
+        Var container = eval_expr(CHILD(node, 0));
+        Var v = eval_expr(CHILD(node, 1));
         RecInst* ri;
 
         if (container.type != TYPE_REC)
@@ -902,7 +1409,9 @@ Var eval_fieldassign_expr(Node* node)
 
         ri = container.data.r;
 
-        rec_set_field(ri, node->varname, v);
+        rec_set_field(ri, node->name, v);
+        if (parfor_worker)
+                parfor_store(node, ri, 1, rec_field_index(ri->def, node->name), v);
         return v;
 }
 
@@ -911,7 +1420,27 @@ void eval_fieldassign_stmt(Node* node)
         (void) eval_fieldassign_expr(node);
 }
 
+static Var dispatch_expr(Node* node);
+
 Var eval_expr(Node* node)
+{
+        const Node* outer;
+        Var v;
+
+        if (counters_enabled)
+                counters_expr(node);
+        if (!allocprof_enabled)
+                return dispatch_expr(node);
+
+        /* allocations are charged to the innermost node */
+        outer = alloc_site;
+        alloc_site = node;
+        v = dispatch_expr(node);
+        alloc_site = outer;
+        return v;
+}
+
+static Var dispatch_expr(Node* node)
 {
         Var v;
         Var* found;
@@ -922,31 +1451,38 @@ Var eval_expr(Node* node)
                 set_int(&v, 1);
                 return v;
         case NODE_VAR:
-                found = env_get(node->varname);
+                found = env_get(node->name);
                 if (!found)
-                        die(node, "undefined variable '%s'", node->varname);
+                        die(node, "undefined variable '%s'", sym_name(node->name));
                 return *found;
         case NODE_FIELDACCESS:
                 return eval_fieldaccess(node);
         case NODE_NUM:
-                set_int(&v, node->ival);
+                set_int(&v, node->u.ival);
                 return v;
         case NODE_FLOAT:
-                set_float(&v, node->fval);
+                set_float(&v, node->u.fval);
                 return v;
         case NODE_STRING:
-                set_string(&v, node->varname);
+                set_string(&v, sym_name(node->name));
                 return v;
         case NODE_ARRAYLIT:
                 return eval_arraylit(node);
         case NODE_CHAR:
-                set_char(&v, node->ival);
+                set_char(&v, node->u.ival);
                 return v;
         case NODE_BOOL:
-                set_bool(&v, node->ival);
+                set_bool(&v, node->u.ival);
                 return v;
         case NODE_FUNCCALL:
                 return eval_funccall(node);
+        case NODE_SPAWN:
+                set_int(&v, task_spawn(CHILD(node, 0)));
+                return v;
+        case NODE_LEN:
+        case NODE_APPEND:
+        case NODE_ABS:
+                return eval_intrinsic(node);
         case NODE_ASSIGN:
                 return eval_assign_expr(node);
         case NODE_IDXASSIGN:
@@ -954,7 +1490,7 @@ Var eval_expr(Node* node)
         case NODE_FIELDASSIGN:
                 return eval_fieldassign_expr(node);
         case NODE_NOT: {
-                Var inner = eval_expr(node->children[0]);
+                Var inner = eval_expr(CHILD(node, 0));
                 if (inner.type != TYPE_BOOL && inner.type != TYPE_INT) {
                         die(node, "`!` operator requires boolean or integer type");
                 }
@@ -962,24 +1498,24 @@ Var eval_expr(Node* node)
                 return v;
         }
         case NODE_AND: {
-                Var left = eval_expr(node->children[0]);
+                Var left = eval_expr(CHILD(node, 0));
                 Var right;
                 if (!as_bool(left)) {
                         set_bool(&left, 0);
                         return left;
                 }
-                right = eval_expr(node->children[1]);
+                right = eval_expr(CHILD(node, 1));
                 set_bool(&right, as_bool(right));
                 return right;
         }
         case NODE_OR: {
-                Var left = eval_expr(node->children[0]);
+                Var left = eval_expr(CHILD(node, 0));
                 Var right;
                 if (as_bool(left)) {
                         set_bool(&left, 1);
                         return left;
                 }
-                right = eval_expr(node->children[1]);
+                right = eval_expr(CHILD(node, 1));
                 set_bool(&right, as_bool(right));
                 return right;
         }
@@ -992,7 +1528,7 @@ Var eval_expr(Node* node)
         case NODE_INCDEC:
                 return eval_incdec_expr(node);
         default:
-                die(node, "unhandled expression type: %s", node->type);
+                die(node, "unhandled expression type: %d", node->type);
         }
         return v;
 }
@@ -0,0 +1,462 @@
+/* MAP_ANONYMOUS */
+#define _DEFAULT_SOURCE
+
+#include "file.h"
+#include "env.h"
+#include "gc_tri.h"
+#include "scan.h"
+#include "util.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+typedef struct File {
+        int fd;
+        int writing;
+        int eof;                /* a read found nothing left */
+        char* buf;              /* FILE_BUF_SIZE bytes */
+        size_t pos;             /* next unread byte */
+        size_t len;             /* bytes in buf, unread or not yet written */
+        char* spill;            /* a line that runs past the end of buf */
+        size_t spill_cap;
+} File;
+
+/* state of a lines() generator */
+typedef struct LineReader {
+        File* f;
+        String* line;           /* kept alive by the generator's scope */
+        size_t cap;             /* room in line->data */
+} LineReader;
+
+/* indexed by fd */
+static File** files = NULL;
+static int cap_files = 0;
+
+static File* file_new(Node* at, int fd, int writing)
+{
+        File* f = malloc(sizeof(File));
+
+        if (!f || !(f->buf = malloc(FILE_BUF_SIZE)))
+                die(at, "Out of Memory Error");
+        f->fd = fd;
+        f->writing = writing;
+        f->eof = 0;
+        f->pos = 0;
+        f->len = 0;
+        f->spill = NULL;
+        f->spill_cap = 0;
+        return f;
+}
+
+static void file_free(File* f)
+{
+        free(f->buf);
+        free(f->spill);
+        free(f);
+}
+
+static File* get(Node* at, const char* what, int h)
+{
+        if (h < 0 || h >= cap_files || !files[h])
+                die(at, "%s: %d is not an open file", what, h);
+        return files[h];
+}
+
+static int write_all(int fd, const char* p, size_t n)
+{
+        while (n > 0) {
+                ssize_t got = write(fd, p, n);
+                if (got < 0 && errno == EINTR)
+                        continue;
+                if (got < 0)
+                        return -1;
+                p += got;
+                n -= (size_t) got;
+        }
+        return 0;
+}
+
+static int write_out(File* f)
+{
+        size_t n = f->len;
+
+        f->len = 0;
+        return write_all(f->fd, f->buf, n);
+}
+
+static void flush_file(Node* at, File* f)
+{
+        if (write_out(f) < 0)
+                die(at, "write: %s", strerror(errno));
+}
+
+/* before a fork and at exit, so no file's buffer is written twice or lost */
+void file_flush_all(void)
+{
+        int h;
+
+        for (h = 0; h < cap_files; h++) {
+                if (files[h] && files[h]->writing)
+                        write_out(files[h]);
+        }
+}
+
+static size_t fill(Node* at, File* f)
+{
+        ssize_t n;
+
+        do {
+                n = read(f->fd, f->buf, FILE_BUF_SIZE);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0)
+                die(at, "read: %s", strerror(errno));
+        f->pos = 0;
+        f->len = (size_t) n;
+        return f->len;
+}
+
+/*
+ * the next line without its newline. points into the buffer unless the
+ * line crosses a refill, then into spill. zero at end of file.
+ */
+static int next_line(Node* at, File* f, const char** out, size_t* out_len)
+{
+        size_t have = 0;
+
+        for (;;) {
+                char* start = f->buf + f->pos;
+                size_t avail = f->len - f->pos;
+                char* nl = avail ? memchr(start, '\n', avail) : NULL;
+                size_t take = nl ? (size_t) (nl - start) : avail;
+
+                if (nl && have == 0) {
+                        *out = start;
+                        *out_len = take;
+                        f->pos += take + 1;
+                        return 1;
+                }
+
+                if (take > 0) {
+                        if (have + take > f->spill_cap) {
+                                f->spill_cap = have + take > 2 * f->spill_cap ? have + take : 2 * f->spill_cap;
+                                f->spill = realloc(f->spill, f->spill_cap);
+                                if (!f->spill)
+                                        die(at, "Out of Memory Error");
+                        }
+                        memcpy(f->spill + have, start, take);
+                        have += take;
+                        f->pos += take;
+                }
+
+                if (nl || fill(at, f) == 0) {
+                        if (nl)
+                                f->pos++;
+                        else if (have == 0)
+                                return 0;
+                        *out = f->spill;
+                        *out_len = have;
+                        return 1;
+                }
+        }
+}
+
+static int open_file(const char* path, int flags)
+{
+        return open(path, flags | O_CLOEXEC, 0644);
+}
+
+int file_open(Node* at, const char* path, const char* mode)
+{
+        static int registered = 0;
+        int flags = O_RDONLY;
+        int fd;
+
+        if (strcmp(mode, "w") == 0)
+                flags = O_WRONLY | O_CREAT | O_TRUNC;
+        else if (strcmp(mode, "a") == 0)
+                flags = O_WRONLY | O_CREAT | O_APPEND;
+        else if (strcmp(mode, "r") != 0)
+                die(at, "open: mode must be \"r\", \"w\" or \"a\", got \"%s\"", mode);
+
+        fd = open_file(path, flags);
+        if (fd < 0)
+                die(at, "open: %s: %s", path, strerror(errno));
+
+        if (fd >= cap_files) {
+                int cap = cap_files ? cap_files : 16;
+                int i;
+
+                while (cap <= fd)
+                        cap *= 2;
+                files = realloc(files, sizeof(File*) * (size_t) cap);
+                if (!files)
+                        die(at, "Out of Memory Error");
+                for (i = cap_files; i < cap; i++)
+                        files[i] = NULL;
+                cap_files = cap;
+        }
+        files[fd] = file_new(at, fd, flags != O_RDONLY);
+
+        if (!registered) {
+                atexit(file_flush_all);
+                registered = 1;
+        }
+        return fd;
+}
+
+void file_close(Node* at, int h)
+{
+        File* f = get(at, "close", h);
+
+        if (f->writing)
+                flush_file(at, f);
+        files[h] = NULL;
+        close(f->fd);
+        file_free(f);
+}
+
+int file_eof(Node* at, int h)
+{
+        return get(at, "eof", h)->eof;
+}
+
+static File* get_reading(Node* at, const char* what, int h)
+{
+        File* f = get(at, what, h);
+
+        if (f->writing)
+                die(at, "%s: file %d is open for writing", what, h);
+        return f;
+}
+
+/* "" at end of file, and eof() turns true */
+String* file_read_line(Node* at, int h)
+{
+        File* f = get_reading(at, "read_line", h);
+        const char* line;
+        size_t n;
+
+        if (!next_line(at, f, &line, &n)) {
+                f->eof = 1;
+                return string_new("");
+        }
+        if (n >= UINT_MAX)
+                die(at, "read_line: line too long for a str");
+        return string_new_len(line, (unsigned int) n);
+}
+
+/* the rest of the file */
+String* file_read_all(Node* at, int h)
+{
+        File* f = get_reading(at, "read_all", h);
+        size_t n = f->len - f->pos;
+        size_t cap = n + 1;
+        struct stat st;
+        char* data;
+        String* s;
+
+        /* sized from the file, a spare byte lets the read that finds the end fit */
+        if (fstat(f->fd, &st) == 0 && S_ISREG(st.st_mode)) {
+                off_t at_off = lseek(f->fd, 0, SEEK_CUR);
+                if (at_off >= 0 && st.st_size > at_off) {
+                        if ((unsigned long) (st.st_size - at_off) >= UINT_MAX - n)
+                                die(at, "read_all: file too large for a str");
+                        cap += (size_t) (st.st_size - at_off) + 1;
+                }
+        }
+
+        data = gc_alloc(cap, scan_raw);
+        memcpy(data, f->buf + f->pos, n);
+        f->pos = 0;
+        f->len = 0;
+
+        for (;;) {
+                ssize_t got;
+
+                if (n + 1 == cap) {
+                        if (cap >= UINT_MAX / 2)
+                                die(at, "read_all: file too large for a str");
+                        cap *= 2;
+                        data = gc_realloc(data, cap, scan_raw);
+                }
+                got = read(f->fd, data + n, cap - 1 - n);
+                if (got < 0 && errno == EINTR)
+                        continue;
+                if (got < 0)
+                        die(at, "read_all: %s", strerror(errno));
+                if (got == 0)
+                        break;
+                n += (size_t) got;
+        }
+        data[n] = '\0';
+        f->eof = 1;
+
+        s = gc_alloc(sizeof(String), scan_string);
+        s->data = data;
+        s->length = (unsigned int) n;
+        return s;
+}
+
+void file_write(Node* at, int h, const String* s, int newline)
+{
+        File* f = get(at, "write", h);
+
+        if (!f->writing)
+                die(at, "write: file %d is open for reading", h);
+
+        if (s->length > FILE_BUF_SIZE - f->len)
+                flush_file(at, f);
+        /* too big to be worth copying into the buffer */
+        if (s->length >= FILE_BUF_SIZE) {
+                if (write_all(f->fd, s->data, s->length) < 0)
+                        die(at, "write: %s", strerror(errno));
+        }
+        else {
+                memcpy(f->buf + f->len, s->data, s->length);
+                f->len += s->length;
+        }
+
+        if (newline) {
+                if (f->len == FILE_BUF_SIZE)
+                        flush_file(at, f);
+                f->buf[f->len++] = '\n';
+        }
+}
+
+static void release_reader(void* data)
+{
+        LineReader* r = data;
+
+        close(r->f->fd);
+        gc_hold_fds(-1);
+        file_free(r->f);
+        free(r);
+}
+
+/* stands in for a function declared -> str* */
+static Node lines_func;
+
+static void lines_body(Node* func)
+{
+        Gen* g = gen_running();
+        LineReader* r = g->data;
+        const char* p;
+        size_t n;
+        Var v;
+
+        (void) func;
+        v.type = TYPE_STRING;
+        v.data.s = r->line;
+        v.is_const = 0;
+
+        while (next_line(NULL, r->f, &p, &n)) {
+                if (n >= UINT_MAX)
+                        die(NULL, "lines: line too long for a str");
+                if (n + 1 > r->cap) {
+                        r->cap = n + 1 > 2 * r->cap ? n + 1 : 2 * r->cap;
+                        r->line->data = gc_realloc(r->line->data, r->cap, scan_raw);
+                }
+                memcpy(r->line->data, p, n);
+                r->line->data[n] = '\0';
+                r->line->length = (unsigned int) n;
+                gen_yield_shared(NULL, v);
+        }
+
+        g->data = NULL;
+        g->release = NULL;
+        release_reader(r);
+}
+
+Gen* file_lines(Node* at, const char* path)
+{
+        int fd = open_file(path, O_RDONLY);
+        LineReader* r;
+        Var v;
+        Gen* g;
+
+        if (fd < 0)
+                die(at, "lines: %s: %s", path, strerror(errno));
+        if (!lines_func.name) {
+                lines_func.vartype = TYPE_GEN;
+                lines_func.u.ival = TYPE_STRING;
+                lines_func.name = sym_intern_str("lines");
+        }
+
+        r = malloc(sizeof(LineReader));
+        if (!r)
+                die(at, "Out of Memory Error");
+        r->f = file_new(at, fd, 0);
+        r->cap = 1;
+
+        /* the scope gen_new takes over, the line str lives there */
+        env_push();
+        set_string(&v, "");
+        r->line = v.data.s;
+        env_set(sym_intern_str("lines line"), v);
+
+        g = gen_new(&lines_func, lines_body);
+        g->data = r;
+        g->release = release_reader;
+        /* a dropped lines() generator keeps its fd until it is collected */
+        gc_hold_fds(1);
+        return g;
+}
+
+/* len + 1 rounded up to pages, the extra byte is the NUL */
+static size_t mapped_size(unsigned int len)
+{
+        size_t page = (size_t) sysconf(_SC_PAGESIZE);
+        return ((size_t) len + page) / page * page;
+}
+
+static void unmap_string(void* payload)
+{
+        String* s = payload;
+        munmap(s->data, mapped_size(s->length));
+}
+
+/*
+ * the file's pages become the str's data without a copy. the mapping is
+ * private, so stores into the str copy only the page they touch and never
+ * reach the file. anonymous memory past the end gives the closing NUL.
+ */
+String* file_map(Node* at, const char* path)
+{
+        static int registered = 0;
+        int fd = open_file(path, O_RDONLY);
+        struct stat st;
+        size_t total;
+        char* base;
+        String* s;
+
+        if (fd < 0 || fstat(fd, &st) < 0)
+                die(at, "map_file: %s: %s", path, strerror(errno));
+        if (st.st_size == 0) {
+                close(fd);
+                return string_new("");
+        }
+        if ((unsigned long) st.st_size >= UINT_MAX)
+                die(at, "map_file: %s is too large for a str", path);
+
+        total = mapped_size((unsigned int) st.st_size);
+        base = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED
+            || mmap(base, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+                die(at, "map_file: %s: %s", path, strerror(errno));
+        close(fd);
+
+        if (!registered) {
+                gc_set_finalizer(scan_mapped_string, unmap_string);
+                registered = 1;
+        }
+        s = gc_alloc(sizeof(String), scan_mapped_string);
+        s->data = base;
+        s->length = (unsigned int) st.st_size;
+        return s;
+}
@@ -5,32 +5,31 @@
 
 #include "func.h"
 #include "uthash.h"
-#include <string.h>
 
 typedef struct Func {
-        const char* name;
+        Symbol name;
         Node* ast;
         UT_hash_handle hh;
 } Func;
 
 static Func* table = NULL;
 
-void func_set(const char* name, Node* ast)
+void func_set(Symbol name, Node* ast)
 {
         Func* entry;
-        HASH_FIND_STR(table, name, entry);
+        HASH_FIND_SYM(table, &name, entry);
         if (!entry) {
                 entry = malloc(sizeof(Func));
-                entry->name = strdup(name);
-                HASH_ADD_KEYPTR(hh, table, entry->name, strlen(entry->name), entry);
+                entry->name = name;
+                HASH_ADD_SYM(table, name, entry);
         }
         entry->ast = ast;
 }
 
-Node* func_get(const char* name)
+Node* func_get(Symbol name)
 {
         Func* entry;
-        HASH_FIND_STR(table, name, entry);
+        HASH_FIND_SYM(table, &name, entry);
         return entry ? entry->ast : NULL;
 }
 
@@ -41,7 +40,16 @@ void func_clear(void)
 
         HASH_ITER(hh, table, cur, tmp) {
                 HASH_DEL(table, cur);
-                free((char*)cur->name);
                 free(cur);
         }
 }
+
+void func_each(void (*fn)(Symbol name, Node* ast, void* ctx), void* ctx)
+{
+        Func* cur;
+        Func* tmp;
+
+        HASH_ITER(hh, table, cur, tmp) {
+                fn(cur->name, cur->ast, ctx);
+        }
+}
@@ -2,38 +2,135 @@
  * Author: Mason Armand
  * Date Created: May 9th, 2025
  */
+/* MAP_ANONYMOUS */
+#define _DEFAULT_SOURCE
+
 #include "gc_tri.h"
 #include "util.h"
 #include "env.h"
 #include "scan.h"
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include <limits.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 #define GC_DEFAULT_SLICE_SIZE 100000
 
+/* blocks inside a compaction region are aligned like malloc'd ones */
+#define GC_REGION_ALIGN 16
+#define ALIGN_UP(n, a) ( ((n) + (a) - 1) & ~((size_t)(a) - 1) )
+
 #define HEADER_OF(p) ( (GC_Header*)( (p) ) - 1 )
 #define PAYLOAD_OF(h) ( (void*)( (h) + 1 ) )
 
+/*
+ * dense mmap'd block that compaction evacuates live buffers into.
+ * objects in a region are never freed individually, the whole region is
+ * unmapped once its last object dies.
+ */
+typedef struct GC_Region {
+        struct GC_Region* next;
+        size_t map_size;
+        size_t used;
+        size_t live_bytes;
+        size_t live_objects;
+} GC_Region;
+
 typedef struct GC_Header {
         struct GC_Header* prev;
         struct GC_Header* next;
         struct GC_Header* gray_next;
 
         GC_ScanFn scan;
+        GC_Region* region; /* NULL if malloc'd */
         int marked;
+        unsigned int epoch; /* gc_epoch when allocated */
         size_t payload_size;
         /* payload*/
 } GC_Header;
 
+/* an evacuated object, old and new payload */
+typedef struct GC_Move {
+        char* from;
+        char* to;
+        size_t size;
+} GC_Move;
+
 static GC_Header* heap_head = NULL;
 static GC_Header* gray_head = NULL;
+static GC_Region* regions = NULL;
+static int compaction_enabled = 0;
+static unsigned int gc_epoch = 0;
+static volatile sig_atomic_t in_collection = 0;
+static GC_AllocHook alloc_hook = NULL;
+
+/* kinds of objects that hold resources outside the heap */
+#define GC_MAX_FINALIZERS 4
+static GC_ScanFn final_scan[GC_MAX_FINALIZERS];
+static GC_FinalizeFn final_fn[GC_MAX_FINALIZERS];
+static int n_finalizers = 0;
 
 /* mark bit flips each gc cycle */
 static int current_mark_bit = 0;
 static int gc_cycle_in_progress = 0;
 static int gc_slice_size = GC_DEFAULT_SLICE_SIZE;
 
+/* fds held by objects that close them when collected, see gc_hold_fds() */
+static long held_fds = 0;
+static long fd_trigger = 0;
+
+static GC_Stats stats;
+/* mark/sweep time of the cycle currently in progress */
+static double cycle_mark_ms = 0.0;
+static double cycle_sweep_ms = 0.0;
+
+static const char* kind_names[GC_NUM_KINDS] = {
+        "raw",
+        "string",
+        "array",
+        "varentry",
+        "scope",
+        "rec",
+        "recdef",
+        "dict",
+        "other"
+};
+
+static double now_ms(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void note_pause(double ms)
+{
+        if (ms > stats.max_pause_ms)
+                stats.max_pause_ms = ms;
+}
+
+/* account for a header that is about to be freed, run its finalizer */
+static void note_free(GC_Header* h)
+{
+        int i;
+
+        for (i = 0; i < n_finalizers; i++) {
+                if (h->scan == final_scan[i])
+                        final_fn[i](PAYLOAD_OF(h));
+        }
+        stats.heap_bytes -= h->payload_size;
+        stats.heap_objects--;
+        stats.freed[gc_kind_of(h->scan)]++;
+}
+
 static void mark_obj(void* payload)
 {
         GC_Header* h;
@@ -47,12 +144,83 @@ static void mark_obj(void* payload)
         }
 }
 
+static void mark_slot(void** slot)
+{
+        mark_obj(*slot);
+}
+
 static void scan_children(GC_Header* h)
 {
         if (h->scan) {
                 void* payload = PAYLOAD_OF(h);
-                h->scan(payload, mark_obj);
+                h->scan(payload, mark_slot);
+        }
+}
+
+/*
+ * a header that is queued on the gray list has already been marked this
+ * cycle, so only walk the list when that is the case
+ */
+static int gray_remove(GC_Header* h)
+{
+        GC_Header** link;
+
+        if (!gc_cycle_in_progress || h->marked != current_mark_bit)
+                return 0;
+
+        for (link = &gray_head; *link; link = &(*link)->gray_next) {
+                if (*link == h) {
+                        *link = h->gray_next;
+                        return 1;
+                }
+        }
+        return 0;
+}
+
+static void heap_unlink(GC_Header* h)
+{
+        if (h->prev)
+                h->prev->next = h->next;
+        else
+                heap_head = h->next;
+        if (h->next)
+                h->next->prev = h->prev;
+}
+
+/* point the neighbours of a moved header at its new address */
+static void heap_relink(GC_Header* h)
+{
+        if (h->prev)
+                h->prev->next = h;
+        else
+                heap_head = h;
+        if (h->next)
+                h->next->prev = h;
+}
+
+static void region_unmap(GC_Region* r)
+{
+        GC_Region** link;
+        for (link = &regions; *link; link = &(*link)->next) {
+                if (*link == r) {
+                        *link = r->next;
+                        break;
+                }
+        }
+        munmap(r, r->map_size);
+}
+
+/* give back the memory of a header that has been unlinked */
+static void release_header(GC_Header* h)
+{
+        GC_Region* r = h->region;
+        if (!r) {
+                free(h);
+                return;
         }
+        r->live_bytes -= h->payload_size;
+        if (--r->live_objects == 0)
+                region_unmap(r);
 }
 
 static void gc_begin_cycle(void)
@@ -60,10 +228,24 @@ static void gc_begin_cycle(void)
         current_mark_bit = !current_mark_bit;
         gray_head = NULL;
         gc_cycle_in_progress = 1;
+        cycle_mark_ms = 0.0;
+        cycle_sweep_ms = 0.0;
         mark_obj(env_stack);
         mark_obj(recdefs);
 }
 
+static void gc_end_cycle(void)
+{
+        gc_cycle_in_progress = 0;
+        stats.cycles++;
+        stats.live_bytes = stats.heap_bytes;
+        stats.live_objects = stats.heap_objects;
+        stats.last_mark_ms = cycle_mark_ms;
+        stats.last_sweep_ms = cycle_sweep_ms;
+        stats.total_mark_ms += cycle_mark_ms;
+        stats.total_sweep_ms += cycle_sweep_ms;
+}
+
 /* public gc api */
 
 void gc_init(void)
@@ -71,6 +253,7 @@ void gc_init(void)
         heap_head = NULL;
         gray_head = NULL;
         current_mark_bit = 0;
+        memset(&stats, 0, sizeof(stats));
 }
 
 void* gc_alloc(size_t size, GC_ScanFn scan)
@@ -80,8 +263,11 @@ void* gc_alloc(size_t size, GC_ScanFn scan)
         if (!h)
                 die(NULL, "Out of Memory Error");
 
-        h->marked = 0;
+        /* white to the next cycle, the bit flips when it begins */
+        h->marked = current_mark_bit;
+        h->epoch = gc_epoch;
         h->scan = scan;
+        h->region = NULL;
         h->prev = NULL;
         h->next = heap_head;
         h->payload_size = size;
@@ -90,34 +276,101 @@ void* gc_alloc(size_t size, GC_ScanFn scan)
                 heap_head->prev = h;
         heap_head = h;
 
+        stats.bytes_allocated += size;
+        stats.objects_allocated++;
+        stats.heap_bytes += size;
+        stats.heap_objects++;
+
         payload = PAYLOAD_OF(h);
 
-        if (gc_cycle_in_progress)
+        /* gray to a running one */
+        if (gc_cycle_in_progress) {
+                h->marked = !current_mark_bit;
                 mark_obj(payload);
+        }
+        if (alloc_hook)
+                alloc_hook(size, scan);
 
         return payload;
 }
 
+/*
+ * resize an object, growing in place when malloc allows it.
+ * the old block is released immediately instead of being left for the
+ * sweeper, since nothing can reference it after the resize.
+ */
 void* gc_realloc(void* ptr, size_t new_size, GC_ScanFn scan)
 {
         GC_Header* old_h;
-        size_t old_size;
-        void* new_p;
+        GC_Header* h;
+        int was_gray;
 
         if (!ptr)
                 return gc_alloc(new_size, scan);
 
         old_h = HEADER_OF(ptr);
-        old_size = old_h->payload_size;
-        new_p = gc_alloc(new_size, scan);
-        memcpy(new_p, ptr, old_size < new_size ? old_size : new_size);
-        return new_p;
 
+        /* pull header off the gray list while its address may change */
+        was_gray = gray_remove(old_h);
+
+        if (old_h->region) {
+                /* region blocks can't grow, move it back to malloc */
+                size_t keep = old_h->payload_size < new_size ? old_h->payload_size : new_size;
+                h = malloc(sizeof(GC_Header) + new_size);
+                if (!h)
+                        die(NULL, "Out of Memory Error");
+                memcpy(h, old_h, sizeof(GC_Header) + keep);
+                h->region = NULL;
+                release_header(old_h);
+        }
+        else {
+                h = realloc(old_h, sizeof(GC_Header) + new_size);
+                if (!h)
+                        die(NULL, "Out of Memory Error");
+        }
+
+        heap_relink(h);
+
+        stats.heap_bytes += new_size - h->payload_size;
+        if (new_size > h->payload_size) {
+                stats.bytes_allocated += new_size - h->payload_size;
+                if (alloc_hook)
+                        alloc_hook(new_size - h->payload_size, scan);
+        }
+
+        h->scan = scan;
+        h->payload_size = new_size;
+
+        if (was_gray) {
+                h->gray_next = gray_head;
+                gray_head = h;
+        }
+
+        return PAYLOAD_OF(h);
 }
 
+/* release an object that is known to be unreachable */
+void gc_free(void* ptr)
+{
+        GC_Header* h;
+        if (!ptr)
+                return;
+        h = HEADER_OF(ptr);
+        gray_remove(h);
+        heap_unlink(h);
+        note_free(h);
+        release_header(h);
+}
+
+/*
+ * grays an object while a cycle is marking. also the write barrier for
+ * pointers moved where the marker may already have looked, such as
+ * scopes a generator takes on and off env_stack.
+ */
 void gc_mark_root(void* payload)
 {
-        mark_obj(payload);
+        if (gc_cycle_in_progress)
+                mark_obj(payload);
 }
 
 /* returns 1 (true), if work still remaining */
@@ -161,13 +414,9 @@ size_t gc_sweep(size_t max)
                                 fprintf(stderr, "[GC] free VarEntry    @ %p\n", payload);
                         }
                         */
-                        if (h->prev)
-                                h->prev->next = h->next;
-                        else
-                                heap_head = h->next;
-                        if (h->next)
-                                h->next->prev = h->prev;
-                        free(h);
+                        heap_unlink(h);
+                        note_free(h);
+                        release_header(h);
                         freed++;
                 }
                 h = next;
@@ -175,29 +424,388 @@ size_t gc_sweep(size_t max)
         return freed;
 }
 
-int gc_collect_step(void)
+static int collect_step(void)
 {
+        double start = now_ms();
+        double mid;
+        double end;
+
         if(!gc_cycle_in_progress)
                 gc_begin_cycle();
 
-        if (gc_step())
+        if (gc_step()) {
+                end = now_ms();
+                cycle_mark_ms += end - start;
+                note_pause(end - start);
                 return 1;
-        if (gc_sweep_slice(gc_slice_size) > 0)
+        }
+        mid = now_ms();
+        cycle_mark_ms += mid - start;
+
+        if (gc_sweep_slice(gc_slice_size) > 0) {
+                end = now_ms();
+                cycle_sweep_ms += end - mid;
+                note_pause(end - start);
                 return 1;
+        }
+        end = now_ms();
+        cycle_sweep_ms += end - mid;
+        note_pause(end - start);
 
-        gc_cycle_in_progress = 0;
+        gc_end_cycle();
         return 0;
 }
 
+static long fd_limit(void)
+{
+        struct rlimit rl;
+
+        if (getrlimit(RLIMIT_NOFILE, &rl) != 0 || rl.rlim_cur == RLIM_INFINITY)
+                return 1024;
+        return (long) rl.rlim_cur;
+}
+
+/* objects whose finalizer closes fds count them here, n < 0 as they close */
+void gc_hold_fds(int n)
+{
+        held_fds += n;
+}
+
+/*
+ * dropped ones keep their fds until they are collected, which can take
+ * longer than the fds last. runs a full collection once they hold half
+ * of them. only call it where no Var is held just in a C local.
+ */
+void gc_collect_fds(void)
+{
+        if (fd_trigger == 0)
+                fd_trigger = fd_limit() / 2;
+        if (held_fds < fd_trigger || in_collection)
+                return;
+        gc_collect_full();
+        /* halfway to the limit from what is still live */
+        fd_trigger = held_fds + (fd_limit() - held_fds) / 2;
+        if (fd_trigger <= held_fds)
+                fd_trigger = held_fds + 1;
+}
+
+int gc_collect_step(void)
+{
+        int more;
+        in_collection++;
+        more = collect_step();
+        in_collection--;
+        return more;
+}
+
 void gc_collect_full(void)
 {
+        double start;
+        double mid;
+
+        in_collection++;
         gc_slice_size = 0;
         /* finish previous cycle */
         while (gc_collect_step()) {}
 
+        start = now_ms();
         gc_begin_cycle();
         while (gc_step()) {}
+        mid = now_ms();
         gc_sweep_all();
-        gc_cycle_in_progress = 0;
+        cycle_mark_ms = mid - start;
+        cycle_sweep_ms = now_ms() - mid;
+        note_pause(cycle_mark_ms + cycle_sweep_ms);
+        gc_end_cycle();
         gc_slice_size = GC_DEFAULT_SLICE_SIZE;
+
+        if (compaction_enabled)
+                gc_compact();
+        in_collection--;
+}
+
+/* growing reallocations report only the bytes added */
+void gc_set_alloc_hook(GC_AllocHook hook)
+{
+        alloc_hook = hook;
+}
+
+/* fn is called with every object allocated with scan just before it is freed */
+void gc_set_finalizer(GC_ScanFn scan, GC_FinalizeFn fn)
+{
+        int i;
+
+        for (i = 0; i < n_finalizers; i++) {
+                if (final_scan[i] == scan) {
+                        final_fn[i] = fn;
+                        return;
+                }
+        }
+        if (n_finalizers == GC_MAX_FINALIZERS)
+                die(NULL, "gc: too many finalizers");
+        final_scan[n_finalizers] = scan;
+        final_fn[n_finalizers] = fn;
+        n_finalizers++;
+}
+
+/* nonzero while a collection runs. only reads a flag, safe in signal handlers */
+int gc_in_collection(void)
+{
+        return in_collection != 0;
+}
+
+/* compaction */
+
+/* live objects of regions below half occupancy are evacuated again */
+static int is_movable(GC_Header* h)
+{
+        /*
+         * only leaf buffers (string data, array storage, record fields)
+         * are moved. their single owner is fixed up through its scan
+         * callback and interior pointers only come from VarEntry aliases.
+         * other objects may be held in C locals while the program runs.
+         */
+        if (h->scan != scan_raw)
+                return 0;
+        if (!h->region)
+                return 1;
+        return h->region->live_bytes * 2 < h->region->used;
+}
+
+static GC_Move* moves = NULL;
+static size_t n_moves = 0;
+
+static int cmp_move(const void* a, const void* b)
+{
+        const char* x = ((const GC_Move*) a)->from;
+        const char* y = ((const GC_Move*) b)->from;
+        return (x > y) - (x < y);
+}
+
+/* find the move containing p, which may point inside the old block */
+static GC_Move* find_move(const char* p)
+{
+        size_t lo = 0;
+        size_t hi = n_moves;
+        while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                GC_Move* m = &moves[mid];
+                if (p < m->from)
+                        hi = mid;
+                else if (p >= m->from + m->size && !(m->size == 0 && p == m->from))
+                        lo = mid + 1;
+                else
+                        return m;
+        }
+        return NULL;
+}
+
+static void forward_slot(void** slot)
+{
+        GC_Move* m;
+        if (!*slot)
+                return;
+        m = find_move(*slot);
+        if (m && (char*) *slot == m->from)
+                *slot = m->to;
+}
+
+static GC_Region* region_new(size_t bytes)
+{
+        size_t map_size = ALIGN_UP(sizeof(GC_Region), GC_REGION_ALIGN) + bytes;
+        GC_Region* r = mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (r == MAP_FAILED)
+                return NULL;
+        r->map_size = map_size;
+        r->used = ALIGN_UP(sizeof(GC_Region), GC_REGION_ALIGN);
+        r->live_bytes = 0;
+        r->live_objects = 0;
+        r->next = regions;
+        regions = r;
+        return r;
+}
+
+/*
+ * evacuate live leaf buffers into one dense region, rewrite the slots
+ * pointing at them through the scan callbacks, then release the old
+ * blocks. emptied regions are unmapped and free malloc pages returned
+ * to the os.
+ */
+void gc_compact(void)
+{
+        GC_Header* h;
+        GC_Region* r;
+        size_t bytes = 0;
+        size_t count = 0;
+        size_t i;
+
+        if (gc_cycle_in_progress)
+                return;
+
+        for (h = heap_head; h; h = h->next) {
+                if (is_movable(h)) {
+                        bytes += ALIGN_UP(sizeof(GC_Header) + h->payload_size, GC_REGION_ALIGN);
+                        count++;
+                }
+        }
+        if (count == 0)
+                goto trim;
+
+        r = region_new(bytes);
+        moves = malloc(sizeof(GC_Move) * count);
+        if (!r || !moves) {
+                free(moves);
+                moves = NULL;
+                goto trim;
+        }
+
+        /* copy, the old headers are kept until every slot is forwarded */
+        n_moves = 0;
+        for (h = heap_head; h; h = h->next) {
+                GC_Header* nh;
+                size_t block;
+                if (!is_movable(h) || h->region == r)
+                        continue;
+
+                block = ALIGN_UP(sizeof(GC_Header) + h->payload_size, GC_REGION_ALIGN);
+                nh = (GC_Header*) ((char*) r + r->used);
+                r->used += block;
+                r->live_bytes += h->payload_size;
+                r->live_objects++;
+
+                memcpy(nh, h, sizeof(GC_Header) + h->payload_size);
+                nh->region = r;
+                heap_relink(nh);
+
+                moves[n_moves].from = PAYLOAD_OF(h);
+                moves[n_moves].to = PAYLOAD_OF(nh);
+                moves[n_moves].size = h->payload_size;
+                n_moves++;
+                stats.bytes_compacted += h->payload_size;
+                h = nh;
+        }
+        qsort(moves, n_moves, sizeof(GC_Move), cmp_move);
+
+        /* owners, found through their scan callbacks */
+        for (h = heap_head; h; h = h->next) {
+                if (h->scan && h->scan != scan_raw)
+                        h->scan(PAYLOAD_OF(h), forward_slot);
+        }
+
+        /* VarEntry aliases can point into the middle of a moved buffer */
+        for (h = heap_head; h; h = h->next) {
+                VarEntry* e;
+                GC_Move* m;
+                if (h->scan != scan_varentry)
+                        continue;
+                e = PAYLOAD_OF(h);
+                if (!e->alias)
+                        continue;
+                m = find_move((char*) e->alias);
+                if (m)
+                        e->alias = (Var*) (m->to + ((char*) e->alias - m->from));
+        }
+
+        for (i = 0; i < n_moves; i++)
+                release_header(HEADER_OF(moves[i].from));
+
+        free(moves);
+        moves = NULL;
+        n_moves = 0;
+        stats.compactions++;
+
+trim:
+#ifdef __GLIBC__
+        malloc_trim(0);
+#endif
+        return;
+}
+
+void gc_set_compaction(int enabled)
+{
+        compaction_enabled = enabled;
+}
+
+/* objects allocated from now on carry the returned epoch */
+unsigned int gc_next_epoch(void)
+{
+        return ++gc_epoch;
+}
+
+unsigned int gc_epoch_of(const void* payload)
+{
+        return HEADER_OF(payload)->epoch;
+}
+
+/* visits every object, reachable or not, newest first */
+void gc_walk(GC_WalkFn fn, void* ctx)
+{
+        GC_Header* h;
+        for (h = heap_head; h; h = h->next)
+                fn(PAYLOAD_OF(h), h->payload_size, h->scan, ctx);
+}
+
+/* statistics */
+
+GC_Kind gc_kind_of(GC_ScanFn scan)
+{
+        if (scan == scan_raw)
+                return GC_KIND_RAW;
+        if (scan == scan_string)
+                return GC_KIND_STRING;
+        if (scan == scan_arraylist)
+                return GC_KIND_ARRAY;
+        if (scan == scan_varentry)
+                return GC_KIND_VARENTRY;
+        if (scan == scan_scope)
+                return GC_KIND_SCOPE;
+        if (scan == scan_rec)
+                return GC_KIND_REC;
+        if (scan == scan_recdef)
+                return GC_KIND_RECDEF;
+        if (scan == scan_dict)
+                return GC_KIND_DICT;
+        return GC_KIND_OTHER;
+}
+
+const char* gc_kind_name(GC_Kind kind)
+{
+        if (kind < 0 || kind >= GC_NUM_KINDS)
+                return kind_names[GC_KIND_OTHER];
+        return kind_names[kind];
+}
+
+const GC_Stats* gc_get_stats(void)
+{
+        return &stats;
+}
+
+void gc_print_stats(void)
+{
+        int i;
+
+        fprintf(stderr, "[GC] cycles:            %lu\n", (unsigned long) stats.cycles);
+        fprintf(stderr, "[GC] allocated:         %lu bytes in %lu objects\n",
+                (unsigned long) stats.bytes_allocated,
+                (unsigned long) stats.objects_allocated);
+        fprintf(stderr, "[GC] live after cycle:  %lu bytes in %lu objects\n",
+                (unsigned long) stats.live_bytes,
+                (unsigned long) stats.live_objects);
+        fprintf(stderr, "[GC] on heap now:       %lu bytes in %lu objects\n",
+                (unsigned long) stats.heap_bytes,
+                (unsigned long) stats.heap_objects);
+        fprintf(stderr, "[GC] mark time:         %.3f ms (last cycle %.3f ms)\n",
+                stats.total_mark_ms, stats.last_mark_ms);
+        fprintf(stderr, "[GC] sweep time:        %.3f ms (last cycle %.3f ms)\n",
+                stats.total_sweep_ms, stats.last_sweep_ms);
+        fprintf(stderr, "[GC] max pause:         %.3f ms\n", stats.max_pause_ms);
+        fprintf(stderr, "[GC] compactions:       %lu (%lu bytes moved)\n",
+                (unsigned long) stats.compactions,
+                (unsigned long) stats.bytes_compacted);
+        fprintf(stderr, "[GC] freed by kind:\n");
+        for (i = 0; i < GC_NUM_KINDS; i++) {
+                fprintf(stderr, "[GC]   %-10s %lu\n",
+                        kind_names[i], (unsigned long) stats.freed[i]);
+        }
 }
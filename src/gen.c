@@ -0,0 +1,239 @@
+/* ucontext, MAP_ANONYMOUS */
+#define _DEFAULT_SOURCE
+
+#include "gen.h"
+#include "gc_tri.h"
+#include "scan.h"
+#include "util.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+
+/* pages are only used once touched, deep recursion in a generator has room */
+#define GEN_STACK_SIZE (1 << 20)
+
+typedef struct GenStack {
+        ucontext_t ctx;         /* the generator */
+        ucontext_t back;        /* whoever resumed it */
+        char* mem;              /* a guard page, then the stack */
+        size_t size;
+} GenStack;
+
+/* stacks of finished generators, kept for the next ones */
+#define GEN_SPARE_STACKS 8
+static GenStack* spare[GEN_SPARE_STACKS];
+static int n_spare = 0;
+
+/* the innermost running generator */
+static Gen* running = NULL;
+
+/* handed to gen_main, makecontext only passes ints */
+static Gen* starting = NULL;
+
+int gen_is_elem_type(VarType type)
+{
+        return type <= TYPE_BOOL || type == TYPE_CHAR || type == TYPE_STRING;
+}
+
+static void free_stack(Gen* g)
+{
+        prof_frames_free(&g->prof);
+        if (!g->stack)
+                return;
+        if (n_spare < GEN_SPARE_STACKS) {
+                spare[n_spare++] = g->stack;
+        }
+        else {
+                munmap(g->stack->mem, g->stack->size);
+                free(g->stack);
+        }
+        g->stack = NULL;
+}
+
+/* a generator dropped before it finished */
+static void gen_finalize(void* payload)
+{
+        Gen* g = payload;
+
+        if (g->release)
+                g->release(g->data);
+        free_stack(g);
+}
+
+/* takes the top scope, which holds the arguments of the call to func */
+Gen* gen_new(Node* func, GenBody body)
+{
+        static int registered = 0;
+        Gen* g;
+        Var self;
+
+        if (!registered) {
+                gc_set_finalizer(scan_gen, gen_finalize);
+                registered = 1;
+        }
+
+        g = gc_alloc(sizeof(Gen), scan_gen);
+        g->type = (VarType) func->u.ival;
+        g->state = GEN_NEW;
+        g->func = func;
+        g->body = body;
+        set_void(&g->value);
+        g->caller = NULL;
+        g->resumer = NULL;
+        g->stack = NULL;
+        g->data = NULL;
+        g->release = NULL;
+        memset(&g->prof, 0, sizeof(g->prof));
+
+        /* its scopes are on env_stack while it runs, so it stays reachable */
+        self.type = TYPE_GEN;
+        self.data.g = g;
+        self.is_const = 0;
+        env_set(sym_intern_str("running generator"), self);
+
+        g->base = env_detach();
+        g->base->next = NULL;
+        g->env = g->base;
+        return g;
+}
+
+static GenStack* new_stack(Node* at)
+{
+        long page = sysconf(_SC_PAGESIZE);
+        GenStack* st;
+
+        if (n_spare > 0) {
+                st = spare[--n_spare];
+        }
+        else {
+                st = malloc(sizeof(GenStack));
+                if (!st)
+                        die(NULL, "Out of Memory Error");
+                st->size = GEN_STACK_SIZE + (size_t) page;
+                st->mem = mmap(NULL, st->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (st->mem == MAP_FAILED)
+                        die(at, "generator: could not map a stack");
+                /* overflowing the stack faults instead of writing over the heap */
+                mprotect(st->mem, (size_t) page, PROT_NONE);
+        }
+        return st;
+}
+
+/* gives the thread back to the resumer, called on the generator's stack */
+static void leave(Gen* g)
+{
+        gc_mark_root(env_stack);
+        gc_mark_root(g->caller);
+        g->env = env_stack;
+        env_stack = g->caller;
+        g->caller = NULL;
+        g->base->next = NULL;
+}
+
+static void gen_main(void)
+{
+        Gen* g = starting;
+
+        g->body(g->func);
+        g->state = GEN_DONE;
+        leave(g);
+        /* returning switches to uc_link */
+}
+
+/* no locals here, getcontext returns twice */
+static void start_context(Gen* g)
+{
+        getcontext(&g->stack->ctx);
+        g->stack->ctx.uc_stack.ss_sp = g->stack->mem + (g->stack->size - GEN_STACK_SIZE);
+        g->stack->ctx.uc_stack.ss_size = GEN_STACK_SIZE;
+        g->stack->ctx.uc_link = &g->stack->back;
+        makecontext(&g->stack->ctx, gen_main, 0);
+        starting = g;
+}
+
+static void resume(Node* at, Gen* g)
+{
+        if (g->state == GEN_RUNNING)
+                die(at, "generator '%s' is already running", sym_name(g->func->name));
+
+        if (g->state == GEN_NEW) {
+                g->stack = new_stack(at);
+                start_context(g);
+        }
+
+        /* a running cycle may have scanned g and env_stack already */
+        gc_mark_root(g->env);
+        gc_mark_root(env_stack);
+        g->resumer = running;
+        g->caller = env_stack;
+        g->base->next = env_stack;
+        env_stack = g->env;
+        g->env = NULL;
+        g->state = GEN_RUNNING;
+        running = g;
+        if (prof_enabled)
+                prof_resume(&g->prof);
+
+        swapcontext(&g->stack->back, &g->stack->ctx);
+
+        running = g->resumer;
+        g->resumer = NULL;
+        if (g->state == GEN_DONE)
+                free_stack(g);
+}
+
+/* runs g to its next yield unless a value is waiting. zero once it is done */
+int gen_ready(Node* at, Gen* g)
+{
+        if (g->state != GEN_READY && g->state != GEN_DONE)
+                resume(at, g);
+        return g->state == GEN_READY;
+}
+
+Var gen_take(Node* at, Gen* g)
+{
+        Var v;
+
+        if (!gen_ready(at, g))
+                die(at, "next: generator '%s' is finished", sym_name(g->func->name));
+        v = g->value;
+        set_void(&g->value);
+        g->state = GEN_SUSPENDED;
+        return v;
+}
+
+Gen* gen_running(void)
+{
+        return running;
+}
+
+/* hands val to the resumer of the innermost running generator */
+void gen_yield(Node* at, Var val)
+{
+        if (val.type == TYPE_STRING)
+                val = var_clone(&val);
+        gen_yield_shared(at, val);
+}
+
+/* yields a str without copying it, its owner may change it afterwards */
+void gen_yield_shared(Node* at, Var val)
+{
+        Gen* g = running;
+
+        if (!g)
+                die(at, "yield outside a generator");
+        if (val.type != g->type) {
+                die(at, "yield: generator '%s' yields type %d, got %d",
+                        sym_name(g->func->name), g->type, val.type);
+        }
+
+        g->value = val;
+        g->state = GEN_READY;
+        if (prof_enabled)
+                prof_suspend(&g->prof);
+        leave(g);
+        swapcontext(&g->stack->ctx, &g->stack->back);
+}
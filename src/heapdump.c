@@ -0,0 +1,151 @@
+#include "heapdump.h"
+#include "gc_tri.h"
+#include "env.h"
+#include "rec.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* set from the SIGUSR1 handler, the dump itself happens at a safe point */
+static volatile sig_atomic_t dump_requested = 0;
+
+/* outgoing edges of the object currently being written */
+static void** edges = NULL;
+static unsigned int n_edges = 0;
+static unsigned int edges_cap = 0;
+
+static void collect_edge(void** slot)
+{
+        void* payload = *slot;
+        if (!payload)
+                return;
+        if (n_edges >= edges_cap) {
+                edges_cap = edges_cap ? edges_cap * 2 : 64;
+                edges = realloc(edges, sizeof(void*) * edges_cap);
+                if (!edges) {
+                        fprintf(stderr, "Out of Memory Error\n");
+                        exit(1);
+                }
+        }
+        edges[n_edges++] = payload;
+}
+
+static void write_uint(FILE* f, unsigned long v, int nbytes)
+{
+        int i;
+        for (i = 0; i < nbytes; i++) {
+                fputc((int) (v & 0xff), f);
+                v >>= 8;
+        }
+}
+
+static void write_addr(FILE* f, const void* p)
+{
+        write_uint(f, (unsigned long) p, 8);
+}
+
+static const char* object_name(void* payload, GC_Kind kind)
+{
+        switch (kind) {
+        case GC_KIND_REC:
+                return ((RecInst*) payload)->def->name;
+        case GC_KIND_RECDEF:
+                return ((RecDef*) payload)->name;
+        case GC_KIND_VARENTRY:
+                return sym_name(((VarEntry*) payload)->name);
+        default:
+                return NULL;
+        }
+}
+
+static void write_object(void* payload, size_t size, GC_ScanFn scan, void* ctx)
+{
+        FILE* f = ctx;
+        GC_Kind kind = gc_kind_of(scan);
+        const char* name = object_name(payload, kind);
+        size_t name_len = name ? strlen(name) : 0;
+        unsigned int i;
+
+        if (name_len > 0xffff)
+                name_len = 0xffff;
+
+        n_edges = 0;
+        if (scan)
+                scan(payload, collect_edge);
+
+        fputc('O', f);
+        write_addr(f, payload);
+        write_uint(f, (unsigned long) kind, 1);
+        write_uint(f, (unsigned long) size, 8);
+        write_uint(f, (unsigned long) name_len, 2);
+        if (name_len)
+                fwrite(name, 1, name_len, f);
+        write_uint(f, n_edges, 4);
+        for (i = 0; i < n_edges; i++)
+                write_addr(f, edges[i]);
+}
+
+/* returns 0 on success, -1 if the file could not be written */
+int heap_dump(const char* path)
+{
+        FILE* f = fopen(path, "wb");
+        int err;
+
+        if (!f)
+                return -1;
+
+        fwrite(HEAPDUMP_MAGIC, 1, strlen(HEAPDUMP_MAGIC), f);
+        write_uint(f, HEAPDUMP_VERSION, 4);
+
+        if (env_stack) {
+                fputc('R', f);
+                write_addr(f, env_stack);
+        }
+        if (recdefs) {
+                fputc('R', f);
+                write_addr(f, recdefs);
+        }
+
+        gc_walk(write_object, f);
+        fputc('E', f);
+
+        err = ferror(f);
+        if (fclose(f) != 0 || err)
+                return -1;
+        return 0;
+}
+
+static void on_sigusr1(int sig)
+{
+        (void) sig;
+        dump_requested = 1;
+}
+
+void heap_dump_install_signal(void)
+{
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = on_sigusr1;
+        sigemptyset(&sa.sa_mask);
+        sa.sa_flags = SA_RESTART;
+        sigaction(SIGUSR1, &sa, NULL);
+}
+
+/* called between statements and loop iterations, writes puer-<pid>.heap if SIGUSR1 arrived */
+void heap_dump_poll(void)
+{
+        char path[64];
+
+        if (!dump_requested)
+                return;
+        dump_requested = 0;
+
+        sprintf(path, "puer-%ld.heap", (long) getpid());
+        if (heap_dump(path) == 0)
+                fprintf(stderr, "heap dumped to %s\n", path);
+        else
+                fprintf(stderr, "could not write heap dump %s\n", path);
+}
@@ -0,0 +1,473 @@
+#include "loop.h"
+#include "var.h"
+#include "util.h"
+#include "output.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+/* events taken from epoll_wait at a time */
+#define LOOP_EVENTS 64
+
+typedef struct Watch {
+        Node* on_read;          /* NULL when not reading */
+        char* out;              /* queued by write_async */
+        size_t out_len;
+        size_t out_off;         /* how much of out is written */
+        int events;             /* EPOLLIN and EPOLLOUT wanted */
+        int old_flags;          /* -1 unless made non-blocking */
+        int polled;             /* in the epoll set */
+        int is_file;            /* epoll refused it, always ready */
+        int closing;            /* close once out is written */
+        FILE* pipe;             /* from open_pipe, for pclose */
+} Watch;
+
+typedef struct Timer {
+        int id;
+        long due;               /* from now_ms() */
+        int every;              /* 0 for a timer from after */
+        Node* func;
+} Timer;
+
+static int ep = -1;
+
+/* indexed by fd */
+static Watch* watches = NULL;
+static int cap_watches = 0;
+static int n_active = 0;        /* watches with events */
+static int n_files = 0;         /* of those, the always ready ones */
+
+static Timer* timers = NULL;
+static int n_timers = 0;
+static int cap_timers = 0;
+static int next_timer_id = 1;
+
+static int running = 0;
+static int stopped = 0;
+
+/* milliseconds since the first call */
+static long now_ms(void)
+{
+        static time_t base = 0;
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        if (!base)
+                base = ts.tv_sec;
+        return (long) (ts.tv_sec - base) * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* the fds are shared with the shell, don't leave them non-blocking */
+static void restore_flags(void)
+{
+        int fd;
+
+        for (fd = 0; fd < cap_watches; fd++) {
+                if (watches[fd].old_flags >= 0) {
+                        fcntl(fd, F_SETFL, watches[fd].old_flags);
+                        watches[fd].old_flags = -1;
+                }
+        }
+}
+
+static void reset_watch(Watch* w)
+{
+        memset(w, 0, sizeof(Watch));
+        w->old_flags = -1;
+}
+
+static Watch* watch_get(Node* at, int fd)
+{
+        if (fd < 0 || fcntl(fd, F_GETFL) < 0)
+                die(at, "fd %d is not open", fd);
+
+        if (fd >= cap_watches) {
+                int cap = cap_watches ? cap_watches : 16;
+                int i;
+
+                while (cap <= fd)
+                        cap *= 2;
+                watches = realloc(watches, sizeof(Watch) * (size_t) cap);
+                if (!watches)
+                        die(at, "Out of Memory Error");
+                for (i = cap_watches; i < cap; i++)
+                        reset_watch(&watches[i]);
+                cap_watches = cap;
+        }
+        return &watches[fd];
+}
+
+static void open_epoll(Node* at)
+{
+        if (ep >= 0)
+                return;
+        ep = epoll_create1(EPOLL_CLOEXEC);
+        if (ep < 0)
+                die(at, "event loop: %s", strerror(errno));
+}
+
+/* brings fd's epoll registration and flags in line with what it waits for */
+static void update(Node* at, int fd)
+{
+        static int registered = 0;
+        Watch* w = &watches[fd];
+        int want = (w->on_read ? EPOLLIN : 0) | (w->out_off < w->out_len ? EPOLLOUT : 0);
+        struct epoll_event ev;
+
+        if (want == w->events)
+                return;
+
+        open_epoll(at);
+        if (!registered) {
+                atexit(restore_flags);
+                registered = 1;
+        }
+
+        if (!w->events) {
+                n_active++;
+                if (w->old_flags < 0) {
+                        w->old_flags = fcntl(fd, F_GETFL);
+                        fcntl(fd, F_SETFL, w->old_flags | O_NONBLOCK);
+                }
+        }
+
+        memset(&ev, 0, sizeof(ev));
+        ev.events = (unsigned int) want;
+        ev.data.fd = fd;
+        if (!want) {
+                if (w->polled)
+                        epoll_ctl(ep, EPOLL_CTL_DEL, fd, &ev);
+                w->polled = 0;
+                n_active--;
+                fcntl(fd, F_SETFL, w->old_flags);
+                w->old_flags = -1;
+        }
+        else if (w->polled) {
+                epoll_ctl(ep, EPOLL_CTL_MOD, fd, &ev);
+        }
+        else if (!w->is_file) {
+                if (epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev) == 0)
+                        w->polled = 1;
+                else if (errno == EPERM)
+                        w->is_file = 1;
+                else
+                        die(at, "event loop: fd %d: %s", fd, strerror(errno));
+        }
+
+        if (w->is_file)
+                n_files += (want != 0) - (w->events != 0);
+        w->events = want;
+}
+
+static void finish_close(Node* at, int fd)
+{
+        Watch* w = &watches[fd];
+        FILE* pipe = w->pipe;
+
+        w->on_read = NULL;
+        update(at, fd);
+        reset_watch(w);
+        if (pipe)
+                pclose(pipe);
+        else if (close(fd) < 0)
+                die(at, "close_fd: fd %d: %s", fd, strerror(errno));
+}
+
+static void check_params(Node* at, const char* what, Node* func, int n, const VarType* types)
+{
+        Node* params = CHILD(func, 0);
+        int i;
+
+        if (params->n_children != (unsigned int) n)
+                die(at, "%s: '%s' must take %d arguments", what, sym_name(func->name), n);
+        for (i = 0; i < n; i++) {
+                if (CHILD(params, i)->vartype != types[i])
+                        die(at, "%s: '%s' argument %d must be type %d",
+                            what, sym_name(func->name), i + 1, types[i]);
+        }
+}
+
+int loop_open(Node* at, const char* path, const char* mode)
+{
+        int flags = O_RDONLY;
+        int fd;
+
+        if (strcmp(mode, "w") == 0)
+                flags = O_WRONLY | O_CREAT | O_TRUNC;
+        else if (strcmp(mode, "a") == 0)
+                flags = O_WRONLY | O_CREAT | O_APPEND;
+        else if (strcmp(mode, "r") != 0)
+                die(at, "open_fd: mode must be \"r\", \"w\" or \"a\", got \"%s\"", mode);
+
+        fd = open(path, flags | O_CLOEXEC, 0644);
+        if (fd < 0)
+                die(at, "open_fd: %s: %s", path, strerror(errno));
+        return fd;
+}
+
+/* fd reads the command's output, or writes its input */
+int loop_open_pipe(Node* at, const char* cmd, const char* mode)
+{
+        FILE* pipe;
+        int fd;
+
+        if (strcmp(mode, "r") != 0 && strcmp(mode, "w") != 0)
+                die(at, "open_pipe: mode must be \"r\" or \"w\", got \"%s\"", mode);
+
+        /* the command shares stdout */
+        out_flush();
+        pipe = popen(cmd, mode);
+        if (!pipe)
+                die(at, "open_pipe: %s: %s", cmd, strerror(errno));
+        fd = fileno(pipe);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        watch_get(at, fd)->pipe = pipe;
+        return fd;
+}
+
+/* waits for the command of a pipe, closes once queued writes are out */
+void loop_close(Node* at, int fd)
+{
+        Watch* w = watch_get(at, fd);
+
+        if (w->out_off < w->out_len) {
+                w->on_read = NULL;
+                w->closing = 1;
+                update(at, fd);
+                return;
+        }
+        finish_close(at, fd);
+}
+
+/* func(int fd, str data) is called for every read, with "" at the end */
+void loop_on_read(Node* at, int fd, Node* func)
+{
+        static const VarType types[] = { TYPE_INT, TYPE_STRING };
+        Watch* w = watch_get(at, fd);
+
+        check_params(at, "on_read", func, 2, types);
+        if (w->closing)
+                die(at, "on_read: fd %d is being closed", fd);
+        w->on_read = func;
+        update(at, fd);
+}
+
+void loop_write(Node* at, int fd, const String* data)
+{
+        Watch* w = watch_get(at, fd);
+        size_t pending;
+
+        if (w->closing)
+                die(at, "write_async: fd %d is being closed", fd);
+        if (data->length == 0)
+                return;
+
+        pending = w->out_len - w->out_off;
+        if (w->out_off > 0) {
+                memmove(w->out, w->out + w->out_off, pending);
+                w->out_off = 0;
+                w->out_len = pending;
+        }
+        w->out = realloc(w->out, pending + data->length);
+        if (!w->out)
+                die(at, "Out of Memory Error");
+        memcpy(w->out + pending, data->data, data->length);
+        w->out_len = pending + data->length;
+        update(at, fd);
+}
+
+/* func() or func(int id), once after ms or every ms */
+int loop_timer(Node* at, int ms, int repeat, Node* func)
+{
+        static const VarType types[] = { TYPE_INT };
+        const char* what = repeat ? "every" : "after";
+        Timer* t;
+
+        if (CHILD(func, 0)->n_children != 0)
+                check_params(at, what, func, 1, types);
+        if (ms < 0 || (repeat && ms == 0))
+                die(at, "%s: bad interval %d", what, ms);
+
+        if (n_timers == cap_timers) {
+                cap_timers = cap_timers ? cap_timers * 2 : 8;
+                timers = realloc(timers, sizeof(Timer) * (size_t) cap_timers);
+                if (!timers)
+                        die(at, "Out of Memory Error");
+        }
+        t = &timers[n_timers++];
+        t->id = next_timer_id++;
+        t->due = now_ms() + ms;
+        t->every = repeat ? ms : 0;
+        t->func = func;
+        return t->id;
+}
+
+void loop_cancel(int id)
+{
+        int i;
+
+        for (i = 0; i < n_timers; i++) {
+                if (timers[i].id == id) {
+                        timers[i] = timers[--n_timers];
+                        return;
+                }
+        }
+}
+
+void loop_stop(void)
+{
+        stopped = 1;
+}
+
+static void do_read(Node* at, int fd)
+{
+        static char buf[LOOP_READ_SIZE + 1];
+        Node* func = watches[fd].on_read;
+        ssize_t n;
+        Var args[2];
+
+        n = read(fd, buf, LOOP_READ_SIZE);
+        /* woken for nothing, or by a signal */
+        if (n < 0) {
+                if (errno != EAGAIN && errno != EINTR)
+                        die(at, "on_read: fd %d: %s", fd, strerror(errno));
+                return;
+        }
+        buf[n] = '\0';
+
+        /* the watch ends at end of file */
+        if (n == 0) {
+                watches[fd].on_read = NULL;
+                update(at, fd);
+        }
+
+        set_int(&args[0], fd);
+        set_string(&args[1], buf);
+        (void) call_function(at, func, args, 2);
+}
+
+static void do_write(Node* at, int fd)
+{
+        Watch* w = &watches[fd];
+        ssize_t n;
+
+        n = write(fd, w->out + w->out_off, w->out_len - w->out_off);
+        if (n < 0) {
+                if (errno != EAGAIN && errno != EINTR)
+                        die(at, "write_async: fd %d: %s", fd, strerror(errno));
+                return;
+        }
+
+        w->out_off += (size_t) n;
+        if (w->out_off < w->out_len)
+                return;
+        free(w->out);
+        w->out = NULL;
+        w->out_len = 0;
+        w->out_off = 0;
+        update(at, fd);
+        if (w->closing)
+                finish_close(at, fd);
+}
+
+static void handle(Node* at, int fd, unsigned int events)
+{
+        if (fd >= cap_watches)
+                return;
+        if ((events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && watches[fd].on_read)
+                do_read(at, fd);
+        if (stopped || fd >= cap_watches)
+                return;
+        if ((events & (EPOLLOUT | EPOLLERR)) && watches[fd].out_off < watches[fd].out_len)
+                do_write(at, fd);
+}
+
+/* the soonest timer, ties go to the one set first */
+static int next_timer(void)
+{
+        int best = -1;
+        int i;
+
+        for (i = 0; i < n_timers; i++) {
+                if (best < 0 || timers[i].due < timers[best].due
+                    || (timers[i].due == timers[best].due && timers[i].id < timers[best].id))
+                        best = i;
+        }
+        return best;
+}
+
+/* timers due by now. every timers move past now, so this ends */
+static void run_timers(Node* at)
+{
+        long now = now_ms();
+        int i;
+
+        while (!stopped && (i = next_timer()) >= 0 && timers[i].due <= now) {
+                Timer t = timers[i];
+                Var arg;
+
+                if (t.every) {
+                        timers[i].due += t.every;
+                        /* a slow tick drops the ticks it missed */
+                        if (timers[i].due <= now)
+                                timers[i].due = now + t.every;
+                }
+                else {
+                        timers[i] = timers[--n_timers];
+                }
+
+                set_int(&arg, t.id);
+                (void) call_function(at, t.func, &arg, (int) CHILD(t.func, 0)->n_children);
+        }
+}
+
+/* until stop_loop, or nothing is left to wait for */
+void loop_run(Node* at)
+{
+        struct epoll_event events[LOOP_EVENTS];
+
+        if (running)
+                die(at, "run_loop: already running");
+        running = 1;
+        stopped = 0;
+
+        while (!stopped && (n_active > 0 || n_timers > 0)) {
+                int timeout = -1;
+                int n = 0;
+                int i;
+
+                if (n_files > 0) {
+                        timeout = 0;
+                }
+                else if (n_timers > 0) {
+                        long wait = timers[next_timer()].due - now_ms();
+                        timeout = wait < 0 ? 0 : wait > INT_MAX ? INT_MAX : (int) wait;
+                }
+
+                open_epoll(at);
+                /* what the callbacks printed shows while it waits */
+                if (timeout != 0)
+                        out_flush();
+                n = epoll_wait(ep, events, LOOP_EVENTS, timeout);
+                if (n < 0 && errno != EINTR)
+                        die(at, "event loop: %s", strerror(errno));
+
+                for (i = 0; i < n && !stopped; i++)
+                        handle(at, events[i].data.fd, events[i].events);
+
+                for (i = 0; i < cap_watches && n_files > 0 && !stopped; i++) {
+                        if (watches[i].is_file && watches[i].events)
+                                handle(at, i, (unsigned int) watches[i].events);
+                }
+
+                run_timers(at);
+        }
+        running = 0;
+}
@@ -5,51 +5,148 @@
 #include "gc_tri.h"
 #include "env.h"
 #include "builtin.h"
+#include "heapdump.h"
+#include "cache.h"
+#include "snapshot.h"
+#include "profile.h"
+#include "counters.h"
+#include "allocprof.h"
+#include "output.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 
 extern int yyparse(void);
 int yylex_destroy(void);
-extern FILE* yyin;
-extern Node* root;
+extern ParseNode* root;
 
 extern int yylineno;
 extern int yycolumn;
 
 
+static void print_gc_stats_at_exit(void)
+{
+        gc_print_stats();
+}
+
+static void usage(void)
+{
+        fprintf(stderr, "usage: puer [--no-cache] [--count] [--profile=out.folded]\n"
+                        "            [--alloc-profile[=N]] [--unbuffered] file.puer\n"
+                        "       puer --restore image\n");
+}
+
 int main(int argc, char** argv)
 {
-        if (argc > 1)
-                yyin = fopen(argv[1], "r");
-        if (!yyin) {
-                /* yyin = stdin; */
-                fprintf(stderr, "Error: could not open input file \n");
-                return 1;
+        Node* program = NULL;
+        const char* path = NULL;
+        const char* image = NULL;
+        const char* profile = NULL;
+        unsigned int start = 0;
+        int use_cache = 1;
+        int count = 0;
+        int alloc_every = 0;
+        int unbuffered = 0;
+        int i;
+        const char* gc_stats_env = getenv("PUER_GC_STATS");
+        const char* gc_compact_env = getenv("PUER_GC_COMPACT");
+
+        for (i = 1; i < argc; i++) {
+                if (strcmp(argv[i], "--no-cache") == 0) {
+                        use_cache = 0;
+                }
+                else if (strcmp(argv[i], "--count") == 0) {
+                        count = 1;
+                }
+                else if (strcmp(argv[i], "--alloc-profile") == 0) {
+                        alloc_every = 1;
+                }
+                else if (strncmp(argv[i], "--alloc-profile=", 16) == 0 && atoi(argv[i] + 16) > 0) {
+                        alloc_every = atoi(argv[i] + 16);
+                }
+                else if (strncmp(argv[i], "--profile=", 10) == 0 && argv[i][10]) {
+                        profile = argv[i] + 10;
+                }
+                else if (strcmp(argv[i], "--unbuffered") == 0) {
+                        unbuffered = 1;
+                }
+                else if (strcmp(argv[i], "--restore") == 0 && i + 1 < argc) {
+                        image = argv[++i];
+                }
+                else if (argv[i][0] == '-' && argv[i][1] == '-') {
+                        usage();
+                        return 1;
+                }
+                else {
+                        path = argv[i];
+                }
         }
 
-        yylineno = 1;
-        yycolumn = 1;
+        if (path && use_cache && !image)
+                program = cache_load(path);
 
-        if (!yyparse()) {
-                /*print_ast(root, 0);*/
+        if (!program && !image) {
+                if (!path || lex_open(path) != 0) {
+                        fprintf(stderr, "Error: could not open input file \n");
+                        return 1;
+                }
+
+                yylineno = 1;
+                yycolumn = 1;
+
+                init_puerlib_recnames();
+
+                if (yyparse()) {
+                        lex_close();
+                        yylex_destroy();
+                        return 0;
+                }
+                program = ast_flatten(root);
+                root = NULL;
+                /*print_ast(program, 0);*/
                 recname_clear();
+                lex_close();
+                yylex_destroy();
 
-                init_handlers();
-                gc_init();
-                init_puerlib();
-                eval(root);
+                if (use_cache)
+                        cache_store();
+        }
 
-                /* cleanup */
-                free_ast(root);
-                env_clear();
-                builtin_clear();
-                func_clear();
-                recdef_clear();
+        if (gc_stats_env && strcmp(gc_stats_env, "1") == 0)
+                atexit(print_gc_stats_at_exit);
 
-                gc_collect_full();
+        init_handlers();
+        out_init(unbuffered);
+        gc_init();
+        if (gc_compact_env && strcmp(gc_compact_env, "1") == 0)
+                gc_set_compaction(1);
+        init_puerlib();
+        if (image)
+                program = snapshot_restore(image, &start);
+        heap_dump_install_signal();
+        if (profile && prof_start(profile) != 0) {
+                fprintf(stderr, "Error: could not start the profiler\n");
+                return 1;
         }
-        fclose(yyin);
-        yylex_destroy();
+        if (count)
+                counters_start();
+        if (alloc_every)
+                allocprof_start((unsigned int) alloc_every);
+        eval_program(program, start);
+        prof_stop();
+        counters_report();
+        allocprof_report();
+
+        /* cleanup */
+        free_ast(program);
+        env_clear();
+        builtin_clear();
+        func_clear();
+        recdef_clear();
+
+        gc_collect_full();
+        sym_clear();
 
         return 0;
 }
@@ -0,0 +1,153 @@
+#include "output.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+typedef enum OutMode {
+        OUT_FULL,               /* written when the buffer fills */
+        OUT_LINE,               /* and at the end of every println */
+        OUT_UNBUFFERED          /* and at the end of every print */
+} OutMode;
+
+static char buf[OUT_BUF_SIZE];
+static size_t len = 0;
+static OutMode mode = OUT_FULL;
+
+static void write_all(const char* p, size_t n)
+{
+        while (n > 0) {
+                ssize_t got = write(STDOUT_FILENO, p, n);
+                if (got < 0 && errno == EINTR)
+                        continue;
+                /* like stdio, output that can't be written is dropped */
+                if (got <= 0)
+                        return;
+                p += got;
+                n -= (size_t) got;
+        }
+}
+
+void out_init(int unbuffered)
+{
+        if (unbuffered)
+                mode = OUT_UNBUFFERED;
+        else if (isatty(STDOUT_FILENO))
+                mode = OUT_LINE;
+        atexit(out_flush);
+}
+
+/* also flushes stdio, for the few writers still using it */
+void out_flush(void)
+{
+        size_t n = len;
+
+        len = 0;
+        write_all(buf, n);
+        fflush(stdout);
+}
+
+void out_write(const char* p, size_t n)
+{
+        if (n > OUT_BUF_SIZE - len) {
+                out_flush();
+                if (n >= OUT_BUF_SIZE) {
+                        write_all(p, n);
+                        return;
+                }
+        }
+        memcpy(buf + len, p, n);
+        len += n;
+}
+
+void out_str(const char* s)
+{
+        out_write(s, strlen(s));
+}
+
+void out_char(char c)
+{
+        if (len == OUT_BUF_SIZE)
+                out_flush();
+        buf[len++] = c;
+}
+
+void out_ulong(unsigned long v)
+{
+        char tmp[24];
+        char* p = tmp + sizeof(tmp);
+
+        do {
+                *--p = (char) ('0' + v % 10);
+                v /= 10;
+        } while (v);
+        out_write(p, (size_t) (tmp + sizeof(tmp) - p));
+}
+
+void out_long(long v)
+{
+        if (v < 0) {
+                out_char('-');
+                out_ulong(0UL - (unsigned long) v);
+        }
+        else {
+                out_ulong((unsigned long) v);
+        }
+}
+
+/*
+ * the same text as printf("%f"). the whole part and the fraction are
+ * exact, scaling the fraction by 1e6 is off by far less than 1e-6, so
+ * rounding it gives printf's digits unless it is that close to a half.
+ * those, and values too big, NaN and infinity, go through printf.
+ */
+void out_double(double v)
+{
+        double a = v < 0 ? -v : v;
+        unsigned long whole;
+        unsigned long frac;
+        double scaled;
+        double rest;
+        char tmp[8];
+        char big[512];
+        int i;
+
+        if (a < 1e15) {
+                whole = (unsigned long) a;
+                scaled = (a - (double) whole) * 1e6;
+                frac = (unsigned long) scaled;
+                rest = scaled - (double) frac;
+
+                if (rest < 0.5 - 1e-6 || rest > 0.5 + 1e-6) {
+                        if (rest > 0.5 && ++frac == 1000000) {
+                                frac = 0;
+                                whole++;
+                        }
+                        /* -0.0 has to print its sign too */
+                        if (v < 0 || (v == 0 && 1 / v < 0))
+                                out_char('-');
+                        out_ulong(whole);
+                        tmp[0] = '.';
+                        for (i = 6; i > 0; i--) {
+                                tmp[i] = (char) ('0' + frac % 10);
+                                frac /= 10;
+                        }
+                        out_write(tmp, 7);
+                        return;
+                }
+        }
+
+        sprintf(big, "%f", v);
+        out_str(big);
+}
+
+/* the end of a print or println statement */
+void out_end(int newline)
+{
+        if (newline)
+                out_char('\n');
+        if (mode == OUT_UNBUFFERED || (newline && mode == OUT_LINE))
+                out_flush();
+}
@@ -0,0 +1,336 @@
+#include "parfor.h"
+#include "env.h"
+#include "arraylist.h"
+#include "rec.h"
+#include "gc_tri.h"
+#include "pool.h"
+#include "util.h"
+#include "output.h"
+#include "file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define PARFOR_MAX_WORKERS POOL_MAX_THREADS
+#define LOG_FLUSH 1024
+
+/* a store a worker made into an object from before the loop */
+typedef struct ParforStore {
+        void* obj;              /* ArrayList* or RecInst* */
+        int is_rec;
+        unsigned int idx;
+        unsigned int iter;      /* i - start of the storing iteration */
+        unsigned int seq;       /* order of the stores within a worker */
+        Var val;
+} ParforStore;
+
+typedef struct Worker {
+        pid_t pid;
+        int fd;
+        char* buf;
+        size_t len;
+        size_t cap;
+} Worker;
+
+int parfor_worker = 0;
+
+/* worker state */
+static unsigned int worker_epoch;
+static unsigned int cur_iter;
+static unsigned int log_seq;
+static int log_fd = -1;
+static ParforStore log_buf[LOG_FLUSH];
+static unsigned int n_log;
+
+static void write_all(int fd, const char* p, size_t n)
+{
+        while (n > 0) {
+                ssize_t got = write(fd, p, n);
+                if (got < 0 && errno == EINTR)
+                        continue;
+                if (got <= 0)
+                        _exit(1);
+                p += got;
+                n -= (size_t) got;
+        }
+}
+
+static void flush_log(void)
+{
+        write_all(log_fd, (const char*) log_buf, sizeof(ParforStore) * n_log);
+        n_log = 0;
+}
+
+static int is_scalar(VarType type)
+{
+        return type <= TYPE_BOOL || type == TYPE_CHAR;
+}
+
+/* objects allocated by this worker are private to it */
+static int is_private(const void* obj)
+{
+        return gc_epoch_of(obj) >= worker_epoch;
+}
+
+void parfor_store(Node* at, void* obj, int is_rec, unsigned int idx, Var val)
+{
+        ParforStore* s;
+
+        if (is_private(obj))
+                return;
+        if (!is_scalar(val.type))
+                die(at, "parfor: only scalar values can be stored into %s from before the loop",
+                    is_rec ? "records" : "arrays");
+
+        s = &log_buf[n_log++];
+        s->obj = obj;
+        s->is_rec = is_rec;
+        s->idx = idx;
+        s->iter = cur_iter;
+        s->seq = log_seq++;
+        s->val = val;
+        if (n_log == LOG_FLUSH)
+                flush_log();
+}
+
+/* for changes that can't be logged, appending, resizing, string and dict stores */
+void parfor_check_owned(Node* at, const void* obj, const char* what)
+{
+        if (!is_private(obj))
+                die(at, "parfor: cannot %s from before the loop", what);
+}
+
+void parfor_check_var(Node* at, Symbol name)
+{
+        VarEntry* e = env_get_entry(name);
+
+        if (!e)
+                return;
+        if (e->is_ptr)
+                die(at, "parfor: cannot assign reference parameter '%s' in a parfor", sym_name(name));
+        if (!is_private(e))
+                die(at, "parfor: cannot assign '%s', it is declared outside the loop", sym_name(name));
+}
+
+static void run_worker(Node* node, int start, int lo, int hi, ParforBody body, int fd)
+{
+        int i;
+
+        parfor_worker = 1;
+        log_fd = fd;
+        worker_epoch = gc_next_epoch();
+        for (i = lo; i < hi; i++) {
+                cur_iter = (unsigned int) ((long) i - start);
+                body(node, i);
+        }
+        flush_log();
+        out_flush();
+        file_flush_all();
+        _exit(0);
+}
+
+static void kill_workers(Worker* w, int n)
+{
+        int k;
+        for (k = 0; k < n; k++) {
+                kill(w[k].pid, SIGKILL);
+                waitpid(w[k].pid, NULL, 0);
+        }
+}
+
+/* reads every worker's log until all of them close their pipe */
+static void drain(Worker* w, int n)
+{
+        struct pollfd fds[PARFOR_MAX_WORKERS];
+        int open = n;
+        int k;
+
+        while (open > 0) {
+                int m = 0;
+                for (k = 0; k < n; k++) {
+                        if (w[k].fd < 0)
+                                continue;
+                        fds[m].fd = w[k].fd;
+                        fds[m].events = POLLIN;
+                        fds[m].revents = 0;
+                        m++;
+                }
+                if (poll(fds, (nfds_t) m, -1) < 0) {
+                        if (errno == EINTR)
+                                continue;
+                        die(NULL, "parfor: poll failed");
+                }
+
+                for (k = 0; k < n; k++) {
+                        ssize_t got;
+                        int j;
+
+                        if (w[k].fd < 0)
+                                continue;
+                        for (j = 0; j < m && fds[j].fd != w[k].fd; j++)
+                                ;
+                        if (j == m || !fds[j].revents)
+                                continue;
+
+                        if (w[k].cap - w[k].len < 65536) {
+                                w[k].cap = w[k].cap ? w[k].cap * 2 : 131072;
+                                w[k].buf = realloc(w[k].buf, w[k].cap);
+                                if (!w[k].buf)
+                                        die(NULL, "Out of Memory Error");
+                        }
+                        got = read(w[k].fd, w[k].buf + w[k].len, w[k].cap - w[k].len);
+                        if (got < 0 && errno == EINTR)
+                                continue;
+                        if (got <= 0) {
+                                close(w[k].fd);
+                                w[k].fd = -1;
+                                open--;
+                                continue;
+                        }
+                        w[k].len += (size_t) got;
+                }
+        }
+}
+
+static int by_slot(const void* a, const void* b)
+{
+        const ParforStore* x = a;
+        const ParforStore* y = b;
+        unsigned long px = (unsigned long) x->obj;
+        unsigned long py = (unsigned long) y->obj;
+
+        if (px != py)
+                return px < py ? -1 : 1;
+        if (x->is_rec != y->is_rec)
+                return x->is_rec - y->is_rec;
+        if (x->idx != y->idx)
+                return x->idx < y->idx ? -1 : 1;
+        if (x->iter != y->iter)
+                return x->iter < y->iter ? -1 : 1;
+        return (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+static int same_slot(const ParforStore* a, const ParforStore* b)
+{
+        return a->obj == b->obj && a->is_rec == b->is_rec && a->idx == b->idx;
+}
+
+/* the last store to each slot wins, as long as one iteration made them all */
+static void apply_stores(Node* node, int start, Worker* w, int n)
+{
+        ParforStore* log;
+        size_t total = 0;
+        size_t i;
+        size_t j;
+        int k;
+
+        for (k = 0; k < n; k++)
+                total += w[k].len;
+        if (!total)
+                return;
+
+        log = malloc(total);
+        if (!log)
+                die(NULL, "Out of Memory Error");
+        total = 0;
+        for (k = 0; k < n; k++) {
+                memcpy((char*) log + total, w[k].buf, w[k].len);
+                total += w[k].len;
+        }
+        total /= sizeof(ParforStore);
+        qsort(log, total, sizeof(ParforStore), by_slot);
+
+        for (i = 0; i < total; i = j) {
+                for (j = i + 1; j < total && same_slot(&log[i], &log[j]); j++) {
+                        if (log[j].iter != log[i].iter) {
+                                die(node, "parfor: iterations %ld and %ld store to the same %s",
+                                    (long) start + log[i].iter, (long) start + log[j].iter,
+                                    log[i].is_rec ? "record field" : "array element");
+                        }
+                }
+                if (log[j - 1].is_rec)
+                        ((RecInst*) log[j - 1].obj)->fields[log[j - 1].idx] = log[j - 1].val;
+                else
+                        ((ArrayList*) log[j - 1].obj)->items[log[j - 1].idx] = log[j - 1].val;
+        }
+        free(log);
+}
+
+void parfor_run(Node* node, int start, int end, ParforBody body)
+{
+        Worker w[PARFOR_MAX_WORKERS];
+        long n = (long) end - start;
+        int n_workers;
+        int failed = 0;
+        int k;
+        int i;
+
+        if (n <= 0)
+                return;
+
+        /* the outer parfor already runs in parallel */
+        if (parfor_worker) {
+                for (i = start; i < end; i++)
+                        body(node, i);
+                return;
+        }
+
+        n_workers = pool_threads();
+        if (n_workers > n)
+                n_workers = (int) n;
+
+        /* buffered output would be written by every worker */
+        out_flush();
+        file_flush_all();
+        fflush(stderr);
+
+        for (k = 0; k < n_workers; k++) {
+                int lo = (int) (start + n * k / n_workers);
+                int hi = (int) (start + n * (k + 1) / n_workers);
+                int fds[2];
+
+                if (pipe(fds) != 0) {
+                        kill_workers(w, k);
+                        die(node, "parfor: pipe failed");
+                }
+                w[k].pid = fork();
+                if (w[k].pid < 0) {
+                        kill_workers(w, k);
+                        die(node, "parfor: fork failed");
+                }
+                if (w[k].pid == 0) {
+                        for (i = 0; i < k; i++)
+                                close(w[i].fd);
+                        close(fds[0]);
+                        run_worker(node, start, lo, hi, body, fds[1]);
+                }
+                close(fds[1]);
+                w[k].fd = fds[0];
+                w[k].buf = NULL;
+                w[k].len = 0;
+                w[k].cap = 0;
+        }
+
+        drain(w, n_workers);
+        for (k = 0; k < n_workers; k++) {
+                pid_t got;
+                int status;
+                while ((got = waitpid(w[k].pid, &status, 0)) < 0 && errno == EINTR)
+                        ;
+                if (got != w[k].pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                        failed = 1;
+        }
+        if (failed)
+                die(node, "parfor: a worker failed");
+
+        apply_stores(node, start, w, n_workers);
+        for (k = 0; k < n_workers; k++)
+                free(w[k].buf);
+}
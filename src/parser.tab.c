@@ -0,0 +1,2551 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 0
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 15 "src/parser.y"
+
+#include <stdio.h>
+#include "ast.h"
+#include "dict.h"
+#include "task.h"
+#include "gen.h"
+
+/* externs */
+extern int yylex();
+extern int yyparse();
+extern FILE* yyin;
+
+/* prototypes */
+void yyerror(const char* s);
+
+
+/* globals */
+/* root of ast (abstract syntax tree) */
+ParseNode* root;
+Symbol g_recname = SYM_NONE;
+
+#line 93 "src/parser.tab.c"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+#include "parser.tab.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_RET = 3,                        /* RET  */
+  YYSYMBOL_MOD = 4,                        /* MOD  */
+  YYSYMBOL_UMINUS = 5,                     /* UMINUS  */
+  YYSYMBOL_POSTFIX = 6,                    /* POSTFIX  */
+  YYSYMBOL_7_ = 7,                         /* '.'  */
+  YYSYMBOL_IFX = 8,                        /* IFX  */
+  YYSYMBOL_NUM = 9,                        /* NUM  */
+  YYSYMBOL_TRUE = 10,                      /* TRUE  */
+  YYSYMBOL_FALSE = 11,                     /* FALSE  */
+  YYSYMBOL_FLOAT = 12,                     /* FLOAT  */
+  YYSYMBOL_TYPE = 13,                      /* TYPE  */
+  YYSYMBOL_IDENT = 14,                     /* IDENT  */
+  YYSYMBOL_STRING = 15,                    /* STRING  */
+  YYSYMBOL_CHAR = 16,                      /* CHAR  */
+  YYSYMBOL_17_ = 17,                       /* '='  */
+  YYSYMBOL_18_ = 18,                       /* ';'  */
+  YYSYMBOL_19_ = 19,                       /* '('  */
+  YYSYMBOL_20_ = 20,                       /* ')'  */
+  YYSYMBOL_21_ = 21,                       /* '{'  */
+  YYSYMBOL_22_ = 22,                       /* '}'  */
+  YYSYMBOL_23_ = 23,                       /* '['  */
+  YYSYMBOL_24_ = 24,                       /* ']'  */
+  YYSYMBOL_ADD = 25,                       /* ADD  */
+  YYSYMBOL_SUB = 26,                       /* SUB  */
+  YYSYMBOL_MUL = 27,                       /* MUL  */
+  YYSYMBOL_DIV = 28,                       /* DIV  */
+  YYSYMBOL_ADD_ASSIGN = 29,                /* ADD_ASSIGN  */
+  YYSYMBOL_SUB_ASSIGN = 30,                /* SUB_ASSIGN  */
+  YYSYMBOL_MUL_ASSIGN = 31,                /* MUL_ASSIGN  */
+  YYSYMBOL_DIV_ASSIGN = 32,                /* DIV_ASSIGN  */
+  YYSYMBOL_MOD_ASSIGN = 33,                /* MOD_ASSIGN  */
+  YYSYMBOL_LT = 34,                        /* LT  */
+  YYSYMBOL_GT = 35,                        /* GT  */
+  YYSYMBOL_LE = 36,                        /* LE  */
+  YYSYMBOL_GE = 37,                        /* GE  */
+  YYSYMBOL_EQ = 38,                        /* EQ  */
+  YYSYMBOL_NE = 39,                        /* NE  */
+  YYSYMBOL_NOT = 40,                       /* NOT  */
+  YYSYMBOL_AND = 41,                       /* AND  */
+  YYSYMBOL_OR = 42,                        /* OR  */
+  YYSYMBOL_INC = 43,                       /* INC  */
+  YYSYMBOL_DEC = 44,                       /* DEC  */
+  YYSYMBOL_IF = 45,                        /* IF  */
+  YYSYMBOL_ELSE = 46,                      /* ELSE  */
+  YYSYMBOL_FOR = 47,                       /* FOR  */
+  YYSYMBOL_WHILE = 48,                     /* WHILE  */
+  YYSYMBOL_PARFOR = 49,                    /* PARFOR  */
+  YYSYMBOL_SPAWN = 50,                     /* SPAWN  */
+  YYSYMBOL_BREAK = 51,                     /* BREAK  */
+  YYSYMBOL_CONTINUE = 52,                  /* CONTINUE  */
+  YYSYMBOL_DEF = 53,                       /* DEF  */
+  YYSYMBOL_RETURN = 54,                    /* RETURN  */
+  YYSYMBOL_YIELD = 55,                     /* YIELD  */
+  YYSYMBOL_ARROW = 56,                     /* ARROW  */
+  YYSYMBOL_57_ = 57,                       /* ','  */
+  YYSYMBOL_REC = 58,                       /* REC  */
+  YYSYMBOL_DICT = 59,                      /* DICT  */
+  YYSYMBOL_CHAN = 60,                      /* CHAN  */
+  YYSYMBOL_PRINT = 61,                     /* PRINT  */
+  YYSYMBOL_PRINTLN = 62,                   /* PRINTLN  */
+  YYSYMBOL_YYACCEPT = 63,                  /* $accept  */
+  YYSYMBOL_puer = 64,                      /* puer  */
+  YYSYMBOL_top_code = 65,                  /* top_code  */
+  YYSYMBOL_top_stmt_end = 66,              /* top_stmt_end  */
+  YYSYMBOL_block = 67,                     /* block  */
+  YYSYMBOL_code = 68,                      /* code  */
+  YYSYMBOL_stmt_end = 69,                  /* stmt_end  */
+  YYSYMBOL_stmt = 70,                      /* stmt  */
+  YYSYMBOL_expr = 71,                      /* expr  */
+  YYSYMBOL_vardecl = 72,                   /* vardecl  */
+  YYSYMBOL_dict_type = 73,                 /* dict_type  */
+  YYSYMBOL_chan_type = 74,                 /* chan_type  */
+  YYSYMBOL_gen_type = 75,                  /* gen_type  */
+  YYSYMBOL_rec_def = 76,                   /* rec_def  */
+  YYSYMBOL_rec_field_list = 77,            /* rec_field_list  */
+  YYSYMBOL_rec_field = 78,                 /* rec_field  */
+  YYSYMBOL_function_def = 79,              /* function_def  */
+  YYSYMBOL_param_list = 80,                /* param_list  */
+  YYSYMBOL_param = 81,                     /* param  */
+  YYSYMBOL_opt_return = 82,                /* opt_return  */
+  YYSYMBOL_arg_list = 83,                  /* arg_list  */
+  YYSYMBOL_control_stmt = 84,              /* control_stmt  */
+  YYSYMBOL_opt_stmt = 85,                  /* opt_stmt  */
+  YYSYMBOL_opt_expr = 86,                  /* opt_expr  */
+  YYSYMBOL_opt_init = 87,                  /* opt_init  */
+  YYSYMBOL_dims = 88,                      /* dims  */
+  YYSYMBOL_varassign = 89,                 /* varassign  */
+  YYSYMBOL_array_items = 90                /* array_items  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL \
+             && defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+  YYLTYPE yyls_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE) \
+             + YYSIZEOF (YYLTYPE)) \
+      + 2 * YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  3
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   998
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  63
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  28
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  112
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  233
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   307
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+      19,    20,     2,     2,    57,     2,     7,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,    18,
+       2,    17,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,    23,     2,    24,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,    21,     2,    22,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     8,     9,    10,    11,    12,    13,    14,    15,
+      16,    25,    26,    27,    28,    29,    30,    31,    32,    33,
+      34,    35,    36,    37,    38,    39,    40,    41,    42,    43,
+      44,    45,    46,    47,    48,    49,    50,    51,    52,    53,
+      54,    55,    56,    58,    59,    60,    61,    62
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
+{
+       0,   102,   102,   106,   107,   111,   112,   113,   117,   121,
+     122,   126,   127,   128,   132,   133,   134,   135,   136,   137,
+     138,   139,   140,   144,   145,   146,   147,   148,   149,   150,
+     151,   152,   153,   154,   155,   156,   157,   158,   159,   160,
+     161,   162,   164,   165,   167,   168,   169,   170,   171,   173,
+     174,   175,   176,   178,   179,   180,   181,   182,   184,   185,
+     186,   187,   191,   197,   203,   204,   205,   209,   221,   233,
+     245,   253,   254,   258,   262,   263,   272,   273,   274,   278,
+     279,   280,   281,   282,   286,   287,   288,   289,   290,   294,
+     295,   296,   300,   301,   302,   303,   304,   313,   325,   326,
+     331,   332,   336,   337,   341,   342,   343,   344,   348,   349,
+     350,   354,   355
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "RET", "MOD", "UMINUS",
+  "POSTFIX", "'.'", "IFX", "NUM", "TRUE", "FALSE", "FLOAT", "TYPE",
+  "IDENT", "STRING", "CHAR", "'='", "';'", "'('", "')'", "'{'", "'}'",
+  "'['", "']'", "ADD", "SUB", "MUL", "DIV", "ADD_ASSIGN", "SUB_ASSIGN",
+  "MUL_ASSIGN", "DIV_ASSIGN", "MOD_ASSIGN", "LT", "GT", "LE", "GE", "EQ",
+  "NE", "NOT", "AND", "OR", "INC", "DEC", "IF", "ELSE", "FOR", "WHILE",
+  "PARFOR", "SPAWN", "BREAK", "CONTINUE", "DEF", "RETURN", "YIELD",
+  "ARROW", "','", "REC", "DICT", "CHAN", "PRINT", "PRINTLN", "$accept",
+  "puer", "top_code", "top_stmt_end", "block", "code", "stmt_end", "stmt",
+  "expr", "vardecl", "dict_type", "chan_type", "gen_type", "rec_def",
+  "rec_field_list", "rec_field", "function_def", "param_list", "param",
+  "opt_return", "arg_list", "control_stmt", "opt_stmt", "opt_expr",
+  "opt_init", "dims", "varassign", "array_items", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-182)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-1)
+
+#define yytable_value_is_error(Yyn) \
+  ((Yyn) == YYTABLE_NINF)
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
+{
+    -182,    29,   146,  -182,  -182,  -182,  -182,  -182,     8,    11,
+    -182,  -182,   457,  -182,   391,   457,   457,   457,   457,     1,
+      23,    26,    32,    51,  -182,  -182,    72,   457,   457,    73,
+      76,    78,    88,    94,  -182,  -182,  -182,    92,   813,  -182,
+     117,   125,   127,  -182,  -182,  -182,  -182,   130,   413,  -182,
+      18,   457,   457,    91,   206,  -182,   813,    -3,     4,     4,
+       4,     4,   457,   314,   457,   131,   132,   133,   813,   813,
+     129,   150,   153,   457,   457,  -182,   457,   154,   457,   457,
+     457,   457,   457,   457,   457,   457,   457,   457,   457,   457,
+     457,   457,   457,   457,   457,   457,  -182,  -182,   130,   130,
+     130,   457,  -182,  -182,   485,   130,   435,   813,   813,    -8,
+    -182,  -182,  -182,  -182,   457,   526,    89,  -182,   152,   567,
+     157,   457,    33,  -182,   118,   155,    -2,    -1,     4,   159,
+     608,   954,   954,     4,     4,   813,   813,   813,   813,   813,
+     929,   929,   929,   929,   879,   879,   904,   854,  -182,  -182,
+    -182,   813,  -182,  -182,  -182,   649,  -182,   457,   813,   260,
+     457,   457,   260,   160,     3,    10,   164,   166,   167,     6,
+    -182,    31,   169,  -182,  -182,  -182,   457,   168,  -182,   813,
+     137,   690,   813,   170,  -182,   457,  -182,  -182,    20,  -182,
+    -182,  -182,   136,    33,   184,   185,  -182,   186,   813,   457,
+     260,   260,   337,   731,  -182,    45,   188,  -182,  -182,  -182,
+    -182,   813,  -182,  -182,   191,   198,   119,  -182,  -182,   188,
+    -182,   260,   179,   200,  -182,  -182,   457,   772,   210,   183,
+     211,   260,  -182
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       3,     0,     2,     1,    23,    24,    25,    26,     0,    27,
+      28,    29,     0,     9,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,    16,    17,     0,    19,     0,     0,
+       0,     0,     0,     0,     4,    13,     7,     0,    22,    21,
+       0,     0,     0,     6,     5,    12,    61,   102,     0,    69,
+       0,     0,    89,     0,     0,    59,   111,     0,    52,    51,
+      49,    50,     0,    98,     0,     0,     0,     0,    18,    20,
+       0,     0,     0,    89,    89,    11,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,    44,    45,   102,   102,
+     102,     0,    63,   104,     0,   102,     0,   108,    90,     0,
+      58,     8,    10,    60,     0,     0,    27,    99,     0,     0,
+       0,    89,    76,    71,     0,     0,     0,     0,    41,    30,
+       0,    37,    38,    39,    40,    53,    54,    55,    56,    57,
+      31,    32,    33,    34,    35,    36,    42,    43,    64,    65,
+      66,   103,   106,    62,   105,     0,    46,     0,   112,     0,
+       0,   100,     0,     0,     0,     0,     0,     0,     0,     0,
+      77,     0,     0,    68,    14,    15,     0,    48,   107,    91,
+      92,     0,   101,     0,    95,     0,    47,    79,     0,    81,
+      82,    83,    84,     0,     0,     0,    72,     0,   110,     0,
+       0,     0,    98,     0,    80,     0,     0,    78,    70,    73,
+      67,   109,    93,    96,     0,     0,    85,    87,    88,     0,
+      74,     0,     0,    86,    75,    94,     0,     0,     0,     0,
+       0,     0,    97
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int16 yypgoto[] =
+{
+    -182,  -182,  -182,  -182,  -181,  -182,   -47,   -62,   -12,    59,
+    -109,  -108,  -105,  -182,  -182,  -182,  -182,  -182,    40,  -182,
+     -64,  -182,    34,  -182,    38,  -157,  -182,  -182
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
+{
+       0,     1,     2,    34,    35,    54,    36,    37,    38,    39,
+      40,    41,    42,    43,   171,   196,    44,   169,   170,   206,
+     109,    45,   118,   183,   102,    50,    46,    57
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int16 yytable[] =
+{
+      53,   117,    56,    58,    59,    60,    61,   112,   188,   126,
+     127,    77,   156,   166,   167,    68,    69,   168,   174,   175,
+      62,   113,    47,   186,   187,   220,   192,    78,    51,     3,
+      52,    48,   105,    48,   204,    49,   104,    49,   224,   107,
+     108,   106,    63,   106,     8,    64,   165,    96,    97,   157,
+     115,    65,   119,   194,   114,   157,   157,   164,   216,   223,
+     157,   108,   108,   193,   128,    66,   130,   131,   132,   133,
+     134,   135,   136,   137,   138,   139,   140,   141,   142,   143,
+     144,   145,   146,   147,   166,   167,    67,    70,   168,   151,
+      30,    31,    30,    31,   155,    76,   217,   218,    77,    71,
+     219,    72,   158,   160,    30,    31,    51,    73,    52,   108,
+      75,   110,   180,    74,    78,   184,    79,    80,    81,    82,
+      83,    84,    85,    86,    87,    88,    89,    90,    91,    92,
+      93,    98,    94,    95,    96,    97,   148,   149,   150,    99,
+     117,   100,    48,   153,   120,   179,    49,   101,   181,   182,
+     123,   121,   122,   212,   213,     4,     5,     6,     7,     8,
+       9,    10,    11,   124,   198,    12,   125,    13,   129,    14,
+     161,   163,    15,   203,   225,   172,   176,   185,   189,   173,
+     190,   191,   197,   200,   232,   199,    16,   211,   202,    17,
+      18,    19,   205,    20,    21,    22,    23,    24,    25,    26,
+      27,    28,   208,   209,    29,    30,    31,    32,    33,    13,
+     210,   221,   222,   226,   227,     4,     5,     6,     7,     8,
+       9,    10,    11,   106,   229,    12,   230,    13,   111,    14,
+     195,   231,    15,   207,     0,     0,   214,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,    16,     0,     0,    17,
+      18,    19,     0,    20,    21,    22,    23,    24,    25,     0,
+      27,    28,     0,     0,     0,    30,    31,    32,    33,     4,
+       5,     6,     7,     8,     9,    10,    11,     0,     0,    12,
+       0,    13,     0,    14,     0,     0,    15,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+      16,     0,     0,    17,    18,    19,     0,    20,    21,    22,
+      23,    24,    25,     0,    27,    28,     0,     0,     0,    30,
+      31,    32,    33,     4,     5,     6,     7,     8,   116,    10,
+      11,     0,     0,    12,     0,     0,     0,    14,     0,     0,
+      15,     0,     0,     0,     0,     0,     4,     5,     6,     7,
+       8,     9,    10,    11,    16,     0,    12,    17,    18,     0,
+      14,     0,     0,    15,    23,    24,    25,     0,    27,    28,
+       0,     0,     0,    30,    31,    32,    33,    16,     0,     0,
+      17,    18,     0,     0,     0,     0,     0,    23,    24,    25,
+       0,    27,    28,     0,     0,     0,    30,    31,    32,    33,
+       4,     5,     6,     7,     0,     9,    10,    11,     0,     0,
+      12,     0,     0,     0,    14,    55,     0,    15,     0,     0,
+       0,     0,     4,     5,     6,     7,     0,     9,    10,    11,
+       0,    16,    12,     0,    17,    18,    14,   103,     0,    15,
+       0,    23,     0,     0,     4,     5,     6,     7,     0,     9,
+      10,    11,     0,    16,    12,     0,    17,    18,    14,   154,
+       0,    15,     0,    23,     0,     0,     4,     5,     6,     7,
+       0,     9,    10,    11,     0,    16,    12,     0,    17,    18,
+      14,     0,     0,    15,     0,    23,     0,     0,     0,    76,
+       0,     0,    77,     0,     0,     0,     0,    16,     0,     0,
+      17,    18,     0,     0,     0,     0,     0,    23,    78,   152,
+      79,    80,    81,    82,    83,    84,    85,    86,    87,    88,
+      89,    90,    91,    92,    93,     0,    94,    95,    96,    97,
+      76,     0,     0,    77,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,   159,     0,     0,    78,
+       0,    79,    80,    81,    82,    83,    84,    85,    86,    87,
+      88,    89,    90,    91,    92,    93,     0,    94,    95,    96,
+      97,    76,     0,     0,    77,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,   162,     0,     0,
+      78,     0,    79,    80,    81,    82,    83,    84,    85,    86,
+      87,    88,    89,    90,    91,    92,    93,     0,    94,    95,
+      96,    97,    76,     0,     0,    77,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,    78,   177,    79,    80,    81,    82,    83,    84,    85,
+      86,    87,    88,    89,    90,    91,    92,    93,     0,    94,
+      95,    96,    97,    76,     0,     0,    77,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,    78,   178,    79,    80,    81,    82,    83,    84,
+      85,    86,    87,    88,    89,    90,    91,    92,    93,     0,
+      94,    95,    96,    97,    76,     0,     0,    77,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     201,     0,     0,    78,     0,    79,    80,    81,    82,    83,
+      84,    85,    86,    87,    88,    89,    90,    91,    92,    93,
+       0,    94,    95,    96,    97,    76,     0,     0,    77,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,   215,
+       0,     0,     0,     0,    78,     0,    79,    80,    81,    82,
+      83,    84,    85,    86,    87,    88,    89,    90,    91,    92,
+      93,     0,    94,    95,    96,    97,    76,     0,     0,    77,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     228,     0,     0,     0,     0,    78,     0,    79,    80,    81,
+      82,    83,    84,    85,    86,    87,    88,    89,    90,    91,
+      92,    93,     0,    94,    95,    96,    97,    76,     0,     0,
+      77,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,    78,     0,    79,    80,
+      81,    82,    83,    84,    85,    86,    87,    88,    89,    90,
+      91,    92,    93,     0,    94,    95,    96,    97,    76,     0,
+       0,    77,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,    78,     0,    79,
+      80,    81,    82,    76,     0,     0,    77,     0,    88,    89,
+      90,    91,    92,    93,     0,    94,     0,    96,    97,     0,
+       0,     0,    78,     0,    79,    80,    81,    82,    76,     0,
+       0,    77,     0,    88,    89,    90,    91,    -1,    -1,     0,
+       0,     0,    96,    97,     0,     0,     0,    78,     0,    79,
+      80,    81,    82,    76,     0,     0,    77,     0,    88,    89,
+      90,    91,    92,    93,     0,     0,     0,    96,    97,     0,
+       0,     0,    78,     0,    79,    80,    81,    82,    76,     0,
+       0,    77,     0,    -1,    -1,    -1,    -1,     0,     0,     0,
+       0,     0,    96,    97,     0,     0,     0,    78,     0,     0,
+       0,    81,    82,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,    96,    97
+};
+
+static const yytype_int16 yycheck[] =
+{
+      12,    63,    14,    15,    16,    17,    18,    54,   165,    73,
+      74,     7,    20,   122,   122,    27,    28,   122,    20,    20,
+      19,    24,    14,    20,    14,   206,    20,    23,    17,     0,
+      19,    23,    14,    23,    14,    27,    48,    27,   219,    51,
+      52,    23,    19,    23,    13,    19,    13,    43,    44,    57,
+      62,    19,    64,    22,    57,    57,    57,   121,    13,   216,
+      57,    73,    74,    57,    76,    14,    78,    79,    80,    81,
+      82,    83,    84,    85,    86,    87,    88,    89,    90,    91,
+      92,    93,    94,    95,   193,   193,    14,    14,   193,   101,
+      59,    60,    59,    60,   106,     4,   205,   205,     7,    23,
+     205,    23,   114,    14,    59,    60,    17,    19,    19,   121,
+      18,    20,   159,    19,    23,   162,    25,    26,    27,    28,
+      29,    30,    31,    32,    33,    34,    35,    36,    37,    38,
+      39,    14,    41,    42,    43,    44,    98,    99,   100,    14,
+     202,    14,    23,   105,    13,   157,    27,    17,   160,   161,
+      21,    19,    19,   200,   201,     9,    10,    11,    12,    13,
+      14,    15,    16,    13,   176,    19,    13,    21,    14,    23,
+      18,    14,    26,   185,   221,    57,    17,    17,    14,    24,
+      14,    14,    13,    46,   231,    17,    40,   199,    18,    43,
+      44,    45,    56,    47,    48,    49,    50,    51,    52,    53,
+      54,    55,    18,    18,    58,    59,    60,    61,    62,    21,
+      24,    20,    14,    34,   226,     9,    10,    11,    12,    13,
+      14,    15,    16,    23,    14,    19,    43,    21,    22,    23,
+     171,    20,    26,   193,    -1,    -1,   202,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    40,    -1,    -1,    43,
+      44,    45,    -1,    47,    48,    49,    50,    51,    52,    -1,
+      54,    55,    -1,    -1,    -1,    59,    60,    61,    62,     9,
+      10,    11,    12,    13,    14,    15,    16,    -1,    -1,    19,
+      -1,    21,    -1,    23,    -1,    -1,    26,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      40,    -1,    -1,    43,    44,    45,    -1,    47,    48,    49,
+      50,    51,    52,    -1,    54,    55,    -1,    -1,    -1,    59,
+      60,    61,    62,     9,    10,    11,    12,    13,    14,    15,
+      16,    -1,    -1,    19,    -1,    -1,    -1,    23,    -1,    -1,
+      26,    -1,    -1,    -1,    -1,    -1,     9,    10,    11,    12,
+      13,    14,    15,    16,    40,    -1,    19,    43,    44,    -1,
+      23,    -1,    -1,    26,    50,    51,    52,    -1,    54,    55,
+      -1,    -1,    -1,    59,    60,    61,    62,    40,    -1,    -1,
+      43,    44,    -1,    -1,    -1,    -1,    -1,    50,    51,    52,
+      -1,    54,    55,    -1,    -1,    -1,    59,    60,    61,    62,
+       9,    10,    11,    12,    -1,    14,    15,    16,    -1,    -1,
+      19,    -1,    -1,    -1,    23,    24,    -1,    26,    -1,    -1,
+      -1,    -1,     9,    10,    11,    12,    -1,    14,    15,    16,
+      -1,    40,    19,    -1,    43,    44,    23,    24,    -1,    26,
+      -1,    50,    -1,    -1,     9,    10,    11,    12,    -1,    14,
+      15,    16,    -1,    40,    19,    -1,    43,    44,    23,    24,
+      -1,    26,    -1,    50,    -1,    -1,     9,    10,    11,    12,
+      -1,    14,    15,    16,    -1,    40,    19,    -1,    43,    44,
+      23,    -1,    -1,    26,    -1,    50,    -1,    -1,    -1,     4,
+      -1,    -1,     7,    -1,    -1,    -1,    -1,    40,    -1,    -1,
+      43,    44,    -1,    -1,    -1,    -1,    -1,    50,    23,    24,
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      35,    36,    37,    38,    39,    -1,    41,    42,    43,    44,
+       4,    -1,    -1,     7,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    20,    -1,    -1,    23,
+      -1,    25,    26,    27,    28,    29,    30,    31,    32,    33,
+      34,    35,    36,    37,    38,    39,    -1,    41,    42,    43,
+      44,     4,    -1,    -1,     7,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    20,    -1,    -1,
+      23,    -1,    25,    26,    27,    28,    29,    30,    31,    32,
+      33,    34,    35,    36,    37,    38,    39,    -1,    41,    42,
+      43,    44,     4,    -1,    -1,     7,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    23,    24,    25,    26,    27,    28,    29,    30,    31,
+      32,    33,    34,    35,    36,    37,    38,    39,    -1,    41,
+      42,    43,    44,     4,    -1,    -1,     7,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    23,    24,    25,    26,    27,    28,    29,    30,
+      31,    32,    33,    34,    35,    36,    37,    38,    39,    -1,
+      41,    42,    43,    44,     4,    -1,    -1,     7,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      20,    -1,    -1,    23,    -1,    25,    26,    27,    28,    29,
+      30,    31,    32,    33,    34,    35,    36,    37,    38,    39,
+      -1,    41,    42,    43,    44,     4,    -1,    -1,     7,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    18,
+      -1,    -1,    -1,    -1,    23,    -1,    25,    26,    27,    28,
+      29,    30,    31,    32,    33,    34,    35,    36,    37,    38,
+      39,    -1,    41,    42,    43,    44,     4,    -1,    -1,     7,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      18,    -1,    -1,    -1,    -1,    23,    -1,    25,    26,    27,
+      28,    29,    30,    31,    32,    33,    34,    35,    36,    37,
+      38,    39,    -1,    41,    42,    43,    44,     4,    -1,    -1,
+       7,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    23,    -1,    25,    26,
+      27,    28,    29,    30,    31,    32,    33,    34,    35,    36,
+      37,    38,    39,    -1,    41,    42,    43,    44,     4,    -1,
+      -1,     7,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    23,    -1,    25,
+      26,    27,    28,     4,    -1,    -1,     7,    -1,    34,    35,
+      36,    37,    38,    39,    -1,    41,    -1,    43,    44,    -1,
+      -1,    -1,    23,    -1,    25,    26,    27,    28,     4,    -1,
+      -1,     7,    -1,    34,    35,    36,    37,    38,    39,    -1,
+      -1,    -1,    43,    44,    -1,    -1,    -1,    23,    -1,    25,
+      26,    27,    28,     4,    -1,    -1,     7,    -1,    34,    35,
+      36,    37,    38,    39,    -1,    -1,    -1,    43,    44,    -1,
+      -1,    -1,    23,    -1,    25,    26,    27,    28,     4,    -1,
+      -1,     7,    -1,    34,    35,    36,    37,    -1,    -1,    -1,
+      -1,    -1,    43,    44,    -1,    -1,    -1,    23,    -1,    -1,
+      -1,    27,    28,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    43,    44
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
+{
+       0,    64,    65,     0,     9,    10,    11,    12,    13,    14,
+      15,    16,    19,    21,    23,    26,    40,    43,    44,    45,
+      47,    48,    49,    50,    51,    52,    53,    54,    55,    58,
+      59,    60,    61,    62,    66,    67,    69,    70,    71,    72,
+      73,    74,    75,    76,    79,    84,    89,    14,    23,    27,
+      88,    17,    19,    71,    68,    24,    71,    90,    71,    71,
+      71,    71,    19,    19,    19,    19,    14,    14,    71,    71,
+      14,    23,    23,    19,    19,    18,     4,     7,    23,    25,
+      26,    27,    28,    29,    30,    31,    32,    33,    34,    35,
+      36,    37,    38,    39,    41,    42,    43,    44,    14,    14,
+      14,    17,    87,    24,    71,    14,    23,    71,    71,    83,
+      20,    22,    69,    24,    57,    71,    14,    70,    85,    71,
+      13,    19,    19,    21,    13,    13,    83,    83,    71,    14,
+      71,    71,    71,    71,    71,    71,    71,    71,    71,    71,
+      71,    71,    71,    71,    71,    71,    71,    71,    87,    87,
+      87,    71,    24,    87,    24,    71,    20,    57,    71,    20,
+      14,    18,    20,    14,    83,    13,    73,    74,    75,    80,
+      81,    77,    57,    24,    20,    20,    17,    24,    24,    71,
+      69,    71,    71,    86,    69,    17,    20,    14,    88,    14,
+      14,    14,    20,    57,    22,    72,    78,    13,    71,    17,
+      46,    20,    18,    71,    14,    56,    82,    81,    18,    18,
+      24,    71,    69,    69,    85,    18,    13,    73,    74,    75,
+      67,    20,    14,    88,    67,    69,    34,    71,    18,    14,
+      43,    20,    69
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    63,    64,    65,    65,    66,    66,    66,    67,    68,
+      68,    69,    69,    69,    70,    70,    70,    70,    70,    70,
+      70,    70,    70,    71,    71,    71,    71,    71,    71,    71,
+      71,    71,    71,    71,    71,    71,    71,    71,    71,    71,
+      71,    71,    71,    71,    71,    71,    71,    71,    71,    71,
+      71,    71,    71,    71,    71,    71,    71,    71,    71,    71,
+      71,    71,    72,    72,    72,    72,    72,    73,    74,    75,
+      76,    77,    77,    78,    79,    79,    80,    80,    80,    81,
+      81,    81,    81,    81,    82,    82,    82,    82,    82,    83,
+      83,    83,    84,    84,    84,    84,    84,    84,    85,    85,
+      86,    86,    87,    87,    88,    88,    88,    88,    89,    89,
+      89,    90,    90
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     1,     0,     2,     1,     1,     1,     3,     0,
+       2,     2,     1,     1,     4,     4,     1,     1,     2,     1,
+       2,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+       3,     3,     3,     3,     2,     2,     4,     5,     4,     2,
+       2,     2,     2,     3,     3,     3,     3,     3,     3,     2,
+       3,     1,     4,     3,     3,     3,     3,     6,     4,     2,
+       6,     0,     2,     2,     7,     8,     0,     1,     3,     2,
+       3,     2,     2,     2,     0,     2,     3,     2,     2,     0,
+       1,     3,     5,     7,     9,     5,     7,    15,     0,     1,
+       0,     1,     0,     2,     2,     3,     3,     4,     3,     6,
+       5,     1,     3
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
+   If N is 0, then set CURRENT to the empty location which ends
+   the previous symbol: RHS[0] (always defined).  */
+
+#ifndef YYLLOC_DEFAULT
+# define YYLLOC_DEFAULT(Current, Rhs, N)                                \
+    do                                                                  \
+      if (N)                                                            \
+        {                                                               \
+          (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;        \
+          (Current).first_column = YYRHSLOC (Rhs, 1).first_column;      \
+          (Current).last_line    = YYRHSLOC (Rhs, N).last_line;         \
+          (Current).last_column  = YYRHSLOC (Rhs, N).last_column;       \
+        }                                                               \
+      else                                                              \
+        {                                                               \
+          (Current).first_line   = (Current).last_line   =              \
+            YYRHSLOC (Rhs, 0).last_line;                                \
+          (Current).first_column = (Current).last_column =              \
+            YYRHSLOC (Rhs, 0).last_column;                              \
+        }                                                               \
+    while (0)
+#endif
+
+#define YYRHSLOC(Rhs, K) ((Rhs)[K])
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+/* YYLOCATION_PRINT -- Print the location on the stream.
+   This macro was not mandated originally: define only if we know
+   we won't break user code: when these are the locations we know.  */
+
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+
+/* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
+
+YY_ATTRIBUTE_UNUSED
+static int
+yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
+{
+  int res = 0;
+  int end_col = 0 != yylocp->last_column ? yylocp->last_column - 1 : 0;
+  if (0 <= yylocp->first_line)
+    {
+      res += YYFPRINTF (yyo, "%d", yylocp->first_line);
+      if (0 <= yylocp->first_column)
+        res += YYFPRINTF (yyo, ".%d", yylocp->first_column);
+    }
+  if (0 <= yylocp->last_line)
+    {
+      if (yylocp->first_line < yylocp->last_line)
+        {
+          res += YYFPRINTF (yyo, "-%d", yylocp->last_line);
+          if (0 <= end_col)
+            res += YYFPRINTF (yyo, ".%d", end_col);
+        }
+      else if (0 <= end_col && yylocp->first_column < end_col)
+        res += YYFPRINTF (yyo, "-%d", end_col);
+    }
+  return res;
+}
+
+#   define YYLOCATION_PRINT  yy_location_print_
+
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
+
+#  else
+
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
+
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, Location); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (yylocationp);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  YYLOCATION_PRINT (yyo, yylocationp);
+  YYFPRINTF (yyo, ": ");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
+                 int yyrule)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]));
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, yylsp, Rule); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp)
+{
+  YY_USE (yyvaluep);
+  YY_USE (yylocationp);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Location data for the lookahead symbol.  */
+YYLTYPE yylloc
+# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+  = { 1, 1, 1, 1 }
+# endif
+;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (void)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+    /* The location stack: array, bottom, top.  */
+    YYLTYPE yylsa[YYINITDEPTH];
+    YYLTYPE *yyls = yylsa;
+    YYLTYPE *yylsp = yyls;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+  YYLTYPE yyloc;
+
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  yylsp[0] = yylloc;
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+        YYLTYPE *yyls1 = yyls;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yyls1, yysize * YYSIZEOF (*yylsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+        yyls = yyls1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+        YYSTACK_RELOCATE (yyls_alloc, yyls);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+      yylsp = yyls + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+  *++yylsp = yylloc;
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+  /* Default location. */
+  YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
+  yyerror_range[1] = yyloc;
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* puer: top_code  */
+#line 102 "src/parser.y"
+                                           { root = (yyvsp[0].node); }
+#line 1592 "src/parser.tab.c"
+    break;
+
+  case 3: /* top_code: %empty  */
+#line 106 "src/parser.y"
+                                           { (yyval.node) = node(NODE_SEQ, (yyloc), 0); }
+#line 1598 "src/parser.tab.c"
+    break;
+
+  case 4: /* top_code: top_code top_stmt_end  */
+#line 107 "src/parser.y"
+                                           { (yyval.node) = node_append((yyvsp[-1].node), (yyvsp[0].node)); }
+#line 1604 "src/parser.tab.c"
+    break;
+
+  case 5: /* top_stmt_end: function_def  */
+#line 111 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[0].node); }
+#line 1610 "src/parser.tab.c"
+    break;
+
+  case 6: /* top_stmt_end: rec_def  */
+#line 112 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[0].node); }
+#line 1616 "src/parser.tab.c"
+    break;
+
+  case 7: /* top_stmt_end: stmt_end  */
+#line 113 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[0].node); }
+#line 1622 "src/parser.tab.c"
+    break;
+
+  case 8: /* block: '{' code '}'  */
+#line 117 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[-1].node); }
+#line 1628 "src/parser.tab.c"
+    break;
+
+  case 9: /* code: %empty  */
+#line 121 "src/parser.y"
+                                           { (yyval.node) = node(NODE_SEQ, (yyloc), 0); }
+#line 1634 "src/parser.tab.c"
+    break;
+
+  case 10: /* code: code stmt_end  */
+#line 122 "src/parser.y"
+                                           { (yyval.node) = node_append((yyvsp[-1].node), (yyvsp[0].node)); }
+#line 1640 "src/parser.tab.c"
+    break;
+
+  case 11: /* stmt_end: stmt ';'  */
+#line 126 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[-1].node); }
+#line 1646 "src/parser.tab.c"
+    break;
+
+  case 12: /* stmt_end: control_stmt  */
+#line 127 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[0].node); }
+#line 1652 "src/parser.tab.c"
+    break;
+
+  case 13: /* stmt_end: block  */
+#line 128 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[0].node); }
+#line 1658 "src/parser.tab.c"
+    break;
+
+  case 14: /* stmt: PRINT '(' arg_list ')'  */
+#line 132 "src/parser.y"
+                                           { (yyval.node) = node(NODE_PRINT, (yyloc), 1, (yyvsp[-1].node)); }
+#line 1664 "src/parser.tab.c"
+    break;
+
+  case 15: /* stmt: PRINTLN '(' arg_list ')'  */
+#line 133 "src/parser.y"
+                                           { (yyval.node) = node(NODE_PRINTLN, (yyloc), 1, (yyvsp[-1].node)); }
+#line 1670 "src/parser.tab.c"
+    break;
+
+  case 16: /* stmt: BREAK  */
+#line 134 "src/parser.y"
+                                           { (yyval.node) = node(NODE_BREAK, (yyloc), 0); }
+#line 1676 "src/parser.tab.c"
+    break;
+
+  case 17: /* stmt: CONTINUE  */
+#line 135 "src/parser.y"
+                                           { (yyval.node) = node(NODE_CONTINUE, (yyloc), 0); }
+#line 1682 "src/parser.tab.c"
+    break;
+
+  case 18: /* stmt: RETURN expr  */
+#line 136 "src/parser.y"
+                                           { (yyval.node) = node(NODE_RETURN, (yyloc), 1, (yyvsp[0].node)); }
+#line 1688 "src/parser.tab.c"
+    break;
+
+  case 19: /* stmt: RETURN  */
+#line 137 "src/parser.y"
+                                           { (yyval.node) = node(NODE_RETURN, (yyloc), 0); settype((yyval.node), TYPE_VOID); }
+#line 1694 "src/parser.tab.c"
+    break;
+
+  case 20: /* stmt: YIELD expr  */
+#line 138 "src/parser.y"
+                                           { (yyval.node) = node(NODE_YIELD, (yyloc), 1, (yyvsp[0].node)); }
+#line 1700 "src/parser.tab.c"
+    break;
+
+  case 21: /* stmt: vardecl  */
+#line 139 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[0].node); }
+#line 1706 "src/parser.tab.c"
+    break;
+
+  case 22: /* stmt: expr  */
+#line 140 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[0].node); }
+#line 1712 "src/parser.tab.c"
+    break;
+
+  case 23: /* expr: NUM  */
+#line 144 "src/parser.y"
+                                           { (yyval.node) = node(NODE_NUM, (yylsp[0]), 0); (yyval.node)->ival = (yyvsp[0].ival); }
+#line 1718 "src/parser.tab.c"
+    break;
+
+  case 24: /* expr: TRUE  */
+#line 145 "src/parser.y"
+                                           { (yyval.node) = node(NODE_BOOL, (yylsp[0]), 0); (yyval.node)->ival = (yyvsp[0].bval); }
+#line 1724 "src/parser.tab.c"
+    break;
+
+  case 25: /* expr: FALSE  */
+#line 146 "src/parser.y"
+                                           { (yyval.node) = node(NODE_BOOL, (yylsp[0]), 0); (yyval.node)->ival = (yyvsp[0].bval); }
+#line 1730 "src/parser.tab.c"
+    break;
+
+  case 26: /* expr: FLOAT  */
+#line 147 "src/parser.y"
+                                           { (yyval.node) = node(NODE_FLOAT, (yylsp[0]), 0); (yyval.node)->fval = (yyvsp[0].fval); }
+#line 1736 "src/parser.tab.c"
+    break;
+
+  case 27: /* expr: IDENT  */
+#line 148 "src/parser.y"
+                                           { (yyval.node) = node(NODE_VAR, (yylsp[0]), 0); setname((yyval.node), (yyvsp[0].sym)); }
+#line 1742 "src/parser.tab.c"
+    break;
+
+  case 28: /* expr: STRING  */
+#line 149 "src/parser.y"
+                                           { (yyval.node) = node(NODE_STRING, (yylsp[0]), 0); setname((yyval.node), (yyvsp[0].sym)); }
+#line 1748 "src/parser.tab.c"
+    break;
+
+  case 29: /* expr: CHAR  */
+#line 150 "src/parser.y"
+                                           { (yyval.node) = node(NODE_CHAR, (yylsp[0]), 0); (yyval.node)->ival = (yyvsp[0].ival); }
+#line 1754 "src/parser.tab.c"
+    break;
+
+  case 30: /* expr: expr '.' IDENT  */
+#line 151 "src/parser.y"
+                                           { (yyval.node) = node(NODE_FIELDACCESS, (yyloc), 1, (yyvsp[-2].node)); setname((yyval.node), (yyvsp[0].sym)); }
+#line 1760 "src/parser.tab.c"
+    break;
+
+  case 31: /* expr: expr LT expr  */
+#line 152 "src/parser.y"
+                                           { (yyval.node) = node_binop(OP_LT, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1766 "src/parser.tab.c"
+    break;
+
+  case 32: /* expr: expr GT expr  */
+#line 153 "src/parser.y"
+                                           { (yyval.node) = node_binop(OP_GT, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1772 "src/parser.tab.c"
+    break;
+
+  case 33: /* expr: expr LE expr  */
+#line 154 "src/parser.y"
+                                           { (yyval.node) = node_binop(OP_LE, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1778 "src/parser.tab.c"
+    break;
+
+  case 34: /* expr: expr GE expr  */
+#line 155 "src/parser.y"
+                                           { (yyval.node) = node_binop(OP_GE, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1784 "src/parser.tab.c"
+    break;
+
+  case 35: /* expr: expr EQ expr  */
+#line 156 "src/parser.y"
+                                           { (yyval.node) = node_binop(OP_EQ, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1790 "src/parser.tab.c"
+    break;
+
+  case 36: /* expr: expr NE expr  */
+#line 157 "src/parser.y"
+                                           { (yyval.node) = node_binop(OP_NE, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1796 "src/parser.tab.c"
+    break;
+
+  case 37: /* expr: expr ADD expr  */
+#line 158 "src/parser.y"
+                                           { (yyval.node) = node_binop(OP_ADD, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1802 "src/parser.tab.c"
+    break;
+
+  case 38: /* expr: expr SUB expr  */
+#line 159 "src/parser.y"
+                                           { (yyval.node) = node_binop(OP_SUB, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1808 "src/parser.tab.c"
+    break;
+
+  case 39: /* expr: expr MUL expr  */
+#line 160 "src/parser.y"
+                                           { (yyval.node) = node_binop(OP_MUL, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1814 "src/parser.tab.c"
+    break;
+
+  case 40: /* expr: expr DIV expr  */
+#line 161 "src/parser.y"
+                                           { (yyval.node) = node_binop(OP_DIV, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1820 "src/parser.tab.c"
+    break;
+
+  case 41: /* expr: expr MOD expr  */
+#line 162 "src/parser.y"
+                                           { (yyval.node) = node_binop(OP_MOD, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1826 "src/parser.tab.c"
+    break;
+
+  case 42: /* expr: expr AND expr  */
+#line 164 "src/parser.y"
+                                           { (yyval.node) = node(NODE_AND, (yyloc), 2, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1832 "src/parser.tab.c"
+    break;
+
+  case 43: /* expr: expr OR expr  */
+#line 165 "src/parser.y"
+                                           { (yyval.node) = node(NODE_OR, (yyloc), 2, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1838 "src/parser.tab.c"
+    break;
+
+  case 44: /* expr: expr INC  */
+#line 167 "src/parser.y"
+                                           { (yyval.node) = node_incdec(OP_ADD, (yyloc), (yyvsp[-1].node), 0); }
+#line 1844 "src/parser.tab.c"
+    break;
+
+  case 45: /* expr: expr DEC  */
+#line 168 "src/parser.y"
+                                           { (yyval.node) = node_incdec(OP_SUB, (yyloc), (yyvsp[-1].node), 0); }
+#line 1850 "src/parser.tab.c"
+    break;
+
+  case 46: /* expr: IDENT '(' arg_list ')'  */
+#line 169 "src/parser.y"
+                                           { (yyval.node) = node_call((yyvsp[-3].sym), (yyvsp[-1].node), (yyloc)); }
+#line 1856 "src/parser.tab.c"
+    break;
+
+  case 47: /* expr: SPAWN IDENT '(' arg_list ')'  */
+#line 170 "src/parser.y"
+                                           { (yyval.node) = node(NODE_SPAWN, (yyloc), 1, node_call((yyvsp[-3].sym), (yyvsp[-1].node), (yyloc))); }
+#line 1862 "src/parser.tab.c"
+    break;
+
+  case 48: /* expr: expr '[' expr ']'  */
+#line 171 "src/parser.y"
+                                           { (yyval.node) = node(NODE_IDX, (yyloc), 2, (yyvsp[-3].node), (yyvsp[-1].node)); }
+#line 1868 "src/parser.tab.c"
+    break;
+
+  case 49: /* expr: INC expr  */
+#line 173 "src/parser.y"
+                                           { (yyval.node) = node_incdec(OP_ADD, (yyloc), (yyvsp[0].node), 1); }
+#line 1874 "src/parser.tab.c"
+    break;
+
+  case 50: /* expr: DEC expr  */
+#line 174 "src/parser.y"
+                                           { (yyval.node) = node_incdec(OP_SUB, (yyloc), (yyvsp[0].node), 1); }
+#line 1880 "src/parser.tab.c"
+    break;
+
+  case 51: /* expr: NOT expr  */
+#line 175 "src/parser.y"
+                                           { (yyval.node) = node(NODE_NOT, (yyloc), 1, (yyvsp[0].node)); }
+#line 1886 "src/parser.tab.c"
+    break;
+
+  case 52: /* expr: SUB expr  */
+#line 176 "src/parser.y"
+                                           { (yyval.node) = node_uminus((yyvsp[0].node), (yyloc)); }
+#line 1892 "src/parser.tab.c"
+    break;
+
+  case 53: /* expr: expr ADD_ASSIGN expr  */
+#line 178 "src/parser.y"
+                                           { (yyval.node) = node_compound(OP_ADD, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1898 "src/parser.tab.c"
+    break;
+
+  case 54: /* expr: expr SUB_ASSIGN expr  */
+#line 179 "src/parser.y"
+                                           { (yyval.node) = node_compound(OP_SUB, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1904 "src/parser.tab.c"
+    break;
+
+  case 55: /* expr: expr MUL_ASSIGN expr  */
+#line 180 "src/parser.y"
+                                           { (yyval.node) = node_compound(OP_MUL, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1910 "src/parser.tab.c"
+    break;
+
+  case 56: /* expr: expr DIV_ASSIGN expr  */
+#line 181 "src/parser.y"
+                                           { (yyval.node) = node_compound(OP_DIV, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1916 "src/parser.tab.c"
+    break;
+
+  case 57: /* expr: expr MOD_ASSIGN expr  */
+#line 182 "src/parser.y"
+                                           { (yyval.node) = node_compound(OP_MOD, (yyloc), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1922 "src/parser.tab.c"
+    break;
+
+  case 58: /* expr: '(' expr ')'  */
+#line 184 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[-1].node); }
+#line 1928 "src/parser.tab.c"
+    break;
+
+  case 59: /* expr: '[' ']'  */
+#line 185 "src/parser.y"
+                                           { (yyval.node) = node(NODE_ARRAYLIT, (yyloc), 0); }
+#line 1934 "src/parser.tab.c"
+    break;
+
+  case 60: /* expr: '[' array_items ']'  */
+#line 186 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[-1].node); }
+#line 1940 "src/parser.tab.c"
+    break;
+
+  case 61: /* expr: varassign  */
+#line 187 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[0].node); }
+#line 1946 "src/parser.tab.c"
+    break;
+
+  case 62: /* vardecl: TYPE dims IDENT opt_init  */
+#line 191 "src/parser.y"
+                                      {
+        (yyval.node) = node(NODE_ARRAYDECL, (yyloc), 2, (yyvsp[-2].node), (yyvsp[0].node));
+        setvar((yyval.node), (yyvsp[-3].vartype), (yyvsp[-1].sym));
+        if ((yyvsp[-3].vartype) == TYPE_REC)
+                (yyval.node)->recname = g_recname;
+    }
+#line 1957 "src/parser.tab.c"
+    break;
+
+  case 63: /* vardecl: TYPE IDENT opt_init  */
+#line 197 "src/parser.y"
+                                      {
+        (yyval.node) = node(NODE_VARDECL, (yyloc), 1, (yyvsp[0].node));
+        setvar((yyval.node), (yyvsp[-2].vartype), (yyvsp[-1].sym));
+        if ((yyvsp[-2].vartype) == TYPE_REC)
+                (yyval.node)->recname = g_recname;
+    }
+#line 1968 "src/parser.tab.c"
+    break;
+
+  case 64: /* vardecl: dict_type IDENT opt_init  */
+#line 203 "src/parser.y"
+                                      { (yyval.node) = node_append((yyvsp[-2].node), (yyvsp[0].node)); setname((yyval.node), (yyvsp[-1].sym)); }
+#line 1974 "src/parser.tab.c"
+    break;
+
+  case 65: /* vardecl: chan_type IDENT opt_init  */
+#line 204 "src/parser.y"
+                                      { (yyval.node) = node_append((yyvsp[-2].node), (yyvsp[0].node)); setname((yyval.node), (yyvsp[-1].sym)); }
+#line 1980 "src/parser.tab.c"
+    break;
+
+  case 66: /* vardecl: gen_type IDENT opt_init  */
+#line 205 "src/parser.y"
+                                      { (yyval.node) = node_append((yyvsp[-2].node), (yyvsp[0].node)); setname((yyval.node), (yyvsp[-1].sym)); }
+#line 1986 "src/parser.tab.c"
+    break;
+
+  case 67: /* dict_type: DICT '[' TYPE ',' TYPE ']'  */
+#line 209 "src/parser.y"
+                                      {
+        if (!dict_is_key_type((yyvsp[-3].vartype))) {
+                yyerror("dict keys must be int, uint, long, char, bool or str");
+                YYERROR;
+        }
+        (yyval.node) = node(NODE_DICTDECL, (yyloc), 0);
+        (yyval.node)->vartype = TYPE_DICT;
+        (yyval.node)->ival = DICT_TYPES((yyvsp[-3].vartype), (yyvsp[-1].vartype));
+    }
+#line 2000 "src/parser.tab.c"
+    break;
+
+  case 68: /* chan_type: CHAN '[' TYPE ']'  */
+#line 221 "src/parser.y"
+                                      {
+        if (!chan_is_elem_type((yyvsp[-1].vartype))) {
+                yyerror("channels carry int, uint, long, float, bool, char or str");
+                YYERROR;
+        }
+        (yyval.node) = node(NODE_CHANDECL, (yyloc), 0);
+        (yyval.node)->vartype = TYPE_CHAN;
+        (yyval.node)->ival = (yyvsp[-1].vartype);
+    }
+#line 2014 "src/parser.tab.c"
+    break;
+
+  case 69: /* gen_type: TYPE MUL  */
+#line 233 "src/parser.y"
+                                      {
+        if (!gen_is_elem_type((yyvsp[-1].vartype))) {
+                yyerror("generators yield int, uint, long, float, bool, char or str");
+                YYERROR;
+        }
+        (yyval.node) = node(NODE_GENDECL, (yyloc), 0);
+        (yyval.node)->vartype = TYPE_GEN;
+        (yyval.node)->ival = (yyvsp[-1].vartype);
+    }
+#line 2028 "src/parser.tab.c"
+    break;
+
+  case 70: /* rec_def: REC IDENT '{' rec_field_list '}' ';'  */
+#line 245 "src/parser.y"
+                                           {
+        (yyval.node) = node(NODE_RECDEF, (yyloc), 1, (yyvsp[-2].node));
+        setname((yyval.node), (yyvsp[-4].sym));
+        recname_register((yyvsp[-4].sym));
+    }
+#line 2038 "src/parser.tab.c"
+    break;
+
+  case 71: /* rec_field_list: %empty  */
+#line 253 "src/parser.y"
+                                           { (yyval.node) = node(NODE_SEQ, (yyloc), 0); }
+#line 2044 "src/parser.tab.c"
+    break;
+
+  case 72: /* rec_field_list: rec_field_list rec_field  */
+#line 254 "src/parser.y"
+                                           { (yyval.node) = node_append((yyvsp[-1].node), (yyvsp[0].node)); }
+#line 2050 "src/parser.tab.c"
+    break;
+
+  case 73: /* rec_field: vardecl ';'  */
+#line 258 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[-1].node); }
+#line 2056 "src/parser.tab.c"
+    break;
+
+  case 74: /* function_def: DEF IDENT '(' param_list ')' opt_return block  */
+#line 262 "src/parser.y"
+                                                    { (yyval.node) = node(NODE_FUNCDEF, (yyloc), 2, (yyvsp[-3].node), (yyvsp[0].node)); setvar((yyval.node), (yyvsp[-1].vartype), (yyvsp[-5].sym)); }
+#line 2062 "src/parser.tab.c"
+    break;
+
+  case 75: /* function_def: DEF IDENT '(' param_list ')' ARROW gen_type block  */
+#line 263 "src/parser.y"
+                                                        {
+        (yyval.node) = node(NODE_FUNCDEF, (yyloc), 2, (yyvsp[-4].node), (yyvsp[0].node));
+        setvar((yyval.node), TYPE_GEN, (yyvsp[-6].sym));
+        (yyval.node)->ival = (yyvsp[-1].node)->ival;
+        free_parse_tree((yyvsp[-1].node));
+    }
+#line 2073 "src/parser.tab.c"
+    break;
+
+  case 76: /* param_list: %empty  */
+#line 272 "src/parser.y"
+                                           { (yyval.node) = node(NODE_SEQ, (yyloc), 0); }
+#line 2079 "src/parser.tab.c"
+    break;
+
+  case 77: /* param_list: param  */
+#line 273 "src/parser.y"
+                                           { (yyval.node) = node(NODE_SEQ, (yyloc), 1, (yyvsp[0].node)); }
+#line 2085 "src/parser.tab.c"
+    break;
+
+  case 78: /* param_list: param_list ',' param  */
+#line 274 "src/parser.y"
+                                           { (yyval.node) = node_append((yyvsp[-2].node), (yyvsp[0].node)); }
+#line 2091 "src/parser.tab.c"
+    break;
+
+  case 79: /* param: TYPE IDENT  */
+#line 278 "src/parser.y"
+                                           { (yyval.node) = node_param((yyvsp[-1].vartype), 0, (yyvsp[0].sym), (yyloc)); }
+#line 2097 "src/parser.tab.c"
+    break;
+
+  case 80: /* param: TYPE dims IDENT  */
+#line 279 "src/parser.y"
+                                           { (yyval.node) = node_param((yyvsp[-2].vartype), 1, (yyvsp[0].sym), (yyloc)); free_parse_tree((yyvsp[-1].node)); }
+#line 2103 "src/parser.tab.c"
+    break;
+
+  case 81: /* param: dict_type IDENT  */
+#line 280 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[-1].node); setname((yyval.node), (yyvsp[0].sym)); }
+#line 2109 "src/parser.tab.c"
+    break;
+
+  case 82: /* param: chan_type IDENT  */
+#line 281 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[-1].node); setname((yyval.node), (yyvsp[0].sym)); }
+#line 2115 "src/parser.tab.c"
+    break;
+
+  case 83: /* param: gen_type IDENT  */
+#line 282 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[-1].node); setname((yyval.node), (yyvsp[0].sym)); }
+#line 2121 "src/parser.tab.c"
+    break;
+
+  case 84: /* opt_return: %empty  */
+#line 286 "src/parser.y"
+                                           { (yyval.vartype) = TYPE_VOID; }
+#line 2127 "src/parser.tab.c"
+    break;
+
+  case 85: /* opt_return: ARROW TYPE  */
+#line 287 "src/parser.y"
+                                           { (yyval.vartype) = (yyvsp[0].vartype); }
+#line 2133 "src/parser.tab.c"
+    break;
+
+  case 86: /* opt_return: ARROW TYPE dims  */
+#line 288 "src/parser.y"
+                                           { (yyval.vartype) = TYPE_ARRAY; free_parse_tree((yyvsp[0].node)); }
+#line 2139 "src/parser.tab.c"
+    break;
+
+  case 87: /* opt_return: ARROW dict_type  */
+#line 289 "src/parser.y"
+                                           { (yyval.vartype) = TYPE_DICT; free_parse_tree((yyvsp[0].node)); }
+#line 2145 "src/parser.tab.c"
+    break;
+
+  case 88: /* opt_return: ARROW chan_type  */
+#line 290 "src/parser.y"
+                                           { (yyval.vartype) = TYPE_CHAN; free_parse_tree((yyvsp[0].node)); }
+#line 2151 "src/parser.tab.c"
+    break;
+
+  case 89: /* arg_list: %empty  */
+#line 294 "src/parser.y"
+                                           { (yyval.node) = node(NODE_SEQ, (yyloc), 0); }
+#line 2157 "src/parser.tab.c"
+    break;
+
+  case 90: /* arg_list: expr  */
+#line 295 "src/parser.y"
+                                           { (yyval.node) = node(NODE_SEQ, (yyloc), 1, (yyvsp[0].node)); }
+#line 2163 "src/parser.tab.c"
+    break;
+
+  case 91: /* arg_list: arg_list ',' expr  */
+#line 296 "src/parser.y"
+                                           { (yyval.node) = node_append((yyvsp[-2].node), (yyvsp[0].node)); }
+#line 2169 "src/parser.tab.c"
+    break;
+
+  case 92: /* control_stmt: IF '(' expr ')' stmt_end  */
+#line 300 "src/parser.y"
+                                                              { (yyval.node) = node(NODE_IF, (yyloc), 2, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 2175 "src/parser.tab.c"
+    break;
+
+  case 93: /* control_stmt: IF '(' expr ')' stmt_end ELSE stmt_end  */
+#line 301 "src/parser.y"
+                                                              { (yyval.node) = node(NODE_IFELSE, (yyloc), 3, (yyvsp[-4].node), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 2181 "src/parser.tab.c"
+    break;
+
+  case 94: /* control_stmt: FOR '(' opt_stmt ';' opt_expr ';' opt_stmt ')' stmt_end  */
+#line 302 "src/parser.y"
+                                                              { (yyval.node) = node(NODE_FOR, (yyloc), 4, (yyvsp[-6].node), (yyvsp[-4].node), (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 2187 "src/parser.tab.c"
+    break;
+
+  case 95: /* control_stmt: WHILE '(' expr ')' stmt_end  */
+#line 303 "src/parser.y"
+                                                              { (yyval.node) = node(NODE_WHILE, (yyloc), 2, (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 2193 "src/parser.tab.c"
+    break;
+
+  case 96: /* control_stmt: FOR '(' IDENT IDENT expr ')' stmt_end  */
+#line 304 "src/parser.y"
+                                            {
+        /* not a keyword, in stays usable as a name */
+        if ((yyvsp[-3].sym) != sym_intern_str("in")) {
+                yyerror("expected for (x in gen())");
+                YYERROR;
+        }
+        (yyval.node) = node(NODE_FORIN, (yyloc), 2, (yyvsp[-2].node), (yyvsp[0].node));
+        setname((yyval.node), (yyvsp[-4].sym));
+    }
+#line 2207 "src/parser.tab.c"
+    break;
+
+  case 97: /* control_stmt: PARFOR '(' TYPE IDENT '=' expr ';' IDENT LT expr ';' IDENT INC ')' stmt_end  */
+#line 313 "src/parser.y"
+                                                                                  {
+        if ((yyvsp[-12].vartype) != TYPE_INT || (yyvsp[-11].sym) != (yyvsp[-7].sym) || (yyvsp[-11].sym) != (yyvsp[-3].sym)) {
+                yyerror("parfor must be written parfor (int i = start; i < end; i++)");
+                YYERROR;
+        }
+        (yyval.node) = node(NODE_PARFOR, (yyloc), 3, (yyvsp[-9].node), (yyvsp[-5].node), (yyvsp[0].node));
+        setname((yyval.node), (yyvsp[-11].sym));
+    }
+#line 2220 "src/parser.tab.c"
+    break;
+
+  case 98: /* opt_stmt: %empty  */
+#line 325 "src/parser.y"
+                                           { (yyval.node) = node(NODE_NOP, (yyloc), 0); }
+#line 2226 "src/parser.tab.c"
+    break;
+
+  case 99: /* opt_stmt: stmt  */
+#line 326 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[0].node); }
+#line 2232 "src/parser.tab.c"
+    break;
+
+  case 100: /* opt_expr: %empty  */
+#line 331 "src/parser.y"
+                                           { (yyval.node) = node(NODE_NOP, (yyloc), 0); }
+#line 2238 "src/parser.tab.c"
+    break;
+
+  case 101: /* opt_expr: expr  */
+#line 332 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[0].node); }
+#line 2244 "src/parser.tab.c"
+    break;
+
+  case 102: /* opt_init: %empty  */
+#line 336 "src/parser.y"
+                                           { (yyval.node) = node(NODE_NOP, (yyloc), 0); }
+#line 2250 "src/parser.tab.c"
+    break;
+
+  case 103: /* opt_init: '=' expr  */
+#line 337 "src/parser.y"
+                                           { (yyval.node) = (yyvsp[0].node); }
+#line 2256 "src/parser.tab.c"
+    break;
+
+  case 104: /* dims: '[' ']'  */
+#line 341 "src/parser.y"
+                                           { (yyval.node) = node(NODE_SEQ, (yyloc), 0); }
+#line 2262 "src/parser.tab.c"
+    break;
+
+  case 105: /* dims: dims '[' ']'  */
+#line 342 "src/parser.y"
+                                           { (yyval.node) = node_append_type((yyvsp[-2].node), NODE_NOP, (yyloc)); }
+#line 2268 "src/parser.tab.c"
+    break;
+
+  case 106: /* dims: '[' expr ']'  */
+#line 343 "src/parser.y"
+                                           { (yyval.node) = node(NODE_SEQ, (yyloc), 1, (yyvsp[-1].node)); }
+#line 2274 "src/parser.tab.c"
+    break;
+
+  case 107: /* dims: dims '[' expr ']'  */
+#line 344 "src/parser.y"
+                                           { (yyval.node) = node_append((yyvsp[-3].node), (yyvsp[-1].node)); }
+#line 2280 "src/parser.tab.c"
+    break;
+
+  case 108: /* varassign: IDENT '=' expr  */
+#line 348 "src/parser.y"
+                                           { (yyval.node) = node(NODE_ASSIGN, (yyloc), 1, (yyvsp[0].node)); setname((yyval.node), (yyvsp[-2].sym)); }
+#line 2286 "src/parser.tab.c"
+    break;
+
+  case 109: /* varassign: expr '[' expr ']' '=' expr  */
+#line 349 "src/parser.y"
+                                           { (yyval.node) = node(NODE_IDXASSIGN, (yyloc), 3, (yyvsp[-5].node), (yyvsp[-3].node), (yyvsp[0].node)); }
+#line 2292 "src/parser.tab.c"
+    break;
+
+  case 110: /* varassign: expr '.' IDENT '=' expr  */
+#line 350 "src/parser.y"
+                                           { (yyval.node) = node(NODE_FIELDASSIGN, (yyloc), 2, (yyvsp[-4].node), (yyvsp[0].node)); setname((yyval.node), (yyvsp[-2].sym)); }
+#line 2298 "src/parser.tab.c"
+    break;
+
+  case 111: /* array_items: expr  */
+#line 354 "src/parser.y"
+                                           { (yyval.node) = node(NODE_ARRAYLIT, (yyloc), 1, (yyvsp[0].node)); }
+#line 2304 "src/parser.tab.c"
+    break;
+
+  case 112: /* array_items: array_items ',' expr  */
+#line 355 "src/parser.y"
+                                           { node_append((yyvsp[-2].node), (yyvsp[0].node)); }
+#line 2310 "src/parser.tab.c"
+    break;
+
+
+#line 2314 "src/parser.tab.c"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+  *++yylsp = yyloc;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (YY_("syntax error"));
+    }
+
+  yyerror_range[1] = yylloc;
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, &yylloc);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+      yyerror_range[1] = *yylsp;
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  yyerror_range[2] = yylloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, &yylloc);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+
+  return yyresult;
+}
+
+#line 357 "src/parser.y"
+
+
+#include <string.h>
+
+extern YYLTYPE yyloc;
+extern char* yytext;
+
+void yyerror(const char* s)
+{
+        const char* src;
+        size_t size;
+
+        fprintf(stderr, "Parse error: %s\n", s);
+
+        fprintf(
+                stderr, "Parse error at line %d, column %d: %s\n",
+                yylloc.first_line,
+                yylloc.first_column, s
+        );
+
+        if ((src = lex_source(&size))) {
+                const char* end = src + size;
+                const char* eol;
+                int line = 1;
+                int i;
+
+                while (line < yylloc.first_line && src < end) {
+                        if (*src++ == '\n')
+                                line++;
+                }
+
+                for (eol = src; eol < end && *eol != '\n'; eol++)
+                        ;
+                fprintf(stderr, "%.*s\n", (int) (eol - src), src);
+
+                for (i = 0; i <= yylloc.first_column && src + i < eol; i++)
+                        fputc(src[i] == '\t' ? '\t' : ' ', stderr);
+                fprintf(stderr, "^\n");
+        }
+}
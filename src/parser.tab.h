@@ -0,0 +1,161 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison interface for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_YY_SRC_PARSER_TAB_H_INCLUDED
+# define YY_YY_SRC_PARSER_TAB_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+/* "%code requires" blocks.  */
+#line 6 "src/parser.y"
+
+#include "var.h"
+#include "rec.h"
+#include <stdlib.h>
+
+#line 55 "src/parser.tab.h"
+
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    RET = 258,                     /* RET  */
+    MOD = 259,                     /* MOD  */
+    UMINUS = 260,                  /* UMINUS  */
+    POSTFIX = 261,                 /* POSTFIX  */
+    IFX = 262,                     /* IFX  */
+    NUM = 263,                     /* NUM  */
+    TRUE = 264,                    /* TRUE  */
+    FALSE = 265,                   /* FALSE  */
+    FLOAT = 266,                   /* FLOAT  */
+    TYPE = 267,                    /* TYPE  */
+    IDENT = 268,                   /* IDENT  */
+    STRING = 269,                  /* STRING  */
+    CHAR = 270,                    /* CHAR  */
+    ADD = 271,                     /* ADD  */
+    SUB = 272,                     /* SUB  */
+    MUL = 273,                     /* MUL  */
+    DIV = 274,                     /* DIV  */
+    ADD_ASSIGN = 275,              /* ADD_ASSIGN  */
+    SUB_ASSIGN = 276,              /* SUB_ASSIGN  */
+    MUL_ASSIGN = 277,              /* MUL_ASSIGN  */
+    DIV_ASSIGN = 278,              /* DIV_ASSIGN  */
+    MOD_ASSIGN = 279,              /* MOD_ASSIGN  */
+    LT = 280,                      /* LT  */
+    GT = 281,                      /* GT  */
+    LE = 282,                      /* LE  */
+    GE = 283,                      /* GE  */
+    EQ = 284,                      /* EQ  */
+    NE = 285,                      /* NE  */
+    NOT = 286,                     /* NOT  */
+    AND = 287,                     /* AND  */
+    OR = 288,                      /* OR  */
+    INC = 289,                     /* INC  */
+    DEC = 290,                     /* DEC  */
+    IF = 291,                      /* IF  */
+    ELSE = 292,                    /* ELSE  */
+    FOR = 293,                     /* FOR  */
+    WHILE = 294,                   /* WHILE  */
+    PARFOR = 295,                  /* PARFOR  */
+    SPAWN = 296,                   /* SPAWN  */
+    BREAK = 297,                   /* BREAK  */
+    CONTINUE = 298,                /* CONTINUE  */
+    DEF = 299,                     /* DEF  */
+    RETURN = 300,                  /* RETURN  */
+    YIELD = 301,                   /* YIELD  */
+    ARROW = 302,                   /* ARROW  */
+    REC = 303,                     /* REC  */
+    DICT = 304,                    /* DICT  */
+    CHAN = 305,                    /* CHAN  */
+    PRINT = 306,                   /* PRINT  */
+    PRINTLN = 307                  /* PRINTLN  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 37 "src/parser.y"
+
+        int ival;
+        int bval;
+        float fval;
+        Symbol sym;
+        struct ParseNode* node;
+        enum VarType vartype;
+
+#line 133 "src/parser.tab.h"
+
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
+#endif
+
+/* Location type.  */
+#if ! defined YYLTYPE && ! defined YYLTYPE_IS_DECLARED
+typedef struct YYLTYPE YYLTYPE;
+struct YYLTYPE
+{
+  int first_line;
+  int first_column;
+  int last_line;
+  int last_column;
+};
+# define YYLTYPE_IS_DECLARED 1
+# define YYLTYPE_IS_TRIVIAL 1
+#endif
+
+
+extern YYSTYPE yylval;
+extern YYLTYPE yylloc;
+
+int yyparse (void);
+
+
+#endif /* !YY_YY_SRC_PARSER_TAB_H_INCLUDED  */
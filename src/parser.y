@@ -15,6 +15,9 @@
 %{
 #include <stdio.h>
 #include "ast.h"
+#include "dict.h"
+#include "task.h"
+#include "gen.h"
 
 /* externs */
 extern int yylex();
@@ -27,16 +30,16 @@ void yyerror(const char* s);
 
 /* globals */
 /* root of ast (abstract syntax tree) */
-Node* root;
-char* g_recname = NULL;
+ParseNode* root;
+Symbol g_recname = SYM_NONE;
 %}
 
 %union {
         int ival;
         int bval;
         float fval;
-        char* ident;
-        struct Node* node;
+        Symbol sym;
+        struct ParseNode* node;
         enum VarType vartype;
 }
 
@@ -61,8 +64,8 @@ char* g_recname = NULL;
 %token <bval> TRUE FALSE
 %token <fval> FLOAT
 %token <vartype> TYPE
-%token <ident> IDENT
-%token <ident> STRING
+%token <sym> IDENT
+%token <sym> STRING
 %token <ival> CHAR
 
 %token '='
@@ -76,10 +79,11 @@ char* g_recname = NULL;
 %token NOT
 %token AND OR
 %token INC DEC
-%token IF ELSE FOR WHILE
+%token IF ELSE FOR WHILE PARFOR SPAWN
 %token BREAK CONTINUE
-%token DEF RETURN ARROW ','
+%token DEF RETURN YIELD ARROW ','
 %token REC
+%token DICT CHAN
 %token PRINT
 %token PRINTLN
 
@@ -90,6 +94,7 @@ char* g_recname = NULL;
 %type <node> function_def param param_list arg_list
 %type <node> vardecl varassign
 %type <node> rec_def rec_field_list rec_field
+%type <node> dict_type chan_type gen_type
 %type <vartype> opt_return
 
 %%
@@ -130,6 +135,7 @@ stmt
     | CONTINUE                             { $$ = node(NODE_CONTINUE, @$, 0); }
     | RETURN expr                          { $$ = node(NODE_RETURN, @$, 1, $2); }
     | RETURN                               { $$ = node(NODE_RETURN, @$, 0); settype($$, TYPE_VOID); }
+    | YIELD expr                           { $$ = node(NODE_YIELD, @$, 1, $2); }
     | vardecl                              { $$ = $1; }
     | expr                                 { $$ = $1; }
     ;
@@ -160,7 +166,8 @@ expr
 
     | expr INC               %prec POSTFIX { $$ = node_incdec(OP_ADD, @$, $1, 0); }
     | expr DEC               %prec POSTFIX { $$ = node_incdec(OP_SUB, @$, $1, 0); }
-    | IDENT '(' arg_list ')' %prec POSTFIX { $$ = node(NODE_FUNCCALL, @$, 1, $3); setname($$, $1); }
+    | IDENT '(' arg_list ')' %prec POSTFIX { $$ = node_call($1, $3, @$); }
+    | SPAWN IDENT '(' arg_list ')'         { $$ = node(NODE_SPAWN, @$, 1, node_call($2, $4, @$)); }
     | expr '[' expr ']'      %prec POSTFIX { $$ = node(NODE_IDX, @$, 2, $1, $3); }
 
     | INC expr                             { $$ = node_incdec(OP_ADD, @$, $2, 1); }
@@ -193,6 +200,45 @@ vardecl
         if ($1 == TYPE_REC)
                 $$->recname = g_recname;
     }
+    | dict_type IDENT opt_init        { $$ = node_append($1, $3); setname($$, $2); }
+    | chan_type IDENT opt_init        { $$ = node_append($1, $3); setname($$, $2); }
+    | gen_type IDENT opt_init         { $$ = node_append($1, $3); setname($$, $2); }
+    ;
+
+dict_type
+    : DICT '[' TYPE ',' TYPE ']'      {
+        if (!dict_is_key_type($3)) {
+                yyerror("dict keys must be int, uint, long, char, bool or str");
+                YYERROR;
+        }
+        $$ = node(NODE_DICTDECL, @$, 0);
+        $$->vartype = TYPE_DICT;
+        $$->ival = DICT_TYPES($3, $5);
+    }
+    ;
+
+chan_type
+    : CHAN '[' TYPE ']'               {
+        if (!chan_is_elem_type($3)) {
+                yyerror("channels carry int, uint, long, float, bool, char or str");
+                YYERROR;
+        }
+        $$ = node(NODE_CHANDECL, @$, 0);
+        $$->vartype = TYPE_CHAN;
+        $$->ival = $3;
+    }
+    ;
+
+gen_type
+    : TYPE MUL                        {
+        if (!gen_is_elem_type($1)) {
+                yyerror("generators yield int, uint, long, float, bool, char or str");
+                YYERROR;
+        }
+        $$ = node(NODE_GENDECL, @$, 0);
+        $$->vartype = TYPE_GEN;
+        $$->ival = $1;
+    }
     ;
 
 rec_def
@@ -213,7 +259,14 @@ rec_field
     ;
 
 function_def
-    : DEF IDENT '(' param_list ')' opt_return block { $$ = node(NODE_FUNCDEF, @$, 2, $4, $7); setvar($$, $6, $2); };
+    : DEF IDENT '(' param_list ')' opt_return block { $$ = node(NODE_FUNCDEF, @$, 2, $4, $7); setvar($$, $6, $2); }
+    | DEF IDENT '(' param_list ')' ARROW gen_type block {
+        $$ = node(NODE_FUNCDEF, @$, 2, $4, $8);
+        setvar($$, TYPE_GEN, $2);
+        $$->ival = $7->ival;
+        free_parse_tree($7);
+    }
+    ;
 
 param_list
     : /* empty */                          { $$ = node(NODE_SEQ, @$, 0); }
@@ -223,13 +276,18 @@ param_list
 
 param
     : TYPE IDENT                           { $$ = node_param($1, 0, $2, @$); }
-    | TYPE dims IDENT                      { $$ = node_param($1, 1, $3, @$); free_ast($2); }
+    | TYPE dims IDENT                      { $$ = node_param($1, 1, $3, @$); free_parse_tree($2); }
+    | dict_type IDENT                      { $$ = $1; setname($$, $2); }
+    | chan_type IDENT                      { $$ = $1; setname($$, $2); }
+    | gen_type IDENT                       { $$ = $1; setname($$, $2); }
     ;
 
 opt_return
     : /* empty */                          { $$ = TYPE_VOID; }
     | ARROW TYPE                 %prec RET { $$ = $2; }
-    | ARROW TYPE dims %prec RET            { $$ = TYPE_ARRAY; free_ast($3); }
+    | ARROW TYPE dims %prec RET            { $$ = TYPE_ARRAY; free_parse_tree($3); }
+    | ARROW dict_type            %prec RET { $$ = TYPE_DICT; free_parse_tree($2); }
+    | ARROW chan_type            %prec RET { $$ = TYPE_CHAN; free_parse_tree($2); }
     ;
 
 arg_list
@@ -243,6 +301,23 @@ control_stmt
     | IF '(' expr ')' stmt_end ELSE stmt_end                  { $$ = node(NODE_IFELSE, @$, 3, $3, $5, $7); }
     | FOR '(' opt_stmt ';' opt_expr ';' opt_stmt ')' stmt_end { $$ = node(NODE_FOR, @$, 4, $3, $5, $7, $9); }
     | WHILE '(' expr ')' stmt_end                             { $$ = node(NODE_WHILE, @$, 2, $3, $5); }
+    | FOR '(' IDENT IDENT expr ')' stmt_end {
+        /* not a keyword, in stays usable as a name */
+        if ($4 != sym_intern_str("in")) {
+                yyerror("expected for (x in gen())");
+                YYERROR;
+        }
+        $$ = node(NODE_FORIN, @$, 2, $5, $7);
+        setname($$, $3);
+    }
+    | PARFOR '(' TYPE IDENT '=' expr ';' IDENT LT expr ';' IDENT INC ')' stmt_end {
+        if ($3 != TYPE_INT || $4 != $8 || $4 != $12) {
+                yyerror("parfor must be written parfor (int i = start; i < end; i++)");
+                YYERROR;
+        }
+        $$ = node(NODE_PARFOR, @$, 3, $6, $10, $15);
+        setname($$, $4);
+    }
     ;
 
 /* optional statements. ex: for things like for(;;)*/
@@ -288,6 +363,9 @@ extern char* yytext;
 
 void yyerror(const char* s)
 {
+        const char* src;
+        size_t size;
+
         fprintf(stderr, "Parse error: %s\n", s);
 
         fprintf(
@@ -296,25 +374,23 @@ void yyerror(const char* s)
                 yylloc.first_column, s
         );
 
-        if (yyin) {
+        if ((src = lex_source(&size))) {
+                const char* end = src + size;
+                const char* eol;
                 int line = 1;
-                int c;
-                char buf[512];
+                int i;
 
-                fseek(yyin, 0, SEEK_SET);
-
-                while (line < yylloc.first_line && (c = fgetc(yyin)) != EOF) {
-                        if (c == '\n')
+                while (line < yylloc.first_line && src < end) {
+                        if (*src++ == '\n')
                                 line++;
                 }
 
-                if (fgets(buf, sizeof(buf), yyin)) {
-                        int i;
-                        fprintf(stderr, "%s", buf);
+                for (eol = src; eol < end && *eol != '\n'; eol++)
+                        ;
+                fprintf(stderr, "%.*s\n", (int) (eol - src), src);
 
-                        for (i = 0; i <= yylloc.first_column; i++)
-                                fputc(buf[i] == '\t' ? '\t' : ' ', stderr);
-                        fprintf(stderr, "^\n");
-                }
+                for (i = 0; i <= yylloc.first_column && src + i < eol; i++)
+                        fputc(src[i] == '\t' ? '\t' : ' ', stderr);
+                fprintf(stderr, "^\n");
         }
 }
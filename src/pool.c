@@ -0,0 +1,147 @@
+#include "pool.h"
+
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/* the job being run, guarded by lock */
+static PoolFn job_fn;
+static void* job_ctx;
+static unsigned int job_n;
+static unsigned int job_parts;
+static unsigned long generation = 0;
+static unsigned int pending = 0;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cv = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_cv = PTHREAD_COND_INITIALIZER;
+
+/* helper threads, the caller runs part 0 itself */
+static int n_helpers = -1;
+
+/* PUER_THREADS, or one per online cpu */
+int pool_threads(void)
+{
+        const char* env = getenv("PUER_THREADS");
+        long n = env ? atol(env) : sysconf(_SC_NPROCESSORS_ONLN);
+
+        if (n < 1)
+                n = 1;
+        if (n > POOL_MAX_THREADS)
+                n = POOL_MAX_THREADS;
+        return (int) n;
+}
+
+/* how many parts n items are split into */
+unsigned int pool_split(unsigned int n)
+{
+        unsigned int parts = n / POOL_MIN_PART;
+        unsigned int max = (unsigned int) pool_threads();
+
+        if (parts > max)
+                parts = max;
+        return parts ? parts : 1;
+}
+
+static void run_part(PoolFn fn, void* ctx, unsigned int n, unsigned int parts, unsigned int p)
+{
+        unsigned int lo = (unsigned int) ((unsigned long) n * p / parts);
+        unsigned int hi = (unsigned int) ((unsigned long) n * (p + 1) / parts);
+        fn(ctx, lo, hi, p);
+}
+
+static void* helper(void* arg)
+{
+        unsigned int part = (unsigned int) (long) arg;
+        unsigned long seen = 0;
+
+        pthread_mutex_lock(&lock);
+        for (;;) {
+                while (generation == seen)
+                        pthread_cond_wait(&work_cv, &lock);
+                seen = generation;
+                if (part >= job_parts)
+                        continue;
+
+                pthread_mutex_unlock(&lock);
+                run_part(job_fn, job_ctx, job_n, job_parts, part);
+                pthread_mutex_lock(&lock);
+                if (--pending == 0)
+                        pthread_cond_signal(&done_cv);
+        }
+        return NULL;
+}
+
+/* the threads are gone in a forked child, it starts its own */
+static void reset_in_child(void)
+{
+        pthread_mutex_init(&lock, NULL);
+        pthread_cond_init(&work_cv, NULL);
+        pthread_cond_init(&done_cv, NULL);
+        generation = 0;
+        pending = 0;
+        n_helpers = -1;
+}
+
+static void start_helpers(void)
+{
+        static int registered = 0;
+        sigset_t all;
+        sigset_t old;
+        long i;
+
+        if (!registered) {
+                pthread_atfork(NULL, NULL, reset_in_child);
+                registered = 1;
+        }
+
+        /* signals, the profiler's included, stay with the interpreter thread */
+        sigfillset(&all);
+        pthread_sigmask(SIG_SETMASK, &all, &old);
+        n_helpers = 0;
+        for (i = 1; i < pool_threads(); i++) {
+                pthread_t t;
+                if (pthread_create(&t, NULL, helper, (void*) i) != 0)
+                        break;
+                pthread_detach(t);
+                n_helpers++;
+        }
+        pthread_sigmask(SIG_SETMASK, &old, NULL);
+}
+
+/*
+ * calls fn once for each of parts slices of [0, n), slice p covering
+ * [n * p / parts, n * (p + 1) / parts). returns when all are done.
+ */
+void pool_run(PoolFn fn, void* ctx, unsigned int n, unsigned int parts)
+{
+        unsigned int p;
+
+        if (parts > 1 && n_helpers < 0)
+                start_helpers();
+
+        /* without enough threads the caller runs every part in turn */
+        if (parts <= 1 || parts > (unsigned int) n_helpers + 1) {
+                for (p = 0; p < parts; p++)
+                        run_part(fn, ctx, n, parts, p);
+                return;
+        }
+
+        pthread_mutex_lock(&lock);
+        job_fn = fn;
+        job_ctx = ctx;
+        job_n = n;
+        job_parts = parts;
+        pending = parts - 1;
+        generation++;
+        pthread_cond_broadcast(&work_cv);
+        pthread_mutex_unlock(&lock);
+
+        run_part(fn, ctx, n, parts, 0);
+
+        pthread_mutex_lock(&lock);
+        while (pending)
+                pthread_cond_wait(&done_cv, &lock);
+        pthread_mutex_unlock(&lock);
+}
@@ -0,0 +1,241 @@
+#include "profile.h"
+#include "gc_tri.h"
+#include "util.h"
+#include "uthash.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#define PROF_INTERVAL_US 997            /* off a round number to avoid aliasing */
+#define PROF_MAX_DEPTH 256
+#define PROF_BUF_WORDS (1 << 20)
+
+/* top bits of a frame word. the rest is a NodeId */
+#define PROF_BUILTIN 0x80000000U
+/* top bit of a sample's first word. the rest is the depth */
+#define PROF_GC 0x80000000U
+
+/*
+ * the signal handler copies the shadow stack into buf as a depth word
+ * followed by one frame word per level. samples are folded into the
+ * stacks table from normal code, see drain().
+ */
+typedef struct Stack {
+        unsigned int* words;    /* depth word and frames, the hash key */
+        unsigned int n_words;
+        unsigned long count;
+        UT_hash_handle hh;
+} Stack;
+
+int prof_enabled = 0;
+
+static unsigned int shadow[PROF_MAX_DEPTH];
+static volatile sig_atomic_t depth = 0;
+static unsigned int* buf = NULL;
+static volatile sig_atomic_t used = 0;
+static volatile sig_atomic_t dropped = 0;
+static Stack* stacks = NULL;
+static char* out_path = NULL;
+
+static void on_sigprof(int sig)
+{
+        int d = depth < PROF_MAX_DEPTH ? depth : PROF_MAX_DEPTH;
+        int i;
+        (void) sig;
+
+        if (used + d + 1 > PROF_BUF_WORDS) {
+                dropped++;
+                return;
+        }
+
+        buf[used] = (unsigned int) d | (gc_in_collection() ? PROF_GC : 0);
+        for (i = 0; i < d; i++)
+                buf[used + 1 + i] = shadow[i];
+        used += d + 1;
+}
+
+static void block_sigprof(int block)
+{
+        sigset_t set;
+        sigemptyset(&set);
+        sigaddset(&set, SIGPROF);
+        sigprocmask(block ? SIG_BLOCK : SIG_UNBLOCK, &set, NULL);
+}
+
+/* folds the buffered samples into the stacks table */
+static void drain(void)
+{
+        int at = 0;
+
+        block_sigprof(1);
+        while (at < used) {
+                unsigned int n = (buf[at] & ~PROF_GC) + 1;
+                Stack* s;
+
+                HASH_FIND(hh, stacks, &buf[at], n * sizeof(unsigned int), s);
+                if (!s) {
+                        s = malloc(sizeof(Stack));
+                        s->words = malloc(n * sizeof(unsigned int));
+                        memcpy(s->words, &buf[at], n * sizeof(unsigned int));
+                        s->n_words = n;
+                        s->count = 0;
+                        HASH_ADD_KEYPTR(hh, stacks, s->words, n * sizeof(unsigned int), s);
+                }
+                s->count++;
+                at += n;
+        }
+        used = 0;
+        block_sigprof(0);
+}
+
+static void write_frame(FILE* f, unsigned int word)
+{
+        const Node* n = &ast_nodes[word & ~PROF_BUILTIN];
+
+        if (word & PROF_BUILTIN)
+                fprintf(f, ";builtin:%s", sym_name(n->name));
+        else
+                fprintf(f, ";%s:%d", sym_name(n->name), node_lineno(n));
+}
+
+static void write_profile(void)
+{
+        FILE* f = fopen(out_path, "w");
+        Stack* s;
+        Stack* tmp;
+
+        if (!f) {
+                fprintf(stderr, "profile: could not write '%s'\n", out_path);
+                return;
+        }
+
+        HASH_ITER(hh, stacks, s, tmp) {
+                unsigned int i;
+                fprintf(f, "main");
+                for (i = 1; i < s->n_words; i++)
+                        write_frame(f, s->words[i]);
+                if (s->words[0] & PROF_GC)
+                        fprintf(f, ";[gc]");
+                fprintf(f, " %lu\n", s->count);
+        }
+        fclose(f);
+
+        if (dropped)
+                fprintf(stderr, "profile: %ld samples dropped\n", (long) dropped);
+}
+
+/* starts sampling, the profile is written by prof_stop() or at exit */
+int prof_start(const char* path)
+{
+        struct sigaction sa;
+        struct itimerval it;
+
+        buf = malloc(PROF_BUF_WORDS * sizeof(unsigned int));
+        out_path = malloc(strlen(path) + 1);
+        if (!buf || !out_path)
+                return -1;
+        strcpy(out_path, path);
+
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = on_sigprof;
+        sigemptyset(&sa.sa_mask);
+        sa.sa_flags = SA_RESTART;
+        if (sigaction(SIGPROF, &sa, NULL) != 0)
+                return -1;
+
+        it.it_interval.tv_sec = 0;
+        it.it_interval.tv_usec = PROF_INTERVAL_US;
+        it.it_value = it.it_interval;
+        if (setitimer(ITIMER_PROF, &it, NULL) != 0)
+                return -1;
+
+        prof_enabled = 1;
+        /* die() exits, the profile is still wanted */
+        atexit(prof_stop);
+        return 0;
+}
+
+/* stops sampling and writes the profile. must run before the ast is freed */
+void prof_stop(void)
+{
+        struct itimerval it;
+        Stack* s;
+        Stack* tmp;
+
+        if (!prof_enabled)
+                return;
+        prof_enabled = 0;
+
+        memset(&it, 0, sizeof(it));
+        setitimer(ITIMER_PROF, &it, NULL);
+        signal(SIGPROF, SIG_IGN);
+
+        drain();
+        write_profile();
+
+        HASH_ITER(hh, stacks, s, tmp) {
+                HASH_DEL(stacks, s);
+                free(s->words);
+                free(s);
+        }
+        free(buf);
+        free(out_path);
+        buf = NULL;
+        out_path = NULL;
+}
+
+/* node is the FUNCDEF of a user function, or the FUNCCALL of a builtin */
+void prof_push(const Node* node, int is_builtin)
+{
+        if (depth < PROF_MAX_DEPTH)
+                shadow[depth] = (unsigned int) (node - ast_nodes) | (is_builtin ? PROF_BUILTIN : 0);
+        depth++;
+
+        if (used > PROF_BUF_WORDS / 2)
+                drain();
+}
+
+void prof_pop(void)
+{
+        depth--;
+}
+
+/* takes the frames pushed since prof_resume(f) off the shadow stack */
+void prof_suspend(ProfFrames* f)
+{
+        int top = depth < PROF_MAX_DEPTH ? depth : PROF_MAX_DEPTH;
+        int n_words = top > f->base ? top - f->base : 0;
+
+        if (n_words > f->cap) {
+                f->words = realloc(f->words, (size_t) n_words * sizeof(unsigned int));
+                if (!f->words)
+                        die(NULL, "Out of Memory Error");
+                f->cap = n_words;
+        }
+        if (n_words > 0)
+                memcpy(f->words, shadow + f->base, (size_t) n_words * sizeof(unsigned int));
+        f->n_words = n_words;
+        f->n = depth - f->base;
+        depth = f->base;
+}
+
+/* puts them back on top of the resumer's frames */
+void prof_resume(ProfFrames* f)
+{
+        int i;
+
+        f->base = depth;
+        for (i = 0; i < f->n_words && depth + i < PROF_MAX_DEPTH; i++)
+                shadow[depth + i] = f->words[i];
+        depth += f->n;
+}
+
+void prof_frames_free(ProfFrames* f)
+{
+        free(f->words);
+        f->words = NULL;
+        f->n = f->n_words = f->cap = 0;
+}
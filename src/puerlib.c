@@ -10,6 +10,20 @@
 #include "arraylist.h"
 #include "puerstring.h"
 #include "scan.h"
+#include "rec.h"
+#include "dict.h"
+#include "env.h"
+#include "gc_tri.h"
+#include "heapdump.h"
+#include "snapshot.h"
+#include "parfor.h"
+#include "task.h"
+#include "gen.h"
+#include "func.h"
+#include "pool.h"
+#include "loop.h"
+#include "file.h"
+#include "output.h"
 #include "util.h"
 
 #include <termios.h>
@@ -27,6 +41,7 @@ Var getch(Node* node, Var* argv)
 
         struct termios oldattr, newattr;
         int ch;
+        out_flush();
         tcgetattr( STDIN_FILENO, &oldattr );
         newattr = oldattr;
         newattr.c_lflag &= ~( ICANON | ECHO );
@@ -43,20 +58,19 @@ Var getch(Node* node, Var* argv)
 
 Var input(Node* node, Var* argv)
 {
-        unsigned int chunk = 64;
-        unsigned int bufcap = chunk;
+        unsigned int bufcap = 64;
         unsigned int len = 0;
         char* buf = gc_alloc(bufcap, scan_raw);
         int c;
         Var out;
         String* prompt = argv[0].data.s;
 
-        fputs(prompt->data, stdout);
-        fflush(stdout);
+        out_write(prompt->data, prompt->length);
+        out_flush();
 
         while ((c = fgetc(stdin)) != EOF && c != '\n') {
                 if (len + 1 >= bufcap) {
-                        bufcap += chunk;
+                        bufcap *= 2;
                         buf = gc_realloc(buf, bufcap, scan_raw);
                         if (!buf)
                                 die(node, "Error: Out of memory in input()");
@@ -66,6 +80,8 @@ Var input(Node* node, Var* argv)
 
         buf[len] = '\0';
         set_string(&out, buf);
+        /* set_string copies, scratch buffer is dead */
+        gc_free(buf);
 
         return out;
 }
@@ -75,8 +91,8 @@ Var clear(Node* node, Var* argv)
         Var out;
         (void) argv;
         (void) node;
-        fputs("\x1b[2J\x1b[H", stdout);
-        fflush(stdout);
+        out_str("\x1b[2J\x1b[H");
+        out_flush();
         set_void(&out);
         return out;
 }
@@ -86,13 +102,23 @@ Var testlib(Node* node, Var* argv)
         Var out;
         (void) argv;
         (void) node;
-        fputs("Puer Standard Library !!\n", stdout);
-        fflush(stdout);
+        out_str("Puer Standard Library !!\n");
+        out_flush();
         set_void(&out);
         return out;
 }
 
-Var len(Node* node, Var* argv)
+Var puer_flush(Node* node, Var* argv)
+{
+        Var out;
+        (void) argv;
+        (void) node;
+        out_flush();
+        set_void(&out);
+        return out;
+}
+
+Var puer_len(Node* node, Var* argv)
 {
         Var container = argv[0];
         Var out;
@@ -103,13 +129,16 @@ Var len(Node* node, Var* argv)
         case TYPE_STRING:
                 set_int(&out, container.data.s->length);
                 break;
+        case TYPE_DICT:
+                set_int(&out, container.data.d->size);
+                break;
         default:
-                die(node, "Expected type array or string for len()");
+                die(node, "Expected type array, string or dict for len()");
         }
         return out;
 }
 
-Var append(Node* node, Var* argv)
+Var puer_append(Node* node, Var* argv)
 {
         Var a = argv[0];
         Var v = argv[1];
@@ -128,6 +157,8 @@ Var append(Node* node, Var* argv)
                 );
         }
 
+        if (parfor_worker)
+                parfor_check_owned(node, arr, "append to an array");
         arraylist_push(arr, v);
         set_void(&out);
         return out;
@@ -143,6 +174,109 @@ Var gc_collect(Node* node, Var* argv)
         return out;
 }
 
+/* field layout of the record returned by gc_stats() */
+static const char* gcstats_fields[] = {
+        "bytes_allocated",
+        "objects_allocated",
+        "live_bytes",
+        "live_objects",
+        "heap_bytes",
+        "heap_objects",
+        "cycles",
+        "last_mark_ms",
+        "last_sweep_ms",
+        "max_pause_ms",
+        "freed_raw",
+        "freed_strings",
+        "freed_arrays",
+        "freed_entries",
+        "freed_scopes",
+        "freed_recs",
+        "freed_recdefs",
+        "freed_dicts",
+        "freed_other",
+        "compactions",
+        "bytes_compacted"
+};
+
+#define GCSTATS_NFIELDS (sizeof(gcstats_fields) / sizeof(gcstats_fields[0]))
+#define GCSTATS_FIRST_FLOAT 7
+#define GCSTATS_FIRST_FREED 10
+
+static Symbol gcstats_sym;
+
+static void init_gcstats_rec(void)
+{
+        Var defs[GCSTATS_NFIELDS];
+        Symbol names[GCSTATS_NFIELDS];
+        unsigned int i;
+
+        gcstats_sym = sym_intern_str(GCSTATS_REC);
+        for (i = 0; i < GCSTATS_NFIELDS; i++) {
+                names[i] = sym_intern_str(gcstats_fields[i]);
+                if (i >= GCSTATS_FIRST_FLOAT && i < GCSTATS_FIRST_FREED)
+                        set_float(&defs[i], 0.0f);
+                else
+                        set_long(&defs[i], 0);
+        }
+        recdef_register(recdef_new(gcstats_sym, names, defs, GCSTATS_NFIELDS));
+}
+
+Var gc_stats(Node* node, Var* argv)
+{
+        const GC_Stats* st = gc_get_stats();
+        RecInst* ri = rec_new(gcstats_sym);
+        Var* f = ri->fields;
+        Var out;
+        (void) argv;
+        (void) node;
+
+        set_long(&f[0], (long) st->bytes_allocated);
+        set_long(&f[1], (long) st->objects_allocated);
+        set_long(&f[2], (long) st->live_bytes);
+        set_long(&f[3], (long) st->live_objects);
+        set_long(&f[4], (long) st->heap_bytes);
+        set_long(&f[5], (long) st->heap_objects);
+        set_long(&f[6], (long) st->cycles);
+        set_float(&f[7], (float) st->last_mark_ms);
+        set_float(&f[8], (float) st->last_sweep_ms);
+        set_float(&f[9], (float) st->max_pause_ms);
+        set_long(&f[10], (long) st->freed[GC_KIND_RAW]);
+        set_long(&f[11], (long) st->freed[GC_KIND_STRING]);
+        set_long(&f[12], (long) st->freed[GC_KIND_ARRAY]);
+        set_long(&f[13], (long) st->freed[GC_KIND_VARENTRY]);
+        set_long(&f[14], (long) st->freed[GC_KIND_SCOPE]);
+        set_long(&f[15], (long) st->freed[GC_KIND_REC]);
+        set_long(&f[16], (long) st->freed[GC_KIND_RECDEF]);
+        set_long(&f[17], (long) st->freed[GC_KIND_DICT]);
+        set_long(&f[18], (long) st->freed[GC_KIND_OTHER]);
+        set_long(&f[19], (long) st->compactions);
+        set_long(&f[20], (long) st->bytes_compacted);
+
+        set_rec(&out, ri);
+        return out;
+}
+
+Var puer_heap_dump(Node* node, Var* argv)
+{
+        Var out;
+        String* path = argv[0].data.s;
+        (void) node;
+        set_bool(&out, heap_dump(path->data) == 0);
+        return out;
+}
+
+Var puer_snapshot(Node* node, Var* argv)
+{
+        Var out;
+        String* path = argv[0].data.s;
+        /* a restore resumes at the next top-level statement, locals are lost */
+        if (env_stack && env_stack->next)
+                die(node, "snapshot: only allowed in a top-level statement, outside any block or function");
+        set_bool(&out, snapshot_write(path->data) == 0);
+        return out;
+}
+
 Var randrange(Node* node, Var* argv)
 {
         Var out;
@@ -166,17 +300,808 @@ Var puer_abs(Node* node, Var* argv)
         return out;
 }
 
+Var puer_has(Node* node, Var* argv)
+{
+        Var out;
+        set_bool(&out, dict_has(node, argv[0].data.d, argv[1]));
+        return out;
+}
+
+/* true when the key was there */
+Var puer_del(Node* node, Var* argv)
+{
+        Var out;
+        set_bool(&out, dict_remove(node, argv[0].data.d, argv[1]));
+        return out;
+}
+
+Var puer_reserve(Node* node, Var* argv)
+{
+        Var out;
+        dict_reserve(node, argv[0].data.d, argv[1].data.i);
+        set_void(&out);
+        return out;
+}
+
+/* in slot order, which is the order print and values() use */
+Var puer_keys(Node* node, Var* argv)
+{
+        Var out;
+        (void) node;
+        set_array(&out, dict_keys(argv[0].data.d));
+        return out;
+}
+
+Var puer_values(Node* node, Var* argv)
+{
+        Var out;
+        (void) node;
+        set_array(&out, dict_values(argv[0].data.d));
+        return out;
+}
+
+Var puer_join(Node* node, Var* argv)
+{
+        return task_join(node, argv[0].data.i);
+}
+
+Var puer_send(Node* node, Var* argv)
+{
+        Var out;
+        chan_send(node, argv[0].data.ch, argv[1]);
+        set_void(&out);
+        return out;
+}
+
+Var puer_recv(Node* node, Var* argv)
+{
+        return chan_recv(node, argv[0].data.ch);
+}
+
+/* a channel, or a file from open */
+Var puer_close(Node* node, Var* argv)
+{
+        Var out;
+
+        if (argv[0].type == TYPE_CHAN)
+                chan_close(node, argv[0].data.ch);
+        else if (argv[0].type == TYPE_INT)
+                file_close(node, argv[0].data.i);
+        else
+                die(node, "close: expected a channel or a file, got type %d", argv[0].type);
+        set_void(&out);
+        return out;
+}
+
+/* true once this process closed the channel or received its close */
+Var puer_closed(Node* node, Var* argv)
+{
+        Var out;
+        (void) node;
+        set_bool(&out, argv[0].data.ch->closed);
+        return out;
+}
+
+Var puer_next(Node* node, Var* argv)
+{
+        return gen_take(node, argv[0].data.g);
+}
+
+Var puer_done(Node* node, Var* argv)
+{
+        Var out;
+        set_bool(&out, !gen_ready(node, argv[0].data.g));
+        return out;
+}
+
+Var puer_pmap(Node* node, Var* argv)
+{
+        String* name = argv[0].data.s;
+        Node* func = func_get(sym_intern(name->data, name->length));
+        Var out;
+
+        if (!func)
+                die(node, "pmap: undefined function '%s'", name->data);
+        set_array(&out, task_map(node, func, argv[1].data.a, argv[2].data.i));
+        return out;
+}
+
+Var puer_open(Node* node, Var* argv)
+{
+        Var out;
+        set_int(&out, file_open(node, argv[0].data.s->data, argv[1].data.s->data));
+        return out;
+}
+
+Var puer_eof(Node* node, Var* argv)
+{
+        Var out;
+        set_bool(&out, file_eof(node, argv[0].data.i));
+        return out;
+}
+
+Var puer_read_line(Node* node, Var* argv)
+{
+        Var out;
+        out.type = TYPE_STRING;
+        out.data.s = file_read_line(node, argv[0].data.i);
+        return out;
+}
+
+Var puer_read_all(Node* node, Var* argv)
+{
+        Var out;
+        out.type = TYPE_STRING;
+        out.data.s = file_read_all(node, argv[0].data.i);
+        return out;
+}
+
+Var puer_write(Node* node, Var* argv)
+{
+        Var out;
+        file_write(node, argv[0].data.i, argv[1].data.s, 0);
+        set_void(&out);
+        return out;
+}
+
+Var puer_write_line(Node* node, Var* argv)
+{
+        Var out;
+        file_write(node, argv[0].data.i, argv[1].data.s, 1);
+        set_void(&out);
+        return out;
+}
+
+Var puer_lines(Node* node, Var* argv)
+{
+        Var out;
+        out.type = TYPE_GEN;
+        out.data.g = file_lines(node, argv[0].data.s->data);
+        return out;
+}
+
+Var puer_map_file(Node* node, Var* argv)
+{
+        Var out;
+        out.type = TYPE_STRING;
+        out.data.s = file_map(node, argv[0].data.s->data);
+        return out;
+}
+
+/* the function a callback builtin was given by name */
+static Node* named_func(Node* node, const char* what, String* name)
+{
+        Node* func = func_get(sym_intern(name->data, name->length));
+
+        if (!func)
+                die(node, "%s: undefined function '%s'", what, name->data);
+        return func;
+}
+
+Var puer_open_fd(Node* node, Var* argv)
+{
+        Var out;
+        set_int(&out, loop_open(node, argv[0].data.s->data, argv[1].data.s->data));
+        return out;
+}
+
+Var puer_open_pipe(Node* node, Var* argv)
+{
+        Var out;
+        set_int(&out, loop_open_pipe(node, argv[0].data.s->data, argv[1].data.s->data));
+        return out;
+}
+
+Var puer_close_fd(Node* node, Var* argv)
+{
+        Var out;
+        loop_close(node, argv[0].data.i);
+        set_void(&out);
+        return out;
+}
+
+Var puer_on_read(Node* node, Var* argv)
+{
+        Var out;
+        loop_on_read(node, argv[0].data.i, named_func(node, "on_read", argv[1].data.s));
+        set_void(&out);
+        return out;
+}
+
+Var puer_write_async(Node* node, Var* argv)
+{
+        Var out;
+        loop_write(node, argv[0].data.i, argv[1].data.s);
+        set_void(&out);
+        return out;
+}
+
+Var puer_after(Node* node, Var* argv)
+{
+        Var out;
+        set_int(&out, loop_timer(node, argv[0].data.i, 0, named_func(node, "after", argv[1].data.s)));
+        return out;
+}
+
+Var puer_every(Node* node, Var* argv)
+{
+        Var out;
+        set_int(&out, loop_timer(node, argv[0].data.i, 1, named_func(node, "every", argv[1].data.s)));
+        return out;
+}
+
+Var puer_cancel(Node* node, Var* argv)
+{
+        Var out;
+        (void) node;
+        loop_cancel(argv[0].data.i);
+        set_void(&out);
+        return out;
+}
+
+Var puer_run_loop(Node* node, Var* argv)
+{
+        Var out;
+        (void) argv;
+        loop_run(node);
+        set_void(&out);
+        return out;
+}
+
+Var puer_stop_loop(Node* node, Var* argv)
+{
+        Var out;
+        (void) node;
+        (void) argv;
+        loop_stop();
+        set_void(&out);
+        return out;
+}
+
+/*
+ * whole array loops for the numeric builtins below. they read the items
+ * in place instead of going through eval_idx for every element. int and
+ * long arithmetic wraps through the unsigned type, float sums add in
+ * order, so the results match the equivalent loop in a script.
+ *
+ * every kernel works on a range of items, so large arrays can be split
+ * between the threads of the pool. float sums and dot products stay in
+ * one part, adding in a different order would round differently.
+ */
+#define DEFINE_ARRAY_KERNELS(type, ctype, acc_type, field) \
+        static Var sum_##type(const Var* it, const Var* end) { \
+                acc_type s = 0; \
+                Var out; \
+                for (; it < end; it++) \
+                        s += (acc_type) it->data.field; \
+                set_##type(&out, (ctype) s); \
+                return out; \
+        } \
+        static Var extreme_##type(const Var* it, const Var* end, int want_max) { \
+                ctype best = it->data.field; \
+                Var out; \
+                if (want_max) { \
+                        for (it++; it < end; it++) \
+                                if (it->data.field > best) \
+                                        best = it->data.field; \
+                } \
+                else { \
+                        for (it++; it < end; it++) \
+                                if (it->data.field < best) \
+                                        best = it->data.field; \
+                } \
+                set_##type(&out, best); \
+                return out; \
+        } \
+        static Var dot_##type(const Var* x, const Var* end, const Var* y) { \
+                acc_type s = 0; \
+                Var out; \
+                for (; x < end; x++, y++) \
+                        s += (acc_type) x->data.field * (acc_type) y->data.field; \
+                set_##type(&out, (ctype) s); \
+                return out; \
+        } \
+        static void scale_##type(Var* it, Var* end, Var k) { \
+                acc_type by = (acc_type) k.data.field; \
+                for (; it < end; it++) \
+                        it->data.field = (ctype) ((acc_type) it->data.field * by); \
+        } \
+        static void add_arrays_##type(Var* it, Var* end, const Var* from) { \
+                for (; it < end; it++, from++) \
+                        it->data.field = (ctype) ((acc_type) it->data.field + (acc_type) from->data.field); \
+        }
+
+DEFINE_ARRAY_KERNELS(int, int, unsigned int, i)
+DEFINE_ARRAY_KERNELS(uint, unsigned int, unsigned int, ui)
+DEFINE_ARRAY_KERNELS(long, long, unsigned long, l)
+DEFINE_ARRAY_KERNELS(float, float, float, f)
+
+typedef struct ArrayKernels {
+        Var (*sum)(const Var* it, const Var* end);
+        Var (*extreme)(const Var* it, const Var* end, int want_max);
+        Var (*dot)(const Var* x, const Var* end, const Var* y);
+        void (*scale)(Var* it, Var* end, Var k);
+        void (*add)(Var* it, Var* end, const Var* from);
+} ArrayKernels;
+
+/* indexed by VarType, in enum order */
+static const ArrayKernels array_kernels[] = {
+        { sum_int,   extreme_int,   dot_int,   scale_int,   add_arrays_int },
+        { sum_uint,  extreme_uint,  dot_uint,  scale_uint,  add_arrays_uint },
+        { sum_long,  extreme_long,  dot_long,  scale_long,  add_arrays_long },
+        { sum_float, extreme_float, dot_float, scale_float, add_arrays_float }
+};
+
+#define DEFINE_COMPARE(type, ctype, field) \
+        static int compare_##type(const void* a, const void* b) { \
+                ctype x = ((const Var*) a)->data.field; \
+                ctype y = ((const Var*) b)->data.field; \
+                return (x > y) - (x < y); \
+        }
+
+DEFINE_COMPARE(int, int, i)
+DEFINE_COMPARE(uint, unsigned int, ui)
+DEFINE_COMPARE(long, long, l)
+DEFINE_COMPARE(float, float, f)
+DEFINE_COMPARE(bool, int, b)
+DEFINE_COMPARE(char, char, c)
+
+static int compare_str(const void* a, const void* b)
+{
+        const String* x = ((const Var*) a)->data.s;
+        const String* y = ((const Var*) b)->data.s;
+        int c = memcmp(x->data, y->data, x->length < y->length ? x->length : y->length);
+        if (c)
+                return c;
+        return (x->length > y->length) - (x->length < y->length);
+}
+
+/* one builtin call, shared by the pool threads running its parts */
+typedef struct ArrayJob {
+        const ArrayKernels* k;
+        Var* a;
+        const Var* b;
+        Var arg;
+        int want_max;
+        int (*compare)(const void* a, const void* b);
+        Var* tmp;                               /* sort: merge buffer */
+        unsigned int bounds[POOL_MAX_THREADS + 1]; /* sort: the sorted runs */
+        unsigned int runs;
+        unsigned int width;
+        Var part[POOL_MAX_THREADS];             /* reductions: one result per part */
+} ArrayJob;
+
+static void sum_part(void* ctx, unsigned int lo, unsigned int hi, unsigned int p)
+{
+        ArrayJob* j = ctx;
+        j->part[p] = j->k->sum(j->a + lo, j->a + hi);
+}
+
+static void extreme_part(void* ctx, unsigned int lo, unsigned int hi, unsigned int p)
+{
+        ArrayJob* j = ctx;
+        j->part[p] = j->k->extreme(j->a + lo, j->a + hi, j->want_max);
+}
+
+static void dot_part(void* ctx, unsigned int lo, unsigned int hi, unsigned int p)
+{
+        ArrayJob* j = ctx;
+        j->part[p] = j->k->dot(j->a + lo, j->a + hi, j->b + lo);
+}
+
+static void scale_part(void* ctx, unsigned int lo, unsigned int hi, unsigned int p)
+{
+        ArrayJob* j = ctx;
+        (void) p;
+        j->k->scale(j->a + lo, j->a + hi, j->arg);
+}
+
+static void add_part(void* ctx, unsigned int lo, unsigned int hi, unsigned int p)
+{
+        ArrayJob* j = ctx;
+        (void) p;
+        j->k->add(j->a + lo, j->a + hi, j->b + lo);
+}
+
+static void fill_part(void* ctx, unsigned int lo, unsigned int hi, unsigned int p)
+{
+        ArrayJob* j = ctx;
+        Var* it = j->a + lo;
+        Var* end = j->a + hi;
+        (void) p;
+        for (; it < end; it++)
+                *it = j->arg;
+}
+
+static void copy_part(void* ctx, unsigned int lo, unsigned int hi, unsigned int p)
+{
+        ArrayJob* j = ctx;
+        (void) p;
+        memcpy(j->a + lo, j->b + lo, sizeof(Var) * (hi - lo));
+}
+
+static void count_part(void* ctx, unsigned int lo, unsigned int hi, unsigned int p)
+{
+        ArrayJob* j = ctx;
+        const Var* it = j->a + lo;
+        const Var* end = j->a + hi;
+        Var v = j->arg;
+        int n = 0;
+
+        switch (v.type) {
+        case TYPE_INT:
+        case TYPE_BOOL:
+                for (; it < end; it++)
+                        n += it->data.i == v.data.i;
+                break;
+        case TYPE_UINT:
+                for (; it < end; it++)
+                        n += it->data.ui == v.data.ui;
+                break;
+        case TYPE_LONG:
+                for (; it < end; it++)
+                        n += it->data.l == v.data.l;
+                break;
+        case TYPE_FLOAT:
+                for (; it < end; it++)
+                        n += it->data.f == v.data.f;
+                break;
+        case TYPE_CHAR:
+                for (; it < end; it++)
+                        n += it->data.c == v.data.c;
+                break;
+        default:
+                for (; it < end; it++) {
+                        n += it->data.s->length == v.data.s->length
+                                && memcmp(it->data.s->data, v.data.s->data, v.data.s->length) == 0;
+                }
+                break;
+        }
+        set_int(&j->part[p], n);
+}
+
+static void sort_part(void* ctx, unsigned int lo, unsigned int hi, unsigned int p)
+{
+        ArrayJob* j = ctx;
+        (void) p;
+        qsort(j->a + lo, hi - lo, sizeof(Var), j->compare);
+}
+
+/* merges sorted runs p * 2w and p * 2w + w from a into tmp */
+static void merge_part(void* ctx, unsigned int lo, unsigned int hi, unsigned int p)
+{
+        ArrayJob* j = ctx;
+        unsigned int r = p * 2 * j->width;
+        unsigned int mid = j->bounds[r + j->width < j->runs ? r + j->width : j->runs];
+        unsigned int end = j->bounds[r + 2 * j->width < j->runs ? r + 2 * j->width : j->runs];
+        const Var* x = j->a + j->bounds[r];
+        const Var* y = j->a + mid;
+        Var* out = j->tmp + j->bounds[r];
+        (void) lo;
+        (void) hi;
+
+        while (x < j->a + mid && y < j->a + end)
+                *out++ = j->compare(y, x) < 0 ? *y++ : *x++;
+        while (x < j->a + mid)
+                *out++ = *x++;
+        while (y < j->a + end)
+                *out++ = *y++;
+}
+
+/* how many parts n items go in, one when the result depends on the order */
+static unsigned int run_parts(PoolFn fn, ArrayJob* j, unsigned int n, int ordered)
+{
+        unsigned int parts = ordered ? 1 : pool_split(n);
+        pool_run(fn, j, n, parts);
+        return parts;
+}
+
+static const ArrayKernels* kernels_for(Node* node, const char* fn, const ArrayList* a)
+{
+        if (a->type > TYPE_FLOAT)
+                die(node, "%s: expected an int, uint, long or float array, got elements of type %d", fn, a->type);
+        return &array_kernels[a->type];
+}
+
+static void check_same_shape(Node* node, const char* fn, const ArrayList* a, const ArrayList* b)
+{
+        if (a->type != b->type)
+                die(node, "%s: element type mismatch (%d and %d)", fn, a->type, b->type);
+        if (a->size != b->size)
+                die(node, "%s: length mismatch (%u and %u)", fn, a->size, b->size);
+}
+
+/* v as the element type of a, when the conversion loses nothing */
+static Var elem_arg(Node* node, const char* fn, const ArrayList* a, Var v)
+{
+        if (v.type == a->type)
+                return v;
+        if (a->type > TYPE_BOOL || v.type > TYPE_BOOL || common_type(a->type, v.type) != a->type)
+                die(node, "%s: expected a value of type %d, got %d", fn, a->type, v.type);
+        cast_to(&v, a->type);
+        return v;
+}
+
+Var puer_sum(Node* node, Var* argv)
+{
+        ArrayList* a = argv[0].data.a;
+        ArrayJob j;
+        unsigned int parts;
+
+        j.k = kernels_for(node, "sum", a);
+        j.a = a->items;
+        parts = run_parts(sum_part, &j, a->size, a->type == TYPE_FLOAT);
+        return parts == 1 ? j.part[0] : j.k->sum(j.part, j.part + parts);
+}
+
+static Var array_extreme(Node* node, const char* fn, ArrayList* a, int want_max)
+{
+        ArrayJob j;
+        unsigned int parts;
+
+        j.k = kernels_for(node, fn, a);
+        if (a->size == 0)
+                die(node, "%s: empty array", fn);
+        j.a = a->items;
+        j.want_max = want_max;
+        parts = run_parts(extreme_part, &j, a->size, 0);
+        return j.k->extreme(j.part, j.part + parts, want_max);
+}
+
+Var puer_min(Node* node, Var* argv)
+{
+        return array_extreme(node, "min", argv[0].data.a, 0);
+}
+
+Var puer_max(Node* node, Var* argv)
+{
+        return array_extreme(node, "max", argv[0].data.a, 1);
+}
+
+Var puer_dot(Node* node, Var* argv)
+{
+        ArrayList* a = argv[0].data.a;
+        ArrayList* b = argv[1].data.a;
+        ArrayJob j;
+        unsigned int parts;
+
+        j.k = kernels_for(node, "dot", a);
+        check_same_shape(node, "dot", a, b);
+        j.a = a->items;
+        j.b = b->items;
+        parts = run_parts(dot_part, &j, a->size, a->type == TYPE_FLOAT);
+        return parts == 1 ? j.part[0] : j.k->sum(j.part, j.part + parts);
+}
+
+/* multiplies every element in place */
+Var puer_scale(Node* node, Var* argv)
+{
+        ArrayList* a = argv[0].data.a;
+        ArrayJob j;
+        Var out;
+
+        j.k = kernels_for(node, "scale", a);
+        if (parfor_worker)
+                parfor_check_owned(node, a, "scale an array");
+        j.a = a->items;
+        j.arg = elem_arg(node, "scale", a, argv[1]);
+        run_parts(scale_part, &j, a->size, 0);
+        set_void(&out);
+        return out;
+}
+
+/* dst[i] += src[i] */
+Var puer_add_arrays(Node* node, Var* argv)
+{
+        ArrayList* dst = argv[0].data.a;
+        ArrayList* src = argv[1].data.a;
+        ArrayJob j;
+        Var out;
+
+        j.k = kernels_for(node, "add_arrays", dst);
+        check_same_shape(node, "add_arrays", dst, src);
+        if (parfor_worker)
+                parfor_check_owned(node, dst, "add to an array");
+        j.a = dst->items;
+        j.b = src->items;
+        run_parts(add_part, &j, dst->size, 0);
+        set_void(&out);
+        return out;
+}
+
+/* scalar element types only, a string or record would be shared by every slot */
+Var puer_fill(Node* node, Var* argv)
+{
+        ArrayList* a = argv[0].data.a;
+        ArrayJob j;
+        Var out;
+
+        if (a->type > TYPE_BOOL && a->type != TYPE_CHAR)
+                die(node, "fill: expected an array of a scalar type, got elements of type %d", a->type);
+        j.arg = elem_arg(node, "fill", a, argv[1]);
+        j.arg.is_const = 0;
+        if (parfor_worker)
+                parfor_check_owned(node, a, "fill an array");
+        j.a = a->items;
+        run_parts(fill_part, &j, a->size, 0);
+        set_void(&out);
+        return out;
+}
+
+/* dst[i] = src[i], scalar element types only for the same reason */
+Var puer_copy(Node* node, Var* argv)
+{
+        ArrayList* dst = argv[0].data.a;
+        ArrayList* src = argv[1].data.a;
+        ArrayJob j;
+        Var out;
+
+        if (dst->type > TYPE_BOOL && dst->type != TYPE_CHAR)
+                die(node, "copy: expected an array of a scalar type, got elements of type %d", dst->type);
+        check_same_shape(node, "copy", dst, src);
+        if (parfor_worker)
+                parfor_check_owned(node, dst, "copy into an array");
+        j.a = dst->items;
+        j.b = src->items;
+        if (j.a != j.b)
+                run_parts(copy_part, &j, dst->size, 0);
+        set_void(&out);
+        return out;
+}
+
+Var puer_count_eq(Node* node, Var* argv)
+{
+        ArrayList* a = argv[0].data.a;
+        ArrayJob j;
+        unsigned int parts;
+        unsigned int p;
+        int n = 0;
+        Var out;
+
+        if (a->type > TYPE_CHAR)
+                die(node, "count_eq: expected an array of a scalar type or str, got elements of type %d", a->type);
+        j.arg = elem_arg(node, "count_eq", a, argv[1]);
+        j.a = a->items;
+        parts = run_parts(count_part, &j, a->size, 0);
+        for (p = 0; p < parts; p++)
+                n += j.part[p].data.i;
+        set_int(&out, n);
+        return out;
+}
+
+/*
+ * sorts ascending in place. large arrays are sorted in parts on the pool
+ * threads, then the sorted runs are merged in pairs, also in parallel.
+ */
+Var puer_sort(Node* node, Var* argv)
+{
+        ArrayList* a = argv[0].data.a;
+        unsigned int n = a->size;
+        unsigned int parts;
+        unsigned int p;
+        ArrayJob j;
+        Var out;
+
+        switch (a->type) {
+        case TYPE_INT:
+                j.compare = compare_int;
+                break;
+        case TYPE_UINT:
+                j.compare = compare_uint;
+                break;
+        case TYPE_LONG:
+                j.compare = compare_long;
+                break;
+        case TYPE_FLOAT:
+                j.compare = compare_float;
+                break;
+        case TYPE_BOOL:
+                j.compare = compare_bool;
+                break;
+        case TYPE_CHAR:
+                j.compare = compare_char;
+                break;
+        case TYPE_STRING:
+                j.compare = compare_str;
+                break;
+        default:
+                die(node, "sort: expected an array of a scalar type or str, got elements of type %d", a->type);
+        }
+        if (parfor_worker)
+                parfor_check_owned(node, a, "sort an array");
+
+        j.a = a->items;
+        parts = run_parts(sort_part, &j, n, 0);
+        set_void(&out);
+        if (parts == 1)
+                return out;
+
+        j.tmp = malloc(sizeof(Var) * n);
+        if (!j.tmp)
+                die(NULL, "Out of Memory Error");
+        j.runs = parts;
+        for (p = 0; p <= parts; p++)
+                j.bounds[p] = (unsigned int) ((unsigned long) n * p / parts);
+
+        for (j.width = 1; j.width < parts; j.width *= 2) {
+                unsigned int merges = (parts + 2 * j.width - 1) / (2 * j.width);
+                Var* swap;
+                pool_run(merge_part, &j, merges, merges);
+                swap = j.a;
+                j.a = j.tmp;
+                j.tmp = swap;
+        }
+        if (j.a != a->items) {
+                memcpy(a->items, j.a, sizeof(Var) * n);
+                j.tmp = j.a;
+        }
+        free(j.tmp);
+        return out;
+}
+
+/* record types used by builtins, must be known to the lexer before parsing */
+void init_puerlib_recnames(void)
+{
+        recname_register(sym_intern_str(GCSTATS_REC));
+}
+
 void init_puerlib(void)
 {
         srand(time(NULL));
+        init_gcstats_rec();
 
         builtin_register("input",      input,      TYPE_STRING, 1, TYPE_STRING);
         builtin_register("testlib",    testlib,    TYPE_VOID,   0);
         builtin_register("getch",      getch,      TYPE_INT,    0);
         builtin_register("clear",      clear,      TYPE_VOID,   0);
-        builtin_register("len",        len,        TYPE_INT,    1, TYPE_ANY);
-        builtin_register("append",     append,     TYPE_VOID,   2, TYPE_ANY, TYPE_ANY);
+        builtin_register("flush",      puer_flush, TYPE_VOID,   0);
+        builtin_register("len",        puer_len,   TYPE_INT,    1, TYPE_ANY);
+        builtin_register("append",     puer_append, TYPE_VOID,   2, TYPE_ANY, TYPE_ANY);
         builtin_register("gc_collect", gc_collect, TYPE_VOID,   0);
+        builtin_register("gc_stats",   gc_stats,   TYPE_REC,    0);
+        builtin_register("heap_dump",  puer_heap_dump, TYPE_BOOL, 1, TYPE_STRING);
+        builtin_register("snapshot",   puer_snapshot, TYPE_BOOL, 1, TYPE_STRING);
         builtin_register("randrange",  randrange,  TYPE_INT,    2, TYPE_INT, TYPE_INT);
         builtin_register("abs",        puer_abs,   TYPE_INT,    1, TYPE_INT);
+        builtin_register("has",        puer_has,   TYPE_BOOL,   2, TYPE_DICT, TYPE_ANY);
+        builtin_register("del",        puer_del,   TYPE_BOOL,   2, TYPE_DICT, TYPE_ANY);
+        builtin_register("reserve",    puer_reserve, TYPE_VOID, 2, TYPE_DICT, TYPE_INT);
+        builtin_register("keys",       puer_keys,  TYPE_ARRAY,  1, TYPE_DICT);
+        builtin_register("values",     puer_values, TYPE_ARRAY, 1, TYPE_DICT);
+        builtin_register("join",       puer_join,  TYPE_ANY,    1, TYPE_INT);
+        builtin_register("send",       puer_send,  TYPE_VOID,   2, TYPE_CHAN, TYPE_ANY);
+        builtin_register("recv",       puer_recv,  TYPE_ANY,    1, TYPE_CHAN);
+        builtin_register("close",      puer_close, TYPE_VOID,   1, TYPE_ANY);
+        builtin_register("closed",     puer_closed, TYPE_BOOL,  1, TYPE_CHAN);
+        builtin_register("next",       puer_next,  TYPE_ANY,    1, TYPE_GEN);
+        builtin_register("done",       puer_done,  TYPE_BOOL,   1, TYPE_GEN);
+        builtin_register("pmap",       puer_pmap,  TYPE_ARRAY,  3, TYPE_STRING, TYPE_ARRAY, TYPE_INT);
+        builtin_register("open",       puer_open,  TYPE_INT,    2, TYPE_STRING, TYPE_STRING);
+        builtin_register("eof",        puer_eof,   TYPE_BOOL,   1, TYPE_INT);
+        builtin_register("read_line",  puer_read_line, TYPE_STRING, 1, TYPE_INT);
+        builtin_register("read_all",   puer_read_all, TYPE_STRING, 1, TYPE_INT);
+        builtin_register("write",      puer_write, TYPE_VOID,   2, TYPE_INT, TYPE_STRING);
+        builtin_register("write_line", puer_write_line, TYPE_VOID, 2, TYPE_INT, TYPE_STRING);
+        builtin_register("lines",      puer_lines, TYPE_GEN,    1, TYPE_STRING);
+        builtin_register("map_file",   puer_map_file, TYPE_STRING, 1, TYPE_STRING);
+        builtin_register("open_fd",    puer_open_fd, TYPE_INT,  2, TYPE_STRING, TYPE_STRING);
+        builtin_register("open_pipe",  puer_open_pipe, TYPE_INT, 2, TYPE_STRING, TYPE_STRING);
+        builtin_register("close_fd",   puer_close_fd, TYPE_VOID, 1, TYPE_INT);
+        builtin_register("on_read",    puer_on_read, TYPE_VOID, 2, TYPE_INT, TYPE_STRING);
+        builtin_register("write_async", puer_write_async, TYPE_VOID, 2, TYPE_INT, TYPE_STRING);
+        builtin_register("after",      puer_after, TYPE_INT,    2, TYPE_INT, TYPE_STRING);
+        builtin_register("every",      puer_every, TYPE_INT,    2, TYPE_INT, TYPE_STRING);
+        builtin_register("cancel",     puer_cancel, TYPE_VOID,  1, TYPE_INT);
+        builtin_register("run_loop",   puer_run_loop, TYPE_VOID, 0);
+        builtin_register("stop_loop",  puer_stop_loop, TYPE_VOID, 0);
+        builtin_register("sum",        puer_sum,   TYPE_ANY,    1, TYPE_ARRAY);
+        builtin_register("min",        puer_min,   TYPE_ANY,    1, TYPE_ARRAY);
+        builtin_register("max",        puer_max,   TYPE_ANY,    1, TYPE_ARRAY);
+        builtin_register("dot",        puer_dot,   TYPE_ANY,    2, TYPE_ARRAY, TYPE_ARRAY);
+        builtin_register("scale",      puer_scale, TYPE_VOID,   2, TYPE_ARRAY, TYPE_ANY);
+        builtin_register("add_arrays", puer_add_arrays, TYPE_VOID, 2, TYPE_ARRAY, TYPE_ARRAY);
+        builtin_register("fill",       puer_fill,  TYPE_VOID,   2, TYPE_ARRAY, TYPE_ANY);
+        builtin_register("copy",       puer_copy,  TYPE_VOID,   2, TYPE_ARRAY, TYPE_ARRAY);
+        builtin_register("sort",       puer_sort,  TYPE_VOID,   1, TYPE_ARRAY);
+        builtin_register("count_eq",   puer_count_eq, TYPE_INT, 2, TYPE_ARRAY, TYPE_ANY);
 }
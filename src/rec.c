@@ -5,22 +5,16 @@
 #include <stdlib.h>
 #include <string.h>
 
-/* so lexer can distinguish user types from builtin types */
-typedef struct RecName {
-        char* name;
-        UT_hash_handle hh;
-} RecName;
-
-static RecName* recnames = NULL;
 RecDef* recdefs = NULL;
 
 void recdef_free(RecDef* rd);
 
-RecDef* recdef_new(const char* name, const char** field_names, const Var* fields, unsigned int n_fields)
+RecDef* recdef_new(Symbol name, const Symbol* field_names, const Var* fields, unsigned int n_fields)
 {
         unsigned int i;
         RecDef* rd = gc_alloc(sizeof(RecDef), scan_recdef);
-        rd->name = strdup(name);
+        rd->sym = name;
+        rd->name = sym_name(name);
         rd->n_fields = n_fields;
         rd->fields = gc_alloc(sizeof(Var) * n_fields, scan_raw);
         rd->index_map = NULL;
@@ -28,9 +22,9 @@ RecDef* recdef_new(const char* name, const char** field_names, const Var* fields
         for (i = 0; i < n_fields; i++) {
                 FieldIndex* fi = malloc(sizeof(FieldIndex));
                 rd->fields[i] = fields[i];
-                fi->name = strdup(field_names[i]);
+                fi->name = field_names[i];
                 fi->idx = i;
-                HASH_ADD_KEYPTR(hh, rd->index_map, fi->name, strlen(fi->name), fi);
+                HASH_ADD_SYM(rd->index_map, name, fi);
         }
 
         return rd;
@@ -38,13 +32,13 @@ RecDef* recdef_new(const char* name, const char** field_names, const Var* fields
 
 void recdef_register(RecDef* rd)
 {
-        HASH_ADD_KEYPTR(hh, recdefs, rd->name, strlen(rd->name), rd);
+        HASH_ADD_SYM(recdefs, sym, rd);
 }
 
-RecDef* recdef_find(const char* name)
+RecDef* recdef_find(Symbol name)
 {
         RecDef* rd;
-        HASH_FIND_STR(recdefs, name, rd);
+        HASH_FIND_SYM(recdefs, &name, rd);
         return rd;
 }
 
@@ -67,22 +61,20 @@ void recdef_free(RecDef* rd)
 
         HASH_ITER(hh, rd->index_map, fi, tmp) {
                 HASH_DEL(rd->index_map, fi);
-                free(fi->name);
                 free(fi);
         }
 
         /*free(rd->fields);*/
-        free(rd->name);
         /*free(rd);*/
 }
 
-RecInst* rec_new(const char* recdef_name)
+RecInst* rec_new(Symbol recdef_name)
 {
         RecDef* rd = recdef_find(recdef_name);
         RecInst* ri;
         unsigned int i;
         if (!rd)
-                die(NULL, "unknown record '%s'", recdef_name);
+                die(NULL, "unknown record '%s'", sym_name(recdef_name));
 
         ri = gc_alloc(sizeof(RecInst), scan_rec);
         ri->def = rd;
@@ -94,50 +86,42 @@ RecInst* rec_new(const char* recdef_name)
         return ri;
 }
 
-Var* rec_get_field(RecInst* ri, const char* field_name)
+unsigned int rec_field_index(const RecDef* rd, Symbol field_name)
 {
         FieldIndex* fi = NULL;
-        HASH_FIND_STR(ri->def->index_map, field_name, fi);
+        HASH_FIND_SYM(rd->index_map, &field_name, fi);
         if (!fi)
-                die(NULL, "record has no field '%s'", field_name);
-        return &ri->fields[fi->idx];
+                die(NULL, "record has no field '%s'", sym_name(field_name));
+        return fi->idx;
+}
+
+Var* rec_get_field(RecInst* ri, Symbol field_name)
+{
+        return &ri->fields[rec_field_index(ri->def, field_name)];
 }
 
-void rec_set_field(RecInst* ri, const char* field_name, Var val)
+void rec_set_field(RecInst* ri, Symbol field_name, Var val)
 {
         Var* v = rec_get_field(ri, field_name);
         if (v->type != val.type)
-                die(NULL, "type error: Can't assign record field: %s to type %d (field is of type %d)", field_name, val.type, v->type);
+                die(NULL, "type error: Can't assign record field: %s to type %d (field is of type %d)", sym_name(field_name), val.type, v->type);
         *v = val;
 }
 
-int is_rec_name(const char* name)
+/* so lexer can distinguish user types from builtin types */
+int is_rec_name(Symbol name)
 {
-        RecName* r;
-        HASH_FIND_STR(recnames, name, r);
-        return (r != NULL);
+        return sym_is_rec(name);
 }
 
-void recname_register(const char* name)
+void recname_register(Symbol name)
 {
-        RecName* r;
-        HASH_FIND_STR(recnames, name, r);
-        if (!r) {
-                r = malloc(sizeof(RecName));
-                r->name = strdup(name);
-                HASH_ADD_KEYPTR(hh, recnames, r->name, strlen(r->name), r);
-        }
+        sym_set_rec(name, 1);
 }
 
 void recname_clear(void)
 {
-        RecName* cur;
-        RecName* tmp;
-        HASH_ITER(hh, recnames, cur, tmp) {
-                HASH_DEL(recnames, cur);
-                free(cur->name);
-                free(cur);
-        }
+        sym_clear_recs();
 }
 
 RecInst* rec_clone(const RecInst* src)
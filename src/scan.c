@@ -3,35 +3,55 @@
 #include "puerstring.h"
 #include "arraylist.h"
 #include "rec.h"
+#include "dict.h"
+#include "gen.h"
 #include "var.h"
 #include "ast.h"
 
 #include "uthash.h"
 
 
-void mark_var(const Var* v, GC_MarkFn mark)
-{
-        if (!v)
-                return;
+/* casts for passing a typed pointer slot to mark */
+#define SLOT(p) ( (void**) &(p) )
 
-        switch(v->type) {
+static void mark_data(VarType type, VarData* data, GC_MarkFn mark)
+{
+        switch(type) {
         case TYPE_STRING:
-                if (v->data.s)
-                        mark(v->data.s);
+                if (data->s)
+                        mark(SLOT(data->s));
                 break;
         case TYPE_ARRAY:
-                if (v->data.a)
-                        mark(v->data.a);
+                if (data->a)
+                        mark(SLOT(data->a));
                 break;
         case TYPE_REC:
-                if (v->data.r)
-                        mark(v->data.r);
+                if (data->r)
+                        mark(SLOT(data->r));
+                break;
+        case TYPE_DICT:
+                if (data->d)
+                        mark(SLOT(data->d));
+                break;
+        case TYPE_CHAN:
+                if (data->ch)
+                        mark(SLOT(data->ch));
+                break;
+        case TYPE_GEN:
+                if (data->g)
+                        mark(SLOT(data->g));
                 break;
         default:
                 break;
         }
 }
 
+void mark_var(Var* v, GC_MarkFn mark)
+{
+        if (v)
+                mark_data(v->type, &v->data, mark);
+}
+
 void scan_raw(void* payload, GC_MarkFn mark)
 {
         (void) payload;
@@ -42,7 +62,14 @@ void scan_string(void* payload, GC_MarkFn mark)
 {
         String* s = payload;
         if (s->data)
-                mark(s->data);
+                mark(SLOT(s->data));
+}
+
+/* a str from map_file, its data is a file mapping and not on the heap */
+void scan_mapped_string(void* payload, GC_MarkFn mark)
+{
+        (void) payload;
+        (void) mark;
 }
 
 void scan_arraylist(void* payload, GC_MarkFn mark)
@@ -50,7 +77,7 @@ void scan_arraylist(void* payload, GC_MarkFn mark)
         ArrayList* a = payload;
         unsigned int i;
         if (a->items)
-                mark(a->items);
+                mark(SLOT(a->items));
 
         for (i = 0; i < a->size; i++)
                 mark_var(&a->items[i], mark);
@@ -59,7 +86,9 @@ void scan_arraylist(void* payload, GC_MarkFn mark)
 void scan_varentry(void* payload, GC_MarkFn mark)
 {
         VarEntry* e = payload;
-        if (e->alias)
+        if (e->elem_of)
+                mark(SLOT(e->elem_of));
+        else if (e->alias)
                 mark_var(e->alias, mark);
         else
                 mark_var(&e->val, mark);
@@ -70,9 +99,10 @@ void scan_scope(void* payload, GC_MarkFn mark)
         Scope* s = payload;
         VarEntry* cur;
         VarEntry* tmp;
-        mark(s->next);
+        mark(SLOT(s->next));
+        /* entries are linked by uthash and never moved, the local slot is enough */
         HASH_ITER(hh, s->table, cur, tmp) {
-                mark(cur);
+                mark(SLOT(cur));
         }
 }
 
@@ -82,7 +112,7 @@ void scan_rec(void* payload, GC_MarkFn mark)
         unsigned int i;
 
         if (ri->fields)
-                mark(ri->fields);
+                mark(SLOT(ri->fields));
 
         for (i = 0; i < ri->def->n_fields; i++)
                 mark_var(&ri->fields[i], mark);
@@ -93,11 +123,57 @@ void scan_recdef(void* payload, GC_MarkFn mark)
 {
         RecDef* rd = payload;
         unsigned int i;
-        if (!rd || !rd->fields)
+        if (!rd)
+                return;
+
+        /* only the head of recdefs is a root, keep the rest of the table alive */
+        mark(&rd->hh.next);
+
+        if (!rd->fields)
                 return;
 
-        mark(rd->fields);
+        mark(SLOT(rd->fields));
 
         for (i = 0; i < rd->n_fields; i++)
                 mark_var(&rd->fields[i], mark);
 }
+
+/* only full slots hold keys and values */
+void scan_dict(void* payload, GC_MarkFn mark)
+{
+        Dict* d = payload;
+        unsigned int i;
+
+        if (!d->ctrl)
+                return;
+
+        mark(SLOT(d->ctrl));
+        mark(SLOT(d->slots));
+
+        for (i = dict_next(d, 0); i < d->cap; i = dict_next(d, i + 1)) {
+                mark_data(d->key_type, &d->slots[i].key, mark);
+                mark_data(d->val_type, &d->slots[i].val, mark);
+        }
+}
+
+void scan_gen(void* payload, GC_MarkFn mark)
+{
+        Gen* g = payload;
+
+        mark_var(&g->value, mark);
+        if (g->base)
+                mark(SLOT(g->base));
+        if (g->env)
+                mark(SLOT(g->env));
+        if (g->caller)
+                mark(SLOT(g->caller));
+        if (g->resumer)
+                mark(SLOT(g->resumer));
+}
+
+/* a channel is two fds, closed by its finalizer */
+void scan_chan(void* payload, GC_MarkFn mark)
+{
+        (void) payload;
+        (void) mark;
+}
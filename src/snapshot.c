@@ -0,0 +1,675 @@
+#include "snapshot.h"
+#include "cache.h"
+#include "env.h"
+#include "rec.h"
+#include "func.h"
+#include "arraylist.h"
+#include "dict.h"
+#include "scan.h"
+#include "util.h"
+#include "uthash.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+ * Image layout, in host byte order:
+ *
+ *   SnapHeader
+ *   globals   n_globals * { name, var }
+ *   recdefs   n_recdefs * { name, u32 n_fields, n_fields * { name, var } }
+ *   funcs     n_funcs * { name, u32 node id }
+ *   objects   n_objects * object
+ *   padding to 8 bytes, then the flat ast image
+ *
+ * a name is u32 length and the bytes. a var is u8 type, u8 is_const and
+ * the value: the raw scalar, or for strings, arrays, records and dicts the
+ * id of an object, its index in the objects section. objects are
+ *
+ *   'S' u32 length  bytes
+ *   'A' u8 element type  u32 size  size * var
+ *   'R' name of record type  u32 n_fields  n_fields * var
+ *   'D' u8 key type  u8 value type  u32 size  size * { key var, value var }
+ *
+ * objects reachable from several places are written once, so sharing
+ * between variables survives a restore.
+ */
+
+#define SNAP_MAGIC "PUERIMG\0"
+#define SNAP_FORMAT 3
+
+enum { SECT_GLOBALS, SECT_RECDEFS, SECT_FUNCS, SECT_OBJECTS, SECT_COUNT };
+
+typedef struct SnapHeader {
+        char magic[8];
+        char build[64];
+        unsigned long format;
+        unsigned long node_size;
+        unsigned long node_types;
+        unsigned long var_size;
+        unsigned long resume;           /* top-level statement to start at */
+        unsigned long count[SECT_COUNT];
+        unsigned long bytes[SECT_COUNT];
+        AstImageInfo info;
+} SnapHeader;
+
+#define VAR_VALUE_SIZE sizeof(((Var*) 0)->data)
+
+static void fill_header(SnapHeader* h)
+{
+        memset(h, 0, sizeof(*h));
+        memcpy(h->magic, SNAP_MAGIC, sizeof(h->magic));
+        strncpy(h->build, PUER_VERSION " " __DATE__ " " __TIME__, sizeof(h->build) - 1);
+        h->format = SNAP_FORMAT;
+        h->node_size = sizeof(Node);
+        h->node_types = NODE_LASTNODE;
+        h->var_size = sizeof(Var);
+}
+
+/* writing */
+
+typedef struct Buf {
+        char* data;
+        size_t len;
+        size_t cap;
+} Buf;
+
+typedef struct ObjId {
+        const void* ptr;
+        unsigned int id;
+        UT_hash_handle hh;
+} ObjId;
+
+static Buf sect[SECT_COUNT];
+static unsigned long counts[SECT_COUNT];
+static ObjId* obj_ids = NULL;
+static Var* pending = NULL;     /* objects in id order, as vars */
+static unsigned int n_pending = 0;
+static unsigned int cap_pending = 0;
+
+static void put(Buf* b, const void* p, size_t n)
+{
+        if (b->len + n > b->cap) {
+                size_t cap = b->cap ? b->cap : 256;
+                while (cap < b->len + n)
+                        cap *= 2;
+                b->data = realloc(b->data, cap);
+                if (!b->data)
+                        die(NULL, "Out of Memory Error");
+                b->cap = cap;
+        }
+        memcpy(b->data + b->len, p, n);
+        b->len += n;
+}
+
+static void put_u8(Buf* b, unsigned int v)
+{
+        unsigned char c = (unsigned char) v;
+        put(b, &c, 1);
+}
+
+static void put_u32(Buf* b, unsigned int v)
+{
+        put(b, &v, sizeof(v));
+}
+
+static void put_name(Buf* b, const char* s, unsigned int len)
+{
+        put_u32(b, len);
+        put(b, s, len);
+}
+
+/* returns the id of a heap object, queueing it for the objects section on first sight */
+static unsigned int obj_id(const Var* v)
+{
+        ObjId* e;
+        const void* p = v->data.s;
+
+        HASH_FIND_PTR(obj_ids, &p, e);
+        if (e)
+                return e->id;
+
+        e = malloc(sizeof(ObjId));
+        e->ptr = p;
+        e->id = n_pending;
+        HASH_ADD_PTR(obj_ids, ptr, e);
+
+        if (n_pending == cap_pending) {
+                cap_pending = cap_pending ? cap_pending * 2 : 64;
+                pending = realloc(pending, sizeof(Var) * cap_pending);
+                if (!pending)
+                        die(NULL, "Out of Memory Error");
+        }
+        pending[n_pending++] = *v;
+        return e->id;
+}
+
+static void put_var(Buf* b, const Var* v)
+{
+        unsigned char value[VAR_VALUE_SIZE];
+
+        if (v->type == TYPE_CHAN)
+                die(NULL, "snapshot: channels cannot be saved");
+        if (v->type == TYPE_GEN)
+                die(NULL, "snapshot: generators cannot be saved");
+        put_u8(b, v->type);
+        put_u8(b, v->is_const);
+        memset(value, 0, sizeof(value));
+        switch (v->type) {
+        case TYPE_STRING:
+        case TYPE_ARRAY:
+        case TYPE_REC:
+        case TYPE_DICT:
+                if (v->data.s) {
+                        unsigned int id = obj_id(v) + 1;
+                        memcpy(value, &id, sizeof(id));
+                }
+                break;
+        default:
+                memcpy(value, &v->data, sizeof(value));
+                break;
+        }
+        put(b, value, sizeof(value));
+}
+
+static void put_object(Buf* b, const Var* v)
+{
+        unsigned int i;
+        Dict* d;
+
+        switch (v->type) {
+        case TYPE_STRING:
+                put_u8(b, 'S');
+                put_name(b, v->data.s->data, v->data.s->length);
+                break;
+        case TYPE_ARRAY:
+                put_u8(b, 'A');
+                put_u8(b, v->data.a->type);
+                put_u32(b, v->data.a->size);
+                for (i = 0; i < v->data.a->size; i++)
+                        put_var(b, &v->data.a->items[i]);
+                break;
+        case TYPE_REC:
+                put_u8(b, 'R');
+                put_name(b, v->data.r->def->name, strlen(v->data.r->def->name));
+                put_u32(b, v->data.r->def->n_fields);
+                for (i = 0; i < v->data.r->def->n_fields; i++)
+                        put_var(b, &v->data.r->fields[i]);
+                break;
+        case TYPE_DICT:
+                d = v->data.d;
+                put_u8(b, 'D');
+                put_u8(b, d->key_type);
+                put_u8(b, d->val_type);
+                put_u32(b, d->size);
+                for (i = dict_next(d, 0); i < d->cap; i = dict_next(d, i + 1)) {
+                        Var key = dict_key_at(d, i);
+                        Var val = dict_val_at(d, i);
+                        put_var(b, &key);
+                        put_var(b, &val);
+                }
+                break;
+        default:
+                break;
+        }
+}
+
+static void put_sym(Buf* b, Symbol sym)
+{
+        put_name(b, sym_name(sym), strlen(sym_name(sym)));
+}
+
+static void put_global(Buf* b, VarEntry* e)
+{
+        put_sym(b, e->name);
+        put_var(b, env_entry_var(e));
+}
+
+static void put_recdef(Buf* b, const RecDef* rd)
+{
+        Symbol* names = malloc(sizeof(Symbol) * (rd->n_fields + 1));
+        FieldIndex* fi;
+        FieldIndex* tmp;
+        unsigned int i;
+
+        HASH_ITER(hh, rd->index_map, fi, tmp) {
+                names[fi->idx] = fi->name;
+        }
+
+        put_name(b, rd->name, strlen(rd->name));
+        put_u32(b, rd->n_fields);
+        for (i = 0; i < rd->n_fields; i++) {
+                put_sym(b, names[i]);
+                put_var(b, &rd->fields[i]);
+        }
+        free(names);
+}
+
+static void put_func(Symbol name, Node* ast, void* ctx)
+{
+        Buf* b = ctx;
+        put_sym(b, name);
+        put_u32(b, (unsigned int) (ast - ast_nodes));
+        counts[SECT_FUNCS]++;
+}
+
+static void reset_writer(void)
+{
+        ObjId* cur;
+        ObjId* tmp;
+        int i;
+
+        HASH_ITER(hh, obj_ids, cur, tmp) {
+                HASH_DEL(obj_ids, cur);
+                free(cur);
+        }
+        for (i = 0; i < SECT_COUNT; i++) {
+                free(sect[i].data);
+                memset(&sect[i], 0, sizeof(sect[i]));
+                counts[i] = 0;
+        }
+        free(pending);
+        pending = NULL;
+        n_pending = 0;
+        cap_pending = 0;
+}
+
+static void build_sections(void)
+{
+        Scope* globals = env_stack;
+        VarEntry* e;
+        VarEntry* etmp;
+        RecDef* rd;
+        RecDef* rtmp;
+        unsigned int i;
+
+        while (globals && globals->next)
+                globals = globals->next;
+
+        if (globals) {
+                HASH_ITER(hh, globals->table, e, etmp) {
+                        put_global(&sect[SECT_GLOBALS], e);
+                        counts[SECT_GLOBALS]++;
+                }
+        }
+
+        HASH_ITER(hh, recdefs, rd, rtmp) {
+                put_recdef(&sect[SECT_RECDEFS], rd);
+                counts[SECT_RECDEFS]++;
+        }
+
+        func_each(put_func, &sect[SECT_FUNCS]);
+
+        /* writing an object may queue more, moving pending */
+        for (i = 0; i < n_pending; i++) {
+                Var obj = pending[i];
+                put_object(&sect[SECT_OBJECTS], &obj);
+        }
+        counts[SECT_OBJECTS] = n_pending;
+}
+
+/* writes an image that resumes after the current top-level statement. returns 0 on success */
+int snapshot_write(const char* path)
+{
+        static const char zeros[8] = { 0 };
+        SnapHeader h;
+        char tmp[4200];
+        size_t body = 0;
+        FILE* f;
+        int ok;
+        int i;
+
+        fill_header(&h);
+        h.resume = current_toplevel() + 1;
+
+        build_sections();
+        for (i = 0; i < SECT_COUNT; i++) {
+                h.count[i] = counts[i];
+                h.bytes[i] = sect[i].len;
+                body += sect[i].len;
+        }
+
+        sprintf(tmp, "%.4000s.%ld.tmp", path, (long) getpid());
+        f = fopen(tmp, "wb");
+        ok = f != NULL;
+        if (ok)
+                ok = fwrite(&h, sizeof(h), 1, f) == 1;
+        for (i = 0; ok && i < SECT_COUNT; i++)
+                ok = fwrite(sect[i].data, 1, sect[i].len, f) == sect[i].len;
+        if (ok && body % 8)
+                ok = fwrite(zeros, 1, 8 - body % 8, f) == 8 - body % 8;
+        if (ok)
+                ok = ast_write_image(f, &h.info) == 0;
+        if (ok) {
+                /* header again now that the ast image sizes are known */
+                ok = fseek(f, 0, SEEK_SET) == 0
+                        && fwrite(&h, sizeof(h), 1, f) == 1;
+        }
+        if (f && fclose(f) != 0)
+                ok = 0;
+
+        reset_writer();
+
+        if (!ok || rename(tmp, path) != 0) {
+                remove(tmp);
+                return -1;
+        }
+        return 0;
+}
+
+/* reading */
+
+typedef struct Reader {
+        const char* p;
+        const char* end;
+} Reader;
+
+static void** objs = NULL;
+static VarType* obj_types = NULL;
+static unsigned long n_objs = 0;
+
+static void take(Reader* r, void* out, size_t n)
+{
+        if ((size_t) (r->end - r->p) < n)
+                die(NULL, "corrupt snapshot image");
+        if (out)
+                memcpy(out, r->p, n);
+        r->p += n;
+}
+
+static unsigned int get_u8(Reader* r)
+{
+        unsigned char c;
+        take(r, &c, 1);
+        return c;
+}
+
+static unsigned int get_u32(Reader* r)
+{
+        unsigned int v;
+        take(r, &v, sizeof(v));
+        return v;
+}
+
+static Symbol get_sym(Reader* r)
+{
+        unsigned int len = get_u32(r);
+        const char* s = r->p;
+
+        take(r, NULL, len);
+        return sym_intern(s, len);
+}
+
+static Var get_var(Reader* r)
+{
+        Var v;
+        unsigned int id;
+
+        v.type = (VarType) get_u8(r);
+        v.is_const = get_u8(r);
+        take(r, &v.data, VAR_VALUE_SIZE);
+
+        switch (v.type) {
+        case TYPE_STRING:
+        case TYPE_ARRAY:
+        case TYPE_REC:
+        case TYPE_DICT:
+                memcpy(&id, &v.data, sizeof(id));
+                v.data.s = NULL;
+                if (id == 0)
+                        break;
+                if (id > n_objs || obj_types[id - 1] != v.type)
+                        die(NULL, "corrupt snapshot image");
+                /* all object pointers share the union */
+                v.data.s = objs[id - 1];
+                break;
+        case TYPE_INT:
+        case TYPE_UINT:
+        case TYPE_LONG:
+        case TYPE_FLOAT:
+        case TYPE_BOOL:
+        case TYPE_CHAR:
+        case TYPE_VOID:
+                break;
+        default:
+                die(NULL, "corrupt snapshot image");
+        }
+        return v;
+}
+
+static void skip_vars(Reader* r, unsigned int n)
+{
+        take(r, NULL, (size_t) n * (2 + VAR_VALUE_SIZE));
+}
+
+/* first pass: allocates every object so vars can refer to them */
+static void alloc_objects(Reader r)
+{
+        unsigned long i;
+
+        for (i = 0; i < n_objs; i++) {
+                unsigned int kind = get_u8(&r);
+                unsigned int n;
+
+                if (kind == 'S') {
+                        String* s;
+                        n = get_u32(&r);
+                        s = gc_alloc(sizeof(String), scan_string);
+                        s->data = gc_alloc(n + 1, scan_raw);
+                        take(&r, s->data, n);
+                        s->data[n] = '\0';
+                        s->length = n;
+                        objs[i] = s;
+                        obj_types[i] = TYPE_STRING;
+                }
+                else if (kind == 'A') {
+                        VarType elem = (VarType) get_u8(&r);
+                        n = get_u32(&r);
+                        skip_vars(&r, n);
+                        objs[i] = arraylist_new(elem, n);
+                        obj_types[i] = TYPE_ARRAY;
+                }
+                else if (kind == 'R') {
+                        RecInst* ri;
+                        get_sym(&r);
+                        n = get_u32(&r);
+                        skip_vars(&r, n);
+                        ri = gc_alloc(sizeof(RecInst), scan_rec);
+                        ri->def = NULL;
+                        ri->fields = gc_alloc(sizeof(Var) * n, scan_raw);
+                        objs[i] = ri;
+                        obj_types[i] = TYPE_REC;
+                }
+                else if (kind == 'D') {
+                        Dict* d;
+                        VarType key_type = (VarType) get_u8(&r);
+                        VarType val_type = (VarType) get_u8(&r);
+                        n = get_u32(&r);
+                        skip_vars(&r, 2 * n);
+                        if (!dict_is_key_type(key_type))
+                                die(NULL, "corrupt snapshot image");
+                        d = dict_new(key_type, val_type);
+                        dict_reserve(NULL, d, n);
+                        objs[i] = d;
+                        obj_types[i] = TYPE_DICT;
+                }
+                else {
+                        die(NULL, "corrupt snapshot image");
+                }
+        }
+}
+
+/* second pass: fills arrays, records and dicts once record definitions exist */
+static void fill_objects(Reader r)
+{
+        unsigned long i;
+        unsigned int j;
+
+        for (i = 0; i < n_objs; i++) {
+                unsigned int kind = get_u8(&r);
+                unsigned int n;
+
+                if (kind == 'S') {
+                        n = get_u32(&r);
+                        take(&r, NULL, n);
+                }
+                else if (kind == 'D') {
+                        get_u8(&r);
+                        get_u8(&r);
+                        n = get_u32(&r);
+                        for (j = 0; j < n; j++) {
+                                Var key = get_var(&r);
+                                dict_set(NULL, objs[i], key, get_var(&r));
+                        }
+                }
+                else if (kind == 'A') {
+                        ArrayList* a = objs[i];
+                        get_u8(&r);
+                        n = get_u32(&r);
+                        for (j = 0; j < n; j++)
+                                arraylist_push(a, get_var(&r));
+                }
+                else {
+                        RecInst* ri = objs[i];
+                        Symbol name = get_sym(&r);
+                        ri->def = recdef_find(name);
+                        n = get_u32(&r);
+                        if (!ri->def || ri->def->n_fields != n)
+                                die(NULL, "snapshot image has an unknown record type '%s'", sym_name(name));
+                        for (j = 0; j < n; j++)
+                                ri->fields[j] = get_var(&r);
+                }
+        }
+}
+
+static void load_recdefs(Reader r, unsigned long n)
+{
+        unsigned long i;
+        unsigned int j;
+
+        for (i = 0; i < n; i++) {
+                Symbol name = get_sym(&r);
+                unsigned int n_fields = get_u32(&r);
+                Symbol* names = malloc(sizeof(Symbol) * (n_fields + 1));
+                Var* fields = malloc(sizeof(Var) * (n_fields + 1));
+
+                for (j = 0; j < n_fields; j++) {
+                        names[j] = get_sym(&r);
+                        fields[j] = get_var(&r);
+                }
+
+                /* builtin record types are already registered */
+                if (!recdef_find(name))
+                        recdef_register(recdef_new(name, names, fields, n_fields));
+
+                free(names);
+                free(fields);
+        }
+}
+
+static void load_globals(Reader r, unsigned long n)
+{
+        unsigned long i;
+
+        for (i = 0; i < n; i++) {
+                Symbol name = get_sym(&r);
+                env_set(name, get_var(&r));
+        }
+}
+
+static void load_funcs(Reader r, unsigned long n, unsigned long n_nodes)
+{
+        unsigned long i;
+
+        for (i = 0; i < n; i++) {
+                Symbol name = get_sym(&r);
+                unsigned int id = get_u32(&r);
+                if (id >= n_nodes)
+                        die(NULL, "corrupt snapshot image");
+                func_set(name, &ast_nodes[id]);
+        }
+}
+
+/*
+ * maps an image written by snapshot_write and rebuilds its state. must run
+ * after gc_init() and init_puerlib(). returns the program, with the
+ * statement to resume at in *resume. dies if the image can't be used.
+ */
+Node* snapshot_restore(const char* path, unsigned int* resume)
+{
+        SnapHeader want;
+        SnapHeader* got;
+        Reader sections[SECT_COUNT];
+        struct stat st;
+        size_t off = sizeof(SnapHeader);
+        char* map;
+        Node* program;
+        int fd;
+        int i;
+
+        fd = open(path, O_RDONLY);
+        if (fd < 0)
+                die(NULL, "could not open snapshot image '%s'", path);
+        if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(SnapHeader)) {
+                close(fd);
+                die(NULL, "corrupt snapshot image '%s'", path);
+        }
+        map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED)
+                die(NULL, "could not map snapshot image '%s'", path);
+
+        fill_header(&want);
+        got = (SnapHeader*) map;
+        if (memcmp(got->magic, want.magic, sizeof(want.magic)) != 0)
+                die(NULL, "'%s' is not a snapshot image", path);
+        if (memcmp(got->build, want.build, sizeof(want.build)) != 0
+                        || got->format != want.format
+                        || got->node_size != want.node_size
+                        || got->node_types != want.node_types
+                        || got->var_size != want.var_size)
+                die(NULL, "snapshot image '%s' was written by a different build of puer", path);
+
+        for (i = 0; i < SECT_COUNT; i++) {
+                if (got->bytes[i] > (size_t) st.st_size - off)
+                        die(NULL, "corrupt snapshot image '%s'", path);
+                sections[i].p = map + off;
+                sections[i].end = map + off + got->bytes[i];
+                off += got->bytes[i];
+        }
+        off = (off + 7) & ~(size_t) 7;
+        if (off + ast_image_size(&got->info) != (size_t) st.st_size
+                        || got->info.n_nodes == 0)
+                die(NULL, "corrupt snapshot image '%s'", path);
+
+        program = ast_load_image(map + off, &got->info, map, st.st_size);
+        if (!program || got->resume > program->n_children)
+                die(NULL, "corrupt snapshot image '%s'", path);
+
+        n_objs = got->count[SECT_OBJECTS];
+        if (n_objs > got->bytes[SECT_OBJECTS])
+                die(NULL, "corrupt snapshot image '%s'", path);
+        objs = malloc(sizeof(void*) * (n_objs + 1));
+        obj_types = malloc(sizeof(VarType) * (n_objs + 1));
+
+        /* nothing is rooted until the globals are set, so no collection may run */
+        alloc_objects(sections[SECT_OBJECTS]);
+        load_recdefs(sections[SECT_RECDEFS], got->count[SECT_RECDEFS]);
+        fill_objects(sections[SECT_OBJECTS]);
+        load_globals(sections[SECT_GLOBALS], got->count[SECT_GLOBALS]);
+        load_funcs(sections[SECT_FUNCS], got->count[SECT_FUNCS], got->info.n_nodes);
+
+        free(objs);
+        free(obj_types);
+        objs = NULL;
+        obj_types = NULL;
+        n_objs = 0;
+
+        *resume = (unsigned int) got->resume;
+        return program;
+}
@@ -13,10 +13,16 @@ void check_str_bounds(String* s, int index)
 
 String* string_new(const char* cstr)
 {
-        unsigned int len = strlen(cstr);
+        return string_new_len(cstr, strlen(cstr));
+}
+
+/* data need not end in a NUL */
+String* string_new_len(const char* data, unsigned int len)
+{
         String* s = gc_alloc(sizeof(String), scan_string);
         s->data = gc_alloc(len + 1, scan_raw);
-        memcpy(s->data, cstr, len + 1);
+        memcpy(s->data, data, len);
+        s->data[len] = '\0';
         s->length = len;
         return s;
 }
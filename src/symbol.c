@@ -0,0 +1,168 @@
+#include "symbol.h"
+#include "util.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct SymEntry {
+        const char* name;
+        unsigned int len;
+        unsigned int hash;
+        int is_rec;
+} SymEntry;
+
+/* names live in chunks that are never moved, so sym_name() pointers stay valid */
+typedef struct NameChunk {
+        struct NameChunk* next;
+        size_t used;
+        size_t size;
+        char data[1];
+} NameChunk;
+
+#define CHUNK_SIZE 16384
+
+static SymEntry* syms = NULL;      /* indexed by symbol, entry 0 unused */
+static unsigned int n_syms = 0;
+static unsigned int cap_syms = 0;
+static Symbol* slots = NULL;       /* open addressing index, 0 is empty */
+static unsigned int n_slots = 0;
+static NameChunk* chunks = NULL;
+
+/* 32 bit FNV-1a */
+static unsigned int hash_name(const char* s, size_t len)
+{
+        unsigned int h = 2166136261U;
+        size_t i;
+        for (i = 0; i < len; i++) {
+                h ^= (unsigned char) s[i];
+                h *= 16777619U;
+        }
+        return h;
+}
+
+static char* store_name(const char* s, size_t len)
+{
+        char* out;
+
+        if (!chunks || chunks->size - chunks->used < len + 1) {
+                size_t size = len + 1 > CHUNK_SIZE ? len + 1 : CHUNK_SIZE;
+                NameChunk* c = malloc(sizeof(NameChunk) + size);
+                if (!c)
+                        die(NULL, "Out of Memory Error");
+                c->next = chunks;
+                c->used = 0;
+                c->size = size;
+                chunks = c;
+        }
+
+        out = chunks->data + chunks->used;
+        memcpy(out, s, len);
+        out[len] = '\0';
+        chunks->used += len + 1;
+        return out;
+}
+
+static void grow_slots(void)
+{
+        unsigned int size = n_slots ? n_slots * 2 : 256;
+        Symbol* fresh = calloc(size, sizeof(Symbol));
+        unsigned int i;
+
+        if (!fresh)
+                die(NULL, "Out of Memory Error");
+        for (i = 1; i <= n_syms; i++) {
+                unsigned int at = syms[i].hash & (size - 1);
+                while (fresh[at])
+                        at = (at + 1) & (size - 1);
+                fresh[at] = i;
+        }
+        free(slots);
+        slots = fresh;
+        n_slots = size;
+}
+
+Symbol sym_intern(const char* s, size_t len)
+{
+        unsigned int hash = hash_name(s, len);
+        unsigned int at;
+        SymEntry* e;
+
+        if (2 * (n_syms + 1) > n_slots)
+                grow_slots();
+
+        for (at = hash & (n_slots - 1); slots[at]; at = (at + 1) & (n_slots - 1)) {
+                e = &syms[slots[at]];
+                if (e->hash == hash && e->len == len && memcmp(e->name, s, len) == 0)
+                        return slots[at];
+        }
+
+        if (n_syms + 1 >= cap_syms) {
+                cap_syms = cap_syms ? cap_syms * 2 : 256;
+                syms = realloc(syms, sizeof(SymEntry) * cap_syms);
+                if (!syms)
+                        die(NULL, "Out of Memory Error");
+        }
+
+        e = &syms[++n_syms];
+        e->name = store_name(s, len);
+        e->len = (unsigned int) len;
+        e->hash = hash;
+        e->is_rec = 0;
+        slots[at] = n_syms;
+        return n_syms;
+}
+
+Symbol sym_intern_str(const char* s)
+{
+        return sym_intern(s, strlen(s));
+}
+
+const char* sym_name(Symbol sym)
+{
+        return sym && sym <= n_syms ? syms[sym].name : NULL;
+}
+
+unsigned int sym_hash(Symbol sym)
+{
+        return syms[sym].hash;
+}
+
+/* symbols are numbered 1 to sym_count() */
+unsigned int sym_count(void)
+{
+        return n_syms;
+}
+
+/* record type names are flagged so the lexer can tell them from identifiers */
+int sym_is_rec(Symbol sym)
+{
+        return syms[sym].is_rec;
+}
+
+void sym_set_rec(Symbol sym, int is_rec)
+{
+        syms[sym].is_rec = is_rec;
+}
+
+void sym_clear_recs(void)
+{
+        unsigned int i;
+        for (i = 1; i <= n_syms; i++)
+                syms[i].is_rec = 0;
+}
+
+void sym_clear(void)
+{
+        while (chunks) {
+                NameChunk* next = chunks->next;
+                free(chunks);
+                chunks = next;
+        }
+        free(syms);
+        free(slots);
+        syms = NULL;
+        slots = NULL;
+        n_syms = 0;
+        cap_syms = 0;
+        n_slots = 0;
+}
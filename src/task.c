@@ -0,0 +1,428 @@
+/* MAP_ANONYMOUS */
+#define _DEFAULT_SOURCE
+
+#include "task.h"
+#include "parfor.h"
+#include "pool.h"
+#include "arraylist.h"
+#include "env.h"
+#include "output.h"
+#include "file.h"
+#include "gc_tri.h"
+#include "scan.h"
+#include "util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+/* first byte of a channel message */
+#define MSG_VALUE 'v'
+#define MSG_CLOSE 'c'
+
+/* asked for, the kernel caps it */
+#define CHAN_SNDBUF (4 << 20)
+
+typedef struct Task {
+        pid_t pid;
+        pid_t owner;            /* tasks can only be joined by the process that spawned them */
+        int fd;                 /* the result pipe, -1 once joined */
+} Task;
+
+int task_child = 0;
+
+static Task* tasks = NULL;
+static int n_tasks = 0;
+static int cap_tasks = 0;
+
+static void write_all(int fd, const char* p, size_t n)
+{
+        while (n > 0) {
+                ssize_t got = write(fd, p, n);
+                if (got < 0 && errno == EINTR)
+                        continue;
+                if (got <= 0)
+                        _exit(1);
+                p += got;
+                n -= (size_t) got;
+        }
+}
+
+static int is_scalar(VarType type)
+{
+        return type <= TYPE_BOOL || type == TYPE_CHAR;
+}
+
+static int live_tasks(void)
+{
+        pid_t self = getpid();
+        int n = 0;
+        int i;
+
+        for (i = 0; i < n_tasks; i++)
+                n += tasks[i].owner == self && tasks[i].fd >= 0;
+        return n;
+}
+
+/* tasks that were never joined end with the script */
+static void kill_tasks(void)
+{
+        pid_t self = getpid();
+        int i;
+
+        for (i = 0; i < n_tasks; i++) {
+                if (tasks[i].owner != self || tasks[i].fd < 0)
+                        continue;
+                kill(tasks[i].pid, SIGKILL);
+                waitpid(tasks[i].pid, NULL, 0);
+        }
+}
+
+/* type byte, then the value: a VarData for scalars, the bytes of a str */
+static void write_result(int fd, Node* call, Var v)
+{
+        char type = (char) v.type;
+
+        if (v.type != TYPE_VOID && v.type != TYPE_STRING && !is_scalar(v.type))
+                die(call, "spawn: a task can only return a scalar or str");
+        write_all(fd, &type, 1);
+        if (v.type == TYPE_STRING)
+                write_all(fd, v.data.s->data, v.data.s->length);
+        else if (v.type != TYPE_VOID)
+                write_all(fd, (const char*) &v.data, sizeof(VarData));
+}
+
+/* forks a process evaluating call, returns its handle */
+int task_spawn(Node* call)
+{
+        static int registered = 0;
+        int fds[2];
+        pid_t pid;
+        Var result;
+
+        if (!registered) {
+                atexit(kill_tasks);
+                registered = 1;
+        }
+        if (n_tasks == cap_tasks) {
+                cap_tasks = cap_tasks ? cap_tasks * 2 : 16;
+                tasks = realloc(tasks, sizeof(Task) * cap_tasks);
+                if (!tasks)
+                        die(NULL, "Out of Memory Error");
+        }
+
+        /* buffered output would be written twice */
+        out_flush();
+        file_flush_all();
+        fflush(stderr);
+
+        if (pipe(fds) != 0)
+                die(call, "spawn: pipe failed");
+        pid = fork();
+        if (pid < 0)
+                die(call, "spawn: fork failed");
+        if (pid == 0) {
+                close(fds[0]);
+                task_child = 1;
+                /* stores no longer go back to a parfor, the task has its own heap */
+                parfor_worker = 0;
+                result = eval_expr(call);
+                write_result(fds[1], call, result);
+                out_flush();
+                file_flush_all();
+                _exit(0);
+        }
+
+        close(fds[1]);
+        tasks[n_tasks].pid = pid;
+        tasks[n_tasks].owner = getpid();
+        tasks[n_tasks].fd = fds[0];
+        return ++n_tasks;
+}
+
+/* waits for the task and returns what its function returned */
+Var task_join(Node* at, int handle)
+{
+        Task* t;
+        char* buf = NULL;
+        size_t len = 0;
+        size_t cap = 0;
+        pid_t got;
+        int status;
+        Var out;
+
+        if (handle < 1 || handle > n_tasks || tasks[handle - 1].owner != getpid()
+            || tasks[handle - 1].fd < 0)
+                die(at, "join: %d is not a running task of this process", handle);
+        t = &tasks[handle - 1];
+
+        for (;;) {
+                ssize_t n;
+                if (cap - len < 4096) {
+                        cap = cap ? cap * 2 : 8192;
+                        buf = realloc(buf, cap);
+                        if (!buf)
+                                die(NULL, "Out of Memory Error");
+                }
+                n = read(t->fd, buf + len, cap - len - 1);
+                if (n < 0 && errno == EINTR)
+                        continue;
+                if (n <= 0)
+                        break;
+                len += (size_t) n;
+        }
+        close(t->fd);
+        t->fd = -1;
+
+        while ((got = waitpid(t->pid, &status, 0)) < 0 && errno == EINTR)
+                ;
+        if (got != t->pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || len < 1) {
+                free(buf);
+                die(at, "join: task %d failed", handle);
+        }
+
+        out.type = (VarType) buf[0];
+        out.is_const = 0;
+        if (out.type == TYPE_STRING) {
+                buf[len] = '\0';
+                out.data.s = string_new(buf + 1);
+        }
+        else if (out.type != TYPE_VOID) {
+                memcpy(&out.data, buf + 1, sizeof(VarData));
+        }
+        free(buf);
+        return out;
+}
+
+static void map_worker(Node* at, Node* func, ArrayList* arr,
+                       unsigned int lo, unsigned int hi, Var* out)
+{
+        unsigned int i;
+        Var keep;
+
+        task_child = 1;
+        parfor_worker = 0;
+        /* the array may be a temporary, a scope keeps it from being collected */
+        set_array(&keep, arr);
+        env_push();
+        env_set(sym_intern_str("pmap array"), keep);
+        for (i = lo; i < hi; i++) {
+                Var arg = arr->items[i];
+                out[i] = call_function(at, func, &arg, 1);
+        }
+        out_flush();
+        file_flush_all();
+        _exit(0);
+}
+
+/*
+ * calls func on every element of arr, split between n_workers forked
+ * children. they write their results straight into a shared mapping,
+ * which is copied into the returned array.
+ */
+ArrayList* task_map(Node* at, Node* func, ArrayList* arr, int n_workers)
+{
+        pid_t pids[POOL_MAX_THREADS];
+        unsigned int n = arr->size;
+        ArrayList* result;
+        Var* out = NULL;
+        int failed = 0;
+        int k;
+        unsigned int i;
+
+        if (!is_scalar(func->vartype))
+                die(at, "pmap: '%s' must return a scalar", sym_name(func->name));
+        if (CHILD(func, 0)->n_children != 1)
+                die(at, "pmap: '%s' must take one argument", sym_name(func->name));
+        if (CHILD(CHILD(func, 0), 0)->vartype != arr->type)
+                die(at, "pmap: '%s' takes type %d, the array holds %d",
+                    sym_name(func->name), CHILD(CHILD(func, 0), 0)->vartype, arr->type);
+
+        result = arraylist_new(func->vartype, n ? (int) n : 1);
+        if (n == 0)
+                return result;
+
+        if (n_workers < 1)
+                n_workers = pool_threads();
+        if (n_workers > POOL_MAX_THREADS)
+                n_workers = POOL_MAX_THREADS;
+        if ((unsigned int) n_workers > n)
+                n_workers = (int) n;
+
+        out = mmap(NULL, sizeof(Var) * n, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (out == MAP_FAILED)
+                die(at, "pmap: could not map %u results", n);
+
+        out_flush();
+        file_flush_all();
+        fflush(stderr);
+
+        for (k = 0; k < n_workers; k++) {
+                unsigned int lo = (unsigned int) ((unsigned long) n * k / n_workers);
+                unsigned int hi = (unsigned int) ((unsigned long) n * (k + 1) / n_workers);
+
+                pids[k] = fork();
+                if (pids[k] < 0) {
+                        while (k-- > 0) {
+                                kill(pids[k], SIGKILL);
+                                waitpid(pids[k], NULL, 0);
+                        }
+                        munmap(out, sizeof(Var) * n);
+                        die(at, "pmap: fork failed");
+                }
+                if (pids[k] == 0)
+                        map_worker(at, func, arr, lo, hi, out);
+        }
+
+        for (k = 0; k < n_workers; k++) {
+                pid_t got;
+                int status;
+                while ((got = waitpid(pids[k], &status, 0)) < 0 && errno == EINTR)
+                        ;
+                if (got != pids[k] || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                        failed = 1;
+        }
+        if (failed) {
+                munmap(out, sizeof(Var) * n);
+                die(at, "pmap: a worker failed");
+        }
+
+        for (i = 0; i < n; i++)
+                arraylist_push(result, out[i]);
+        munmap(out, sizeof(Var) * n);
+        return result;
+}
+
+int chan_is_elem_type(VarType type)
+{
+        return is_scalar(type) || type == TYPE_STRING;
+}
+
+/* a channel this process can no longer reach */
+static void chan_finalize(void* payload)
+{
+        Chan* c = payload;
+
+        close(c->fd[0]);
+        close(c->fd[1]);
+        gc_hold_fds(-2);
+}
+
+Chan* chan_new(Node* at, VarType type)
+{
+        static int registered = 0;
+        Chan* c;
+        int fds[2];
+        int size = CHAN_SNDBUF;
+
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) != 0)
+                die(at, "chan: could not create a channel: %s", strerror(errno));
+        setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+        if (!registered) {
+                gc_set_finalizer(scan_chan, chan_finalize);
+                registered = 1;
+        }
+        c = gc_alloc(sizeof(Chan), scan_chan);
+        gc_hold_fds(2);
+        c->type = type;
+        c->fd[0] = fds[0];
+        c->fd[1] = fds[1];
+        c->closed = 0;
+        return c;
+}
+
+static void put_msg(Node* at, const Chan* c, const char* msg, size_t n)
+{
+        while (send(c->fd[0], msg, n, 0) < 0) {
+                if (errno == EINTR)
+                        continue;
+                if (errno == EMSGSIZE)
+                        die(at, "send: message too long for a channel");
+                die(at, "send: %s", strerror(errno));
+        }
+}
+
+/* blocks while the channel is full */
+void chan_send(Node* at, Chan* c, Var val)
+{
+        static char msg[CHAN_MAX_MSG + 1];
+        size_t n;
+
+        if (val.type != c->type)
+                die(at, "send: channel holds %d but got %d", c->type, val.type);
+        if (c->closed)
+                die(at, "send: channel is closed");
+
+        msg[0] = MSG_VALUE;
+        if (val.type == TYPE_STRING) {
+                n = val.data.s->length;
+                if (n > CHAN_MAX_MSG)
+                        die(at, "send: strings sent on a channel are limited to %d bytes", CHAN_MAX_MSG);
+                memcpy(msg + 1, val.data.s->data, n);
+        }
+        else {
+                n = sizeof(VarData);
+                memcpy(msg + 1, &val.data, n);
+        }
+        put_msg(at, c, msg, n + 1);
+}
+
+/*
+ * blocks until a value arrives. a closed and empty channel gives the
+ * zero value of its type. the close is sent on again, every receiver
+ * gets to see it.
+ */
+Var chan_recv(Node* at, Chan* c)
+{
+        static char msg[CHAN_MAX_MSG + 2];
+        ssize_t n;
+        Var out;
+
+        n = recv(c->fd[1], msg, CHAN_MAX_MSG + 1, MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN)
+            && !task_child && !parfor_worker && !live_tasks())
+                die(at, "recv: channel is empty and no task is running to send to it");
+        while (n < 0 && (errno == EAGAIN || errno == EINTR))
+                n = recv(c->fd[1], msg, CHAN_MAX_MSG + 1, 0);
+        if (n < 1)
+                die(at, "recv: %s", n < 0 ? strerror(errno) : "channel is broken");
+
+        out.type = c->type;
+        out.is_const = 0;
+        if (msg[0] == MSG_CLOSE) {
+                put_msg(at, c, msg, 1);
+                c->closed = 1;
+                out.data.l = 0;
+                if (c->type == TYPE_STRING)
+                        out.data.s = string_new("");
+                return out;
+        }
+
+        if (c->type == TYPE_STRING) {
+                msg[n] = '\0';
+                out.data.s = string_new(msg + 1);
+        }
+        else {
+                memcpy(&out.data, msg + 1, sizeof(VarData));
+        }
+        return out;
+}
+
+/* values already sent can still be received */
+void chan_close(Node* at, Chan* c)
+{
+        char msg = MSG_CLOSE;
+
+        if (c->closed)
+                die(at, "close: channel is already closed");
+        put_msg(at, c, &msg, 1);
+        c->closed = 1;
+}
@@ -1,12 +1,17 @@
 #include "util.h"
+#include "parfor.h"
+#include "task.h"
+#include "output.h"
+#include "file.h"
 #include <stdlib.h>
+#include <unistd.h>
 
 void die(Node* node, const char* fmt, ...)
 {
         va_list args;
         fprintf(stderr, "Error");
         if (node) {
-                fprintf(stderr, " at line %d, column %d", node->lineno, node->column);
+                fprintf(stderr, " at line %d, column %d", node_lineno(node), node_column(node));
         }
         fprintf(stderr, ": ");
         va_start(args, fmt);
@@ -14,5 +19,11 @@ void die(Node* node, const char* fmt, ...)
         va_end(args);
         fprintf(stderr, "\n");
 
+        /* the exit handlers belong to the parent */
+        if (parfor_worker || task_child) {
+                out_flush();
+                file_flush_all();
+                _exit(1);
+        }
         exit(1);
 }
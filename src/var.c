@@ -1,6 +1,7 @@
 #include "var.h"
 #include "rec.h"
 #include "arraylist.h"
+#include "dict.h"
 #include "util.h"
 #include "ast.h"
 
@@ -23,6 +24,9 @@ Var var_clone(const Var* src)
         case TYPE_REC:
                 out.data.r = rec_clone(src->data.r);
                 break;
+        case TYPE_DICT:
+                out.data.d = dict_clone(src->data.d);
+                break;
         default:
                 out.data = src->data;
                 break;
@@ -113,6 +117,21 @@ void cast_to(Var* v, VarType target)
                 }
                 v->type = TYPE_INT;
                 break;
+        case TYPE_LONG:
+                switch (v->type) {
+                case TYPE_INT:
+                        v->data.l = (long)v->data.i;
+                        break;
+                case TYPE_UINT:
+                        v->data.l = (long)v->data.ui;
+                        break;
+                case TYPE_CHAR:
+                        v->data.l = (long)v->data.c;
+                        break;
+                default: die(NULL, "cannot cast to long");
+                }
+                v->type = TYPE_LONG;
+                break;
         case TYPE_BOOL:
                 switch (v->type) {
                 case TYPE_INT:
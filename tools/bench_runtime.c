@@ -0,0 +1,273 @@
+/*
+ * Microbenchmarks for the runtime primitives, linked against the
+ * interpreter objects instead of running puer scripts.
+ *
+ * usage: bench_runtime [-s scale]
+ *
+ * each line reports the time per operation and the gc allocations and
+ * bytes per operation, taken from the gc stats around the timed loop.
+ * -s multiplies every iteration count, for steadier numbers.
+ */
+#include "ast.h"
+#include "env.h"
+#include "arraylist.h"
+#include "rec.h"
+#include "dict.h"
+#include "builtin.h"
+#include "puerlib.h"
+#include "gc_tri.h"
+#include "scan.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct Bench {
+        const char* name;
+        void (*fn)(long n, int arg);
+        int arg;
+        long n;
+} Bench;
+
+static volatile long sink;
+
+static Symbol sym_global;
+static Symbol sym_rec;
+static Symbol sym_fields[4];
+static Node* abs_call;
+
+static double now_ns(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* looks up a global from arg nested scopes */
+static void bench_env_get(long n, int arg)
+{
+        long i;
+        int d;
+
+        for (d = 1; d < arg; d++)
+                env_push();
+        for (i = 0; i < n; i++)
+                sink += env_get(sym_global)->data.i;
+        for (d = 1; d < arg; d++)
+                env_pop();
+}
+
+/* overwrites a variable in the innermost of arg scopes */
+static void bench_env_set(long n, int arg)
+{
+        Var v;
+        long i;
+        int d;
+
+        for (d = 1; d < arg; d++)
+                env_push();
+        set_int(&v, 0);
+        for (i = 0; i < n; i++) {
+                v.data.i = (int) i;
+                env_set(sym_global, v);
+        }
+        for (d = 1; d < arg; d++)
+                env_pop();
+        set_int(&v, 1);
+        env_set(sym_global, v);
+}
+
+/* arg bytes per object, unreachable, swept by a full collection */
+static void bench_gc_alloc_sweep(long n, int arg)
+{
+        long i;
+
+        for (i = 0; i < n; i++)
+                gc_alloc((size_t) arg, scan_raw);
+        gc_collect_full();
+}
+
+/* pushes onto a fresh list of capacity 1, so growth is included */
+static void bench_arraylist_push(long n, int arg)
+{
+        ArrayList* a = arraylist_new(TYPE_INT, 1);
+        Var v;
+        long i;
+        (void) arg;
+
+        set_int(&v, 1);
+        for (i = 0; i < n; i++)
+                arraylist_push(a, v);
+        sink += a->size;
+}
+
+static void bench_string_concat(long n, int arg)
+{
+        String* a;
+        String* b;
+        char buf[256];
+        long i;
+
+        memset(buf, 'x', (size_t) arg);
+        buf[arg] = '\0';
+        a = string_new(buf);
+        b = string_new(buf);
+        for (i = 0; i < n; i++)
+                sink += string_concat(a, b)->length;
+}
+
+static void bench_rec_get_field(long n, int arg)
+{
+        RecInst* r = rec_new(sym_rec);
+        long i;
+
+        for (i = 0; i < n; i++)
+                sink += rec_get_field(r, sym_fields[arg])->data.i;
+}
+
+/* clones an arg x arg int array */
+static void bench_var_clone(long n, int arg)
+{
+        int dims[2];
+        Var src;
+        long i;
+
+        dims[0] = arg;
+        dims[1] = arg;
+        src = build_zero_array(TYPE_INT, SYM_NONE, dims, 2);
+        for (i = 0; i < n; i++)
+                sink += var_clone(&src).data.a->size;
+}
+
+/* looks up arg int keys round robin, the inserts are timed too */
+static void bench_dict_get(long n, int arg)
+{
+        Dict* d = dict_new(TYPE_INT, TYPE_INT);
+        Var k;
+        long i;
+
+        for (i = 0; i < arg; i++) {
+                set_int(&k, (int) i);
+                dict_set(NULL, d, k, k);
+        }
+        for (i = 0; i < n; i++) {
+                set_int(&k, (int) (i % arg));
+                sink += dict_get(NULL, d, k).data.i;
+        }
+}
+
+/* abs(7), argument evaluation and type checks included */
+static void bench_call_builtin(long n, int arg)
+{
+        Var out;
+        long i;
+        (void) arg;
+
+        for (i = 0; i < n; i++) {
+                call_builtin_if_exists(abs_call, &out);
+                sink += out.data.i;
+        }
+}
+
+static const Bench benches[] = {
+        { "env_get depth 1",         bench_env_get,        1,  4000000 },
+        { "env_get depth 8",         bench_env_get,        8,  2000000 },
+        { "env_get depth 32",        bench_env_get,        32, 500000 },
+        { "env_set depth 1",         bench_env_set,        1,  4000000 },
+        { "env_set depth 32",        bench_env_set,        32, 4000000 },
+        { "gc_alloc+sweep 16B",      bench_gc_alloc_sweep, 16, 1000000 },
+        { "gc_alloc+sweep 256B",     bench_gc_alloc_sweep, 256, 500000 },
+        { "arraylist_push",          bench_arraylist_push, 0,  4000000 },
+        { "string_concat 8+8",       bench_string_concat,  8,  500000 },
+        { "string_concat 128+128",   bench_string_concat,  128, 200000 },
+        { "rec_get_field first",     bench_rec_get_field,  0,  4000000 },
+        { "rec_get_field last",      bench_rec_get_field,  3,  4000000 },
+        { "var_clone int[4][4]",     bench_var_clone,      4,  200000 },
+        { "var_clone int[32][32]",   bench_var_clone,      32, 10000 },
+        { "dict_get 64 keys",        bench_dict_get,       64, 4000000 },
+        { "dict_get 100000 keys",    bench_dict_get,       100000, 4000000 },
+        { "call_builtin_if_exists",  bench_call_builtin,   0,  2000000 }
+};
+
+static void setup(void)
+{
+        static const char* field_names[4] = { "a", "b", "c", "d" };
+        Var fields[4];
+        ParseNode* arg;
+        ParseNode* call;
+        YYLTYPE loc;
+        Var v;
+        int i;
+
+        init_handlers();
+        gc_init();
+        init_puerlib();
+        env_push();
+
+        sym_global = sym_intern_str("global");
+        set_int(&v, 1);
+        env_set(sym_global, v);
+
+        sym_rec = sym_intern_str("Bench");
+        for (i = 0; i < 4; i++) {
+                sym_fields[i] = sym_intern_str(field_names[i]);
+                set_int(&fields[i], i);
+        }
+        recdef_register(recdef_new(sym_rec, sym_fields, fields, 4));
+
+        memset(&loc, 0, sizeof(loc));
+        arg = node(NODE_NUM, loc, 0);
+        arg->ival = 7;
+        call = node(NODE_FUNCCALL, loc, 1, node(NODE_SEQ, loc, 1, arg));
+        setname(call, sym_intern_str("abs"));
+        abs_call = ast_flatten(call);
+}
+
+static void run(const Bench* b, long scale)
+{
+        const GC_Stats* st = gc_get_stats();
+        long n = b->n * scale;
+        size_t objects = st->objects_allocated;
+        size_t bytes = st->bytes_allocated;
+        double start = now_ns();
+        double ns;
+
+        b->fn(n, b->arg);
+        ns = now_ns() - start;
+
+        printf("%-26s %10.1f ns/op %8.2f allocs/op %10.1f bytes/op\n",
+               b->name, ns / n,
+               (double) (st->objects_allocated - objects) / n,
+               (double) (st->bytes_allocated - bytes) / n);
+        fflush(stdout);
+
+        /* leave the next benchmark an empty heap */
+        gc_collect_full();
+}
+
+int main(int argc, char** argv)
+{
+        long scale = 1;
+        unsigned int i;
+
+        if (argc == 3 && strcmp(argv[1], "-s") == 0 && atol(argv[2]) > 0) {
+                scale = atol(argv[2]);
+        }
+        else if (argc != 1) {
+                fprintf(stderr, "usage: bench_runtime [-s scale]\n");
+                return 1;
+        }
+
+        setup();
+        for (i = 0; i < sizeof(benches) / sizeof(benches[0]); i++)
+                run(&benches[i], scale);
+
+        free_ast(abs_call);
+        env_clear();
+        builtin_clear();
+        recdef_clear();
+        gc_collect_full();
+        sym_clear();
+        return 0;
+}
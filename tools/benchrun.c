@@ -0,0 +1,204 @@
+/*
+ * Benchmark runner for the programs in bench/.
+ *
+ * usage: benchrun [-n runs] ./puer file.puer...
+ *
+ * each program is run once to warm the ast cache and then n more times
+ * with stdout discarded and PUER_GC_STATS=1. a JSON report goes to
+ * stdout with the median, min and max wall time, the peak RSS of the
+ * timed runs and the gc counts of the last run.
+ */
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+typedef struct Run {
+        double ms;
+        long rss_kb;
+        int status;
+        unsigned long gc_cycles;
+        unsigned long gc_bytes;
+        unsigned long gc_objects;
+} Run;
+
+static void die(const char* msg)
+{
+        fprintf(stderr, "benchrun: %s\n", msg);
+        exit(1);
+}
+
+static void* xrealloc(void* p, size_t n)
+{
+        p = realloc(p, n ? n : 1);
+        if (!p)
+                die("out of memory");
+        return p;
+}
+
+static double now_ms(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* picks the totals out of the gc_print_stats() lines on stderr */
+static void parse_gc_stats(const char* err, Run* r)
+{
+        const char* at;
+
+        if ((at = strstr(err, "[GC] cycles:")) != NULL)
+                sscanf(at, "[GC] cycles: %lu", &r->gc_cycles);
+        if ((at = strstr(err, "[GC] allocated:")) != NULL)
+                sscanf(at, "[GC] allocated: %lu bytes in %lu objects",
+                       &r->gc_bytes, &r->gc_objects);
+}
+
+static Run run_once(const char* puer, const char* script)
+{
+        Run r;
+        struct rusage ru;
+        char* err = NULL;
+        size_t n_err = 0;
+        size_t cap_err = 0;
+        double start;
+        int fds[2];
+        pid_t pid;
+        ssize_t got;
+
+        memset(&r, 0, sizeof(r));
+        if (pipe(fds) != 0)
+                die("pipe failed");
+
+        start = now_ms();
+        pid = fork();
+        if (pid < 0)
+                die("fork failed");
+        if (pid == 0) {
+                int null = open("/dev/null", O_RDWR);
+                dup2(null, 0);
+                dup2(null, 1);
+                dup2(fds[1], 2);
+                close(fds[0]);
+                close(fds[1]);
+                setenv("PUER_GC_STATS", "1", 1);
+                execl(puer, puer, script, (char*) NULL);
+                _exit(127);
+        }
+
+        close(fds[1]);
+        for (;;) {
+                if (cap_err - n_err < 4096) {
+                        cap_err = cap_err ? cap_err * 2 : 16384;
+                        err = xrealloc(err, cap_err);
+                }
+                got = read(fds[0], err + n_err, cap_err - n_err - 1);
+                if (got <= 0)
+                        break;
+                n_err += (size_t) got;
+        }
+        close(fds[0]);
+        err = xrealloc(err, n_err + 1);
+        err[n_err] = '\0';
+
+        if (wait4(pid, &r.status, 0, &ru) != pid)
+                die("wait failed");
+        r.ms = now_ms() - start;
+        r.rss_kb = ru.ru_maxrss;
+        parse_gc_stats(err, &r);
+        free(err);
+        return r;
+}
+
+static int by_ms(const void* a, const void* b)
+{
+        double x = ((const Run*) a)->ms;
+        double y = ((const Run*) b)->ms;
+        return (x > y) - (x < y);
+}
+
+/* bench/fib.puer -> fib */
+static void print_name(const char* path)
+{
+        const char* base = strrchr(path, '/');
+        const char* dot;
+
+        base = base ? base + 1 : path;
+        dot = strrchr(base, '.');
+        printf("\"%.*s\"", (int) (dot ? dot - base : (long) strlen(base)), base);
+}
+
+static int bench(const char* puer, const char* script, int runs, int last)
+{
+        Run* r = xrealloc(NULL, sizeof(Run) * runs);
+        long rss_kb = 0;
+        int failed = 0;
+        double median;
+        int i;
+
+        fprintf(stderr, "benchrun: %s\n", script);
+        run_once(puer, script);
+        for (i = 0; i < runs; i++) {
+                r[i] = run_once(puer, script);
+                if (r[i].rss_kb > rss_kb)
+                        rss_kb = r[i].rss_kb;
+                if (!WIFEXITED(r[i].status) || WEXITSTATUS(r[i].status) != 0)
+                        failed = 1;
+        }
+
+        /* the gc counts are deterministic, keep them before sorting */
+        printf("    {\"name\": ");
+        print_name(script);
+        printf(", \"file\": \"%s\", \"ok\": %s,\n", script, failed ? "false" : "true");
+        printf("     \"gc_cycles\": %lu, \"gc_bytes_allocated\": %lu, \"gc_objects_allocated\": %lu,\n",
+               r[runs - 1].gc_cycles, r[runs - 1].gc_bytes, r[runs - 1].gc_objects);
+
+        qsort(r, runs, sizeof(Run), by_ms);
+        median = runs % 2 ? r[runs / 2].ms : (r[runs / 2 - 1].ms + r[runs / 2].ms) / 2;
+        printf("     \"median_ms\": %.3f, \"min_ms\": %.3f, \"max_ms\": %.3f, \"peak_rss_kb\": %ld}%s\n",
+               median, r[0].ms, r[runs - 1].ms, rss_kb, last ? "" : ",");
+        fflush(stdout);
+
+        free(r);
+        return failed;
+}
+
+int main(int argc, char** argv)
+{
+        const char* puer = NULL;
+        int runs = 5;
+        int first = 0;
+        int failed = 0;
+        int i;
+
+        for (i = 1; i < argc; i++) {
+                if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+                        runs = atoi(argv[++i]);
+                }
+                else {
+                        puer = argv[i];
+                        first = i + 1;
+                        break;
+                }
+        }
+        if (!puer || first >= argc || runs < 1) {
+                fprintf(stderr, "usage: benchrun [-n runs] ./puer file.puer...\n");
+                return 1;
+        }
+
+        printf("{\n  \"puer\": \"%s\",\n  \"runs\": %d,\n  \"benchmarks\": [\n", puer, runs);
+        for (i = first; i < argc; i++)
+                failed |= bench(puer, argv[i], runs, i == argc - 1);
+        printf("  ]\n}\n");
+
+        return failed;
+}
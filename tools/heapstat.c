@@ -0,0 +1,480 @@
+/*
+ * Offline reader for heap dumps written by heap_dump() or SIGUSR1.
+ * Reports retained size per variable and per record type.
+ *
+ * usage: heapstat [-n count] file.heap
+ *
+ * retained size is computed from the dominator tree of the object graph,
+ * rooted at a virtual node pointing at every root in the dump.
+ */
+#include "gc_tri.h"
+#include "heapdump.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UNDEF ((unsigned int) -1)
+
+typedef struct Obj {
+        unsigned long addr;
+        GC_Kind kind;
+        unsigned long size;
+        char* name;
+        unsigned int edge_start;
+        unsigned int n_edges;
+} Obj;
+
+typedef struct Row {
+        const char* name;
+        unsigned long count;
+        unsigned long retained;
+} Row;
+
+/* node 0 is the virtual root, objects are 1..n_objs */
+static Obj* objs = NULL;
+static unsigned int n_objs = 0;
+static unsigned long* edge_addrs = NULL;
+static unsigned int* edges = NULL;
+static unsigned int n_edges = 0;
+static unsigned long* root_addrs = NULL;
+static unsigned int n_roots = 0;
+
+static unsigned int* idom = NULL;
+static unsigned int* rpo = NULL;     /* nodes in reverse postorder */
+static unsigned int* rpo_num = NULL; /* position of node in rpo */
+static unsigned int n_rpo = 0;
+static unsigned long* retained = NULL;
+
+static void die(const char* msg)
+{
+        fprintf(stderr, "heapstat: %s\n", msg);
+        exit(1);
+}
+
+static void* xrealloc(void* p, size_t n)
+{
+        p = realloc(p, n ? n : 1);
+        if (!p)
+                die("out of memory");
+        return p;
+}
+
+static unsigned long read_uint(FILE* f, int nbytes)
+{
+        unsigned long v = 0;
+        int i;
+        for (i = 0; i < nbytes; i++) {
+                int c = fgetc(f);
+                if (c == EOF)
+                        die("truncated dump");
+                v |= (unsigned long) c << (8 * i);
+        }
+        return v;
+}
+
+static void read_dump(const char* path)
+{
+        FILE* f = fopen(path, "rb");
+        char magic[8];
+        unsigned int objs_cap = 0;
+        unsigned int edges_cap = 0;
+        unsigned int roots_cap = 0;
+        int tag;
+
+        if (!f)
+                die("could not open dump");
+        if (fread(magic, 1, sizeof(magic), f) != sizeof(magic)
+                        || memcmp(magic, HEAPDUMP_MAGIC, sizeof(magic)) != 0)
+                die("not a puer heap dump");
+        if (read_uint(f, 4) != HEAPDUMP_VERSION)
+                die("unsupported dump version");
+
+        /* reserve slot 0 for the virtual root */
+        objs_cap = 1024;
+        objs = xrealloc(NULL, sizeof(Obj) * objs_cap);
+        memset(&objs[0], 0, sizeof(Obj));
+
+        while ((tag = fgetc(f)) != EOF && tag != 'E') {
+                if (tag == 'R') {
+                        if (n_roots >= roots_cap) {
+                                roots_cap = roots_cap ? roots_cap * 2 : 8;
+                                root_addrs = xrealloc(root_addrs, sizeof(unsigned long) * roots_cap);
+                        }
+                        root_addrs[n_roots++] = read_uint(f, 8);
+                }
+                else if (tag == 'O') {
+                        Obj* o;
+                        unsigned int len;
+                        unsigned int i;
+
+                        if (n_objs + 1 >= objs_cap) {
+                                objs_cap *= 2;
+                                objs = xrealloc(objs, sizeof(Obj) * objs_cap);
+                        }
+                        o = &objs[++n_objs];
+                        o->addr = read_uint(f, 8);
+                        o->kind = (GC_Kind) read_uint(f, 1);
+                        o->size = read_uint(f, 8);
+                        len = read_uint(f, 2);
+                        o->name = NULL;
+                        if (len) {
+                                o->name = xrealloc(NULL, len + 1);
+                                if (fread(o->name, 1, len, f) != len)
+                                        die("truncated dump");
+                                o->name[len] = '\0';
+                        }
+                        o->n_edges = read_uint(f, 4);
+                        o->edge_start = n_edges;
+                        for (i = 0; i < o->n_edges; i++) {
+                                if (n_edges >= edges_cap) {
+                                        edges_cap = edges_cap ? edges_cap * 2 : 1024;
+                                        edge_addrs = xrealloc(edge_addrs, sizeof(unsigned long) * edges_cap);
+                                }
+                                edge_addrs[n_edges++] = read_uint(f, 8);
+                        }
+                }
+                else {
+                        die("corrupt dump");
+                }
+        }
+        if (tag != 'E')
+                die("truncated dump");
+        fclose(f);
+}
+
+/* object indices sorted by address, for resolving edges */
+static unsigned int* by_addr = NULL;
+
+static int cmp_addr(const void* a, const void* b)
+{
+        unsigned long x = objs[*(const unsigned int*) a].addr;
+        unsigned long y = objs[*(const unsigned int*) b].addr;
+        return (x > y) - (x < y);
+}
+
+static unsigned int find_obj(unsigned long addr)
+{
+        unsigned int lo = 0;
+        unsigned int hi = n_objs;
+        while (lo < hi) {
+                unsigned int mid = lo + (hi - lo) / 2;
+                unsigned long a = objs[by_addr[mid]].addr;
+                if (a == addr)
+                        return by_addr[mid];
+                if (a < addr)
+                        lo = mid + 1;
+                else
+                        hi = mid;
+        }
+        return UNDEF;
+}
+
+/* rewrite edge addresses as node indices, unknown targets are dropped */
+static void resolve_edges(void)
+{
+        unsigned int i;
+        unsigned int j;
+
+        by_addr = xrealloc(NULL, sizeof(unsigned int) * n_objs);
+        for (i = 0; i < n_objs; i++)
+                by_addr[i] = i + 1;
+        qsort(by_addr, n_objs, sizeof(unsigned int), cmp_addr);
+
+        edges = xrealloc(NULL, sizeof(unsigned int) * (n_edges + n_roots));
+        for (i = 1; i <= n_objs; i++) {
+                Obj* o = &objs[i];
+                unsigned int start = o->edge_start;
+                unsigned int kept = 0;
+                for (j = 0; j < o->n_edges; j++) {
+                        unsigned int t = find_obj(edge_addrs[start + j]);
+                        if (t != UNDEF)
+                                edges[start + kept++] = t;
+                }
+                o->n_edges = kept;
+        }
+
+        /* virtual root edges live after the object edges */
+        objs[0].edge_start = n_edges;
+        objs[0].n_edges = 0;
+        for (i = 0; i < n_roots; i++) {
+                unsigned int t = find_obj(root_addrs[i]);
+                if (t != UNDEF)
+                        edges[n_edges + objs[0].n_edges++] = t;
+        }
+}
+
+/* iterative dfs from the virtual root, fills rpo */
+static void order_nodes(void)
+{
+        unsigned int n = n_objs + 1;
+        unsigned int* stack = xrealloc(NULL, sizeof(unsigned int) * n);
+        unsigned int* next_edge = xrealloc(NULL, sizeof(unsigned int) * n);
+        char* seen = xrealloc(NULL, n);
+        unsigned int* post = xrealloc(NULL, sizeof(unsigned int) * n);
+        unsigned int n_post = 0;
+        unsigned int sp = 0;
+        unsigned int i;
+
+        memset(seen, 0, n);
+        stack[sp++] = 0;
+        next_edge[0] = 0;
+        seen[0] = 1;
+
+        while (sp) {
+                unsigned int v = stack[sp - 1];
+                Obj* o = &objs[v];
+                if (next_edge[v] < o->n_edges) {
+                        unsigned int w = edges[o->edge_start + next_edge[v]++];
+                        if (!seen[w]) {
+                                seen[w] = 1;
+                                next_edge[w] = 0;
+                                stack[sp++] = w;
+                        }
+                }
+                else {
+                        post[n_post++] = v;
+                        sp--;
+                }
+        }
+
+        rpo = xrealloc(NULL, sizeof(unsigned int) * n);
+        rpo_num = xrealloc(NULL, sizeof(unsigned int) * n);
+        for (i = 0; i < n; i++)
+                rpo_num[i] = UNDEF;
+        for (i = 0; i < n_post; i++) {
+                rpo[i] = post[n_post - 1 - i];
+                rpo_num[rpo[i]] = i;
+        }
+        n_rpo = n_post;
+
+        free(stack);
+        free(next_edge);
+        free(seen);
+        free(post);
+}
+
+static unsigned int intersect(unsigned int a, unsigned int b)
+{
+        while (a != b) {
+                while (rpo_num[a] > rpo_num[b])
+                        a = idom[a];
+                while (rpo_num[b] > rpo_num[a])
+                        b = idom[b];
+        }
+        return a;
+}
+
+/* Cooper, Harvey, Kennedy: "A Simple, Fast Dominance Algorithm" */
+static void compute_dominators(void)
+{
+        unsigned int n = n_objs + 1;
+        unsigned int* pred_start = xrealloc(NULL, sizeof(unsigned int) * (n + 1));
+        unsigned int* preds;
+        unsigned int* fill;
+        unsigned int total = 0;
+        unsigned int i;
+        unsigned int j;
+        int changed = 1;
+
+        memset(pred_start, 0, sizeof(unsigned int) * (n + 1));
+        for (i = 0; i < n; i++)
+                for (j = 0; j < objs[i].n_edges; j++)
+                        pred_start[edges[objs[i].edge_start + j] + 1]++;
+        for (i = 0; i < n; i++)
+                pred_start[i + 1] += pred_start[i];
+        total = pred_start[n];
+
+        preds = xrealloc(NULL, sizeof(unsigned int) * total);
+        fill = xrealloc(NULL, sizeof(unsigned int) * n);
+        memcpy(fill, pred_start, sizeof(unsigned int) * n);
+        for (i = 0; i < n; i++) {
+                for (j = 0; j < objs[i].n_edges; j++) {
+                        unsigned int t = edges[objs[i].edge_start + j];
+                        preds[fill[t]++] = i;
+                }
+        }
+
+        idom = xrealloc(NULL, sizeof(unsigned int) * n);
+        for (i = 0; i < n; i++)
+                idom[i] = UNDEF;
+        idom[0] = 0;
+
+        while (changed) {
+                changed = 0;
+                for (i = 1; i < n_rpo; i++) {
+                        unsigned int b = rpo[i];
+                        unsigned int new_idom = UNDEF;
+                        for (j = pred_start[b]; j < pred_start[b + 1]; j++) {
+                                unsigned int p = preds[j];
+                                if (idom[p] == UNDEF)
+                                        continue;
+                                new_idom = (new_idom == UNDEF) ? p : intersect(p, new_idom);
+                        }
+                        if (idom[b] != new_idom) {
+                                idom[b] = new_idom;
+                                changed = 1;
+                        }
+                }
+        }
+
+        free(pred_start);
+        free(preds);
+        free(fill);
+}
+
+static void compute_retained(void)
+{
+        unsigned int i;
+        retained = xrealloc(NULL, sizeof(unsigned long) * (n_objs + 1));
+        for (i = 0; i <= n_objs; i++)
+                retained[i] = objs[i].size;
+        /* children come after their dominator in rpo */
+        for (i = n_rpo; i-- > 1; )
+                retained[idom[rpo[i]]] += retained[rpo[i]];
+}
+
+static int cmp_row(const void* a, const void* b)
+{
+        unsigned long x = ((const Row*) a)->retained;
+        unsigned long y = ((const Row*) b)->retained;
+        return (x < y) - (x > y);
+}
+
+static void print_rows(const char* title, Row* rows, unsigned int n, unsigned int limit)
+{
+        unsigned int i;
+        qsort(rows, n, sizeof(Row), cmp_row);
+        printf("\n%s\n", title);
+        printf("  %12s %8s  %s\n", "retained", "count", "name");
+        for (i = 0; i < n && i < limit; i++)
+                printf("  %12lu %8lu  %s\n", rows[i].retained, rows[i].count, rows[i].name);
+}
+
+/* retained size of each variable entry */
+static void report_variables(unsigned int limit)
+{
+        Row* rows = xrealloc(NULL, sizeof(Row) * (n_objs + 1));
+        unsigned int n = 0;
+        unsigned int i;
+
+        for (i = 1; i <= n_objs; i++) {
+                if (objs[i].kind != GC_KIND_VARENTRY || rpo_num[i] == UNDEF)
+                        continue;
+                rows[n].name = objs[i].name ? objs[i].name : "?";
+                rows[n].count = 1;
+                rows[n].retained = retained[i];
+                n++;
+        }
+        print_rows("retained by variable:", rows, n, limit);
+        free(rows);
+}
+
+/* does the dominator chain of v contain another record of the same type */
+static int nested_in_same_type(unsigned int v)
+{
+        const char* name = objs[v].name;
+        unsigned int d = idom[v];
+        while (d != 0) {
+                if (objs[d].kind == GC_KIND_REC && objs[d].name && name
+                                && strcmp(objs[d].name, name) == 0)
+                        return 1;
+                d = idom[d];
+        }
+        return 0;
+}
+
+/* retained size of record instances, grouped by type */
+static void report_records(unsigned int limit)
+{
+        Row* rows = xrealloc(NULL, sizeof(Row) * (n_objs + 1));
+        unsigned int n = 0;
+        unsigned int i;
+        unsigned int j;
+
+        for (i = 1; i <= n_objs; i++) {
+                const char* name;
+                if (objs[i].kind != GC_KIND_REC || rpo_num[i] == UNDEF)
+                        continue;
+                name = objs[i].name ? objs[i].name : "?";
+                for (j = 0; j < n; j++)
+                        if (strcmp(rows[j].name, name) == 0)
+                                break;
+                if (j == n) {
+                        rows[n].name = name;
+                        rows[n].count = 0;
+                        rows[n].retained = 0;
+                        n++;
+                }
+                rows[j].count++;
+                if (!nested_in_same_type(i))
+                        rows[j].retained += retained[i];
+        }
+        print_rows("retained by record type:", rows, n, limit);
+        free(rows);
+}
+
+/* same names as gc_kind_name(), the tool does not link the runtime */
+static const char* kind_name(GC_Kind kind)
+{
+        static const char* names[GC_NUM_KINDS] = {
+                "raw", "string", "array", "varentry", "scope", "rec", "recdef", "dict", "other"
+        };
+        if (kind >= GC_NUM_KINDS)
+                return names[GC_KIND_OTHER];
+        return names[kind];
+}
+
+static void report_totals(void)
+{
+        unsigned long total = 0;
+        unsigned long reachable = 0;
+        unsigned long by_kind[GC_NUM_KINDS];
+        unsigned int i;
+
+        memset(by_kind, 0, sizeof(by_kind));
+        for (i = 1; i <= n_objs; i++) {
+                total += objs[i].size;
+                if (rpo_num[i] != UNDEF)
+                        reachable += objs[i].size;
+                if (objs[i].kind < GC_NUM_KINDS)
+                        by_kind[objs[i].kind] += objs[i].size;
+        }
+
+        printf("objects:     %u\n", n_objs);
+        printf("heap bytes:  %lu\n", total);
+        printf("reachable:   %lu\n", reachable);
+        printf("unreachable: %lu (garbage not yet swept)\n", total - reachable);
+        printf("\nbytes by kind:\n");
+        for (i = 0; i < GC_NUM_KINDS; i++)
+                printf("  %-10s %lu\n", kind_name((GC_Kind) i), by_kind[i]);
+}
+
+int main(int argc, char** argv)
+{
+        unsigned int limit = 20;
+        const char* path = NULL;
+        int i;
+
+        for (i = 1; i < argc; i++) {
+                if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+                        limit = (unsigned int) atoi(argv[++i]);
+                else
+                        path = argv[i];
+        }
+        if (!path) {
+                fprintf(stderr, "usage: heapstat [-n count] file.heap\n");
+                return 1;
+        }
+
+        read_dump(path);
+        resolve_edges();
+        order_nodes();
+        compute_dominators();
+        compute_retained();
+
+        report_totals();
+        report_variables(limit);
+        report_records(limit);
+        return 0;
+}